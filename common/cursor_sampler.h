@@ -0,0 +1,70 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_CURSOR_SAMPLER_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_CURSOR_SAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace window_manager_plus_v2 {
+
+// Global pointer positions sampled once per frame for the cursor stream.
+// Only the positions that differ from the previous sample are kept, and
+// they are sent in batches of timestamp (microseconds), x, y triples, so
+// that a display faster than the batch interval still costs one message
+// per interval. Once the pointer rests for kIdleSamples samples, callers
+// drop to polling every kIdlePollMs until it moves again.
+class CursorSampler {
+ public:
+  static constexpr int64_t kBatchIntervalUs = 16000;
+  static constexpr int kIdleSamples = 30;
+  static constexpr int kIdlePollMs = 100;
+
+  void Sample(int64_t time_us, double x, double y) {
+    if (has_position_ && x == last_x_ && y == last_y_) {
+      if (unchanged_samples_ < kIdleSamples) {
+        unchanged_samples_++;
+      }
+      return;
+    }
+    has_position_ = true;
+    unchanged_samples_ = 0;
+    last_x_ = x;
+    last_y_ = y;
+    samples_.insert(samples_.end(), {static_cast<double>(time_us), x, y});
+  }
+
+  // Whether the samples should be sent at |time_us|.
+  bool IsDue(int64_t time_us) const {
+    return !samples_.empty() && time_us - last_flush_us_ >= kBatchIntervalUs;
+  }
+
+  // Whether the pointer has not moved for the last kIdleSamples samples.
+  bool IsIdle() const { return unchanged_samples_ >= kIdleSamples; }
+
+  std::vector<double> TakeSamples(int64_t time_us) {
+    last_flush_us_ = time_us;
+    std::vector<double> samples;
+    samples.swap(samples_);
+    return samples;
+  }
+
+  // Forgets the last position, so that the next subscriber gets one right
+  // away.
+  void Reset() {
+    has_position_ = false;
+    unchanged_samples_ = 0;
+    samples_.clear();
+    last_flush_us_ = 0;
+  }
+
+ private:
+  bool has_position_ = false;
+  double last_x_ = 0;
+  double last_y_ = 0;
+  int unchanged_samples_ = 0;
+  int64_t last_flush_us_ = 0;
+  std::vector<double> samples_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_CURSOR_SAMPLER_H_
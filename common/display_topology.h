@@ -0,0 +1,112 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_DISPLAY_TOPOLOGY_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_DISPLAY_TOPOLOGY_H_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rect.h"
+
+namespace window_manager_plus_v2 {
+
+// A monitor as seen by the platform, in its native units.
+struct Display {
+  // Stable platform identifier, e.g. the connector or the device name.
+  std::string id;
+  std::string name;
+  Rect bounds;
+  Rect work_area;
+  double scale_factor = 1;
+  bool is_primary = false;
+};
+
+// Cache of the monitors, so that hot paths such as WM_NCCALCSIZE do not
+// query the system on every call. The platform fills it lazily and
+// invalidates it when the monitor configuration changes.
+//
+// Lookups are linear scans over a small contiguous array: a desktop has a
+// handful of monitors, which is faster than any index.
+class DisplayTopology {
+ public:
+  bool IsValid() const { return is_valid_; }
+
+  void Invalidate() {
+    is_valid_ = false;
+    displays_.clear();
+  }
+
+  void Reset(std::vector<Display> displays) {
+    displays_ = std::move(displays);
+    is_valid_ = true;
+  }
+
+  const std::vector<Display>& displays() const { return displays_; }
+
+  // The display containing the point, or nullptr.
+  const Display* FindByPoint(double x, double y) const {
+    for (const Display& display : displays_) {
+      if (display.bounds.Contains(x, y)) {
+        return &display;
+      }
+    }
+    return nullptr;
+  }
+
+  // The display with the largest intersection with |rect|, or the nearest
+  // one if it intersects none, like MONITOR_DEFAULTTONEAREST. Only returns
+  // nullptr when there is no display at all.
+  const Display* FindByRect(const Rect& rect) const {
+    const Display* result = nullptr;
+    double best_area = 0;
+    for (const Display& display : displays_) {
+      double area = IntersectionArea(display.bounds, rect);
+      if (area > best_area) {
+        best_area = area;
+        result = &display;
+      }
+    }
+    if (result != nullptr) {
+      return result;
+    }
+
+    double best_distance = 0;
+    for (const Display& display : displays_) {
+      double distance = SquaredDistance(display.bounds, rect);
+      if (result == nullptr || distance < best_distance) {
+        best_distance = distance;
+        result = &display;
+      }
+    }
+    return result;
+  }
+
+  const Display* Primary() const {
+    for (const Display& display : displays_) {
+      if (display.is_primary) {
+        return &display;
+      }
+    }
+    return displays_.empty() ? nullptr : &displays_.front();
+  }
+
+ private:
+  static double IntersectionArea(const Rect& a, const Rect& b) {
+    double width = std::min(a.right(), b.right()) - std::max(a.x, b.x);
+    double height = std::min(a.bottom(), b.bottom()) - std::max(a.y, b.y);
+    return width > 0 && height > 0 ? width * height : 0;
+  }
+
+  static double SquaredDistance(const Rect& a, const Rect& b) {
+    double dx = std::max({0.0, a.x - b.right(), b.x - a.right()});
+    double dy = std::max({0.0, a.y - b.bottom(), b.y - a.bottom()});
+    return dx * dx + dy * dy;
+  }
+
+  std::vector<Display> displays_;
+  bool is_valid_ = false;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_DISPLAY_TOPOLOGY_H_
@@ -0,0 +1,98 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_EDGE_SNAPPER_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_EDGE_SNAPPER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rect.h"
+
+namespace window_manager_plus_v2 {
+
+// Index of the edges a dragged window snaps to: the sides of the other
+// windows and of the monitor work areas.
+//
+// The edges are kept in two arrays sorted by position, one per axis, so a
+// query is a binary search followed by a scan of the few edges within the
+// snap distance, whatever the number of windows. The index is built once
+// when a drag starts and queried on every move.
+class EdgeSnapper {
+ public:
+  void Clear() {
+    vertical_.clear();
+    horizontal_.clear();
+  }
+
+  // Adds the four sides of |rect|. Windows snap to both sides of an edge,
+  // so the same call serves windows and work areas.
+  void AddRect(const Rect& rect) {
+    vertical_.push_back({rect.x, rect.y, rect.bottom()});
+    vertical_.push_back({rect.right(), rect.y, rect.bottom()});
+    horizontal_.push_back({rect.y, rect.x, rect.right()});
+    horizontal_.push_back({rect.bottom(), rect.x, rect.right()});
+  }
+
+  // Sorts the edges, call it once after the last AddRect.
+  void Build() {
+    auto by_position = [](const Edge& a, const Edge& b) {
+      return a.position < b.position;
+    };
+    std::sort(vertical_.begin(), vertical_.end(), by_position);
+    std::sort(horizontal_.begin(), horizontal_.end(), by_position);
+  }
+
+  bool IsEmpty() const { return vertical_.empty(); }
+
+  // Top left corner of |rect| moved onto the nearest edges within
+  // |distance| on each axis. An edge only attracts |rect| when they face
+  // each other, i.e. their spans overlap once grown by |distance|.
+  Point Snap(const Rect& rect, double distance) const {
+    double dx = FindOffset(vertical_, rect.x, rect.right(), rect.y,
+                           rect.bottom(), distance);
+    double dy = FindOffset(horizontal_, rect.y, rect.bottom(), rect.x,
+                           rect.right(), distance);
+    return {rect.x + dx, rect.y + dy};
+  }
+
+ private:
+  struct Edge {
+    double position;
+    // Span of the edge on the other axis.
+    double start;
+    double end;
+  };
+
+  // Smallest offset that puts |near_side| or |far_side| on an edge, or 0.
+  static double FindOffset(const std::vector<Edge>& edges,
+                           double near_side,
+                           double far_side,
+                           double start,
+                           double end,
+                           double distance) {
+    double best = 0;
+    bool found = false;
+    for (double side : {near_side, far_side}) {
+      auto it = std::lower_bound(
+          edges.begin(), edges.end(), side - distance,
+          [](const Edge& edge, double value) { return edge.position < value; });
+      for (; it != edges.end() && it->position <= side + distance; ++it) {
+        if (it->end < start - distance || it->start > end + distance) {
+          continue;
+        }
+        double offset = it->position - side;
+        if (!found || std::abs(offset) < std::abs(best)) {
+          best = offset;
+          found = true;
+        }
+      }
+    }
+    return best;
+  }
+
+  std::vector<Edge> vertical_;
+  std::vector<Edge> horizontal_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_EDGE_SNAPPER_H_
@@ -0,0 +1,157 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_QUEUE_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_QUEUE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace window_manager_plus_v2 {
+
+// What happens to an event that can't be sent because Dart is behind.
+enum class EventPolicy {
+  // Queued, dropping the oldest events once the queue is full.
+  kKeepAll,
+  // Replaces the queued event with the same key, e.g. the intermediate
+  // positions of a move.
+  kLatestWins,
+  // Dropped.
+  kDrop,
+};
+
+struct EventQueueStats {
+  size_t depth = 0;
+  size_t max_depth = 0;
+  size_t in_flight = 0;
+  uint64_t sent = 0;
+  uint64_t coalesced = 0;
+  uint64_t dropped = 0;
+};
+
+// Flow control for the events sent to Dart. At most |max_in_flight| events
+// are outstanding, i.e. sent and not replied to yet, the others wait here
+// according to the policy of their name, so that a stalled isolate gets the
+// current state once it resumes instead of replaying every stale move.
+template <typename Event>
+class EventQueue {
+ public:
+  static constexpr size_t kMaxInFlight = 4;
+  static constexpr size_t kCapacity = 256;
+
+  EventQueue() {
+    policies_["move"] = EventPolicy::kLatestWins;
+    policies_["resize"] = EventPolicy::kLatestWins;
+    // A stalled isolate only needs the last cursor position. Thumbnail
+    // batches hold the changed previews only, the services send all of
+    // them after a batch was held back so that none is lost.
+    policies_["cursorSamples"] = EventPolicy::kLatestWins;
+    policies_["thumbnails"] = EventPolicy::kLatestWins;
+  }
+
+  void SetPolicy(const std::string& name, EventPolicy policy) {
+    policies_[name] = policy;
+  }
+
+  // Returns the event when it can be sent right away, the caller then calls
+  // OnReply once Dart replies. Otherwise it's queued or dropped. |key|
+  // identifies the events that replace each other, the name of the event
+  // and the window it's about.
+  std::optional<Event> Push(const std::string& name,
+                            const std::string& key,
+                            Event event) {
+    if (in_flight_ < kMaxInFlight && queue_.empty()) {
+      in_flight_++;
+      stats_.sent++;
+      return event;
+    }
+
+    auto policy = policies_.find(name);
+    switch (policy == policies_.end() ? EventPolicy::kKeepAll
+                                      : policy->second) {
+      case EventPolicy::kDrop:
+        stats_.dropped++;
+        return std::nullopt;
+      case EventPolicy::kLatestWins:
+        for (auto& queued : queue_) {
+          if (queued.first == key) {
+            queued.second = std::move(event);
+            stats_.coalesced++;
+            return std::nullopt;
+          }
+        }
+        break;
+      case EventPolicy::kKeepAll:
+        break;
+    }
+    if (queue_.size() >= kCapacity) {
+      queue_.pop_front();
+      stats_.dropped++;
+    }
+    queue_.emplace_back(key, std::move(event));
+    stats_.max_depth = std::max(stats_.max_depth, queue_.size());
+    return std::nullopt;
+  }
+
+  // Called when Dart replied to an event, or failed to. Returns the next
+  // event to send, if any.
+  std::optional<Event> OnReply() {
+    if (in_flight_ > 0) {
+      in_flight_--;
+    }
+    if (queue_.empty()) {
+      return std::nullopt;
+    }
+    Event event = std::move(queue_.front().second);
+    queue_.pop_front();
+    in_flight_++;
+    stats_.sent++;
+    return event;
+  }
+
+  // Called instead of sending the event returned by Push or OnReply when
+  // nothing can deliver it, e.g. the channel is gone. Nothing would reply
+  // to free its slot either, so it and every queued event are dropped.
+  void DropPending() {
+    if (in_flight_ > 0) {
+      in_flight_--;
+    }
+    stats_.sent--;
+    stats_.dropped += 1 + queue_.size();
+    queue_.clear();
+  }
+
+  EventQueueStats stats() const {
+    EventQueueStats stats = stats_;
+    stats.depth = queue_.size();
+    stats.in_flight = in_flight_;
+    return stats;
+  }
+
+ private:
+  std::map<std::string, EventPolicy> policies_;
+  std::deque<std::pair<std::string, Event>> queue_;
+  size_t in_flight_ = 0;
+  EventQueueStats stats_;
+};
+
+inline std::optional<EventPolicy> EventPolicyFromName(
+    const std::string& name) {
+  if (name == "keepAll") {
+    return EventPolicy::kKeepAll;
+  }
+  if (name == "latestWins") {
+    return EventPolicy::kLatestWins;
+  }
+  if (name == "drop") {
+    return EventPolicy::kDrop;
+  }
+  return std::nullopt;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_QUEUE_H_
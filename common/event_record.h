@@ -0,0 +1,42 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_RECORD_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_RECORD_H_
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "window_event.h"
+
+namespace window_manager_plus_v2 {
+
+// Set on the copies of an event sent to every window, as opposed to the
+// one sent to the window it's about.
+constexpr uint32_t kEventRecordGlobal = 1;
+
+// A move or resize, sent as is on the binary event channel instead of a
+// map through the method channel. Dart reads the fields at fixed offsets,
+// in the byte order of the machine, which is little-endian on every
+// platform of the plugin.
+struct EventRecord {
+  int32_t event;  // WindowEvent
+  uint32_t flags;
+  int64_t window_id;
+  // Monotonic, in microseconds.
+  int64_t timestamp_us;
+  // Bounds of the window in logical pixels.
+  double x;
+  double y;
+  double width;
+  double height;
+};
+static_assert(sizeof(EventRecord) == 56, "EventRecord layout changed");
+
+inline std::vector<uint8_t> EncodeEventRecord(const EventRecord& record) {
+  std::vector<uint8_t> bytes(sizeof(EventRecord));
+  std::memcpy(bytes.data(), &record, sizeof(EventRecord));
+  return bytes;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_EVENT_RECORD_H_
@@ -0,0 +1,131 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_LATENCY_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_LATENCY_H_
+
+#include <algorithm>
+#include <cstdint>
+
+namespace window_manager_plus_v2 {
+
+// Histogram of latencies in microseconds with power of two buckets: bucket
+// i counts the samples in [2^i, 2^(i+1)), bucket 0 also counts 0. Recording
+// is a bit scan, so it can sit on the input path.
+class LatencyHistogram {
+ public:
+  static constexpr int kBucketCount = 32;
+
+  void Record(int64_t latency_us) {
+    latency_us = std::max<int64_t>(latency_us, 0);
+    buckets_[BucketOf(latency_us)]++;
+    min_us_ = count_ == 0 ? latency_us : std::min(min_us_, latency_us);
+    max_us_ = std::max(max_us_, latency_us);
+    sum_us_ += latency_us;
+    count_++;
+  }
+
+  void Reset() { *this = LatencyHistogram(); }
+
+  int64_t count() const { return count_; }
+  int64_t min_us() const { return min_us_; }
+  int64_t max_us() const { return max_us_; }
+  int64_t mean_us() const { return count_ == 0 ? 0 : sum_us_ / count_; }
+  int64_t bucket(int i) const { return buckets_[i]; }
+
+  // Upper bound of the bucket holding the |fraction| quantile, clamped to
+  // the largest sample.
+  int64_t Percentile(double fraction) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    int64_t rank =
+        std::max<int64_t>(1, static_cast<int64_t>(count_ * fraction));
+    int64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+      seen += buckets_[i];
+      if (seen >= rank) {
+        return std::min(max_us_, (int64_t{2} << i) - 1);
+      }
+    }
+    return max_us_;
+  }
+
+ private:
+  static int BucketOf(int64_t latency_us) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && (latency_us >> (bucket + 1)) != 0) {
+      bucket++;
+    }
+    return bucket;
+  }
+
+  int64_t buckets_[kBucketCount] = {};
+  int64_t count_ = 0;
+  int64_t min_us_ = 0;
+  int64_t max_us_ = 0;
+  int64_t sum_us_ = 0;
+};
+
+// Monotonic time in microseconds of an input event stamped |event_ms| by a
+// 32-bit millisecond clock that read |clock_ms| at |now_us|, such as X11
+// server times or GetMessageTime. An event that seems older than 10 s comes
+// from another clock and is taken as happening now.
+inline int64_t EventTimeToMonotonicUs(uint32_t event_ms,
+                                      uint32_t clock_ms,
+                                      int64_t now_us) {
+  uint32_t age_ms = clock_ms - event_ms;
+  return age_ms > 10000 ? now_us : now_us - int64_t{age_ms} * 1000;
+}
+
+// Latency from the button press that starts a window drag or resize to the
+// drag or resize starting, and to the window moving for the first time.
+class InputLatencyTracker {
+ public:
+  void OnPress(int64_t press_us) { press_us_ = press_us; }
+
+  void OnDragStart(int64_t now_us) { OnActionStart(now_us, &drag_start_); }
+
+  void OnResizeStart(int64_t now_us) {
+    OnActionStart(now_us, &resize_start_);
+  }
+
+  // Called on every move or resize of the window, only the first one after
+  // a drag or resize start counts.
+  void OnMove(int64_t now_us) {
+    if (moving_press_us_ < 0) {
+      return;
+    }
+    first_move_.Record(now_us - moving_press_us_);
+    moving_press_us_ = -1;
+  }
+
+  void Reset() { *this = InputLatencyTracker(); }
+
+  const LatencyHistogram& drag_start() const { return drag_start_; }
+  const LatencyHistogram& resize_start() const { return resize_start_; }
+  const LatencyHistogram& first_move() const { return first_move_; }
+
+ private:
+  // A press this old did not start the action, e.g. a click followed by a
+  // move from the keyboard.
+  static constexpr int64_t kMaxPressAgeUs = 1000000;
+
+  // Each press is measured once, an action started without one is not.
+  void OnActionStart(int64_t now_us, LatencyHistogram* histogram) {
+    if (press_us_ < 0 || now_us - press_us_ > kMaxPressAgeUs) {
+      press_us_ = -1;
+      return;
+    }
+    histogram->Record(now_us - press_us_);
+    moving_press_us_ = press_us_;
+    press_us_ = -1;
+  }
+
+  int64_t press_us_ = -1;
+  int64_t moving_press_us_ = -1;
+  LatencyHistogram drag_start_;
+  LatencyHistogram resize_start_;
+  LatencyHistogram first_move_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_LATENCY_H_
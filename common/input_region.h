@@ -0,0 +1,77 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_REGION_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_REGION_H_
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace window_manager_plus_v2 {
+
+// A rectangle in whole pixels, laid out like cairo_rectangle_int_t.
+struct PixelRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  bool operator==(const PixelRect& other) const {
+    return x == other.x && y == other.y && width == other.width &&
+           height == other.height;
+  }
+};
+
+// The parts of a window that take pointer input, the rest of the window
+// clicks through. Overlays update it every frame, so the rectangles are
+// snapped to whole pixels into a reused buffer and compared with the
+// current ones, and the platform region is only rebuilt when they differ.
+class InputRegion {
+ public:
+  // Replaces the region with rectangles packed as x, y, width, height,
+  // multiplied by |scale|. Returns whether the region changed.
+  bool Update(const double* values, size_t count, double scale) {
+    next_.clear();
+    for (size_t i = 0; i + 3 < count; i += 4) {
+      // Grown to the pixels they touch.
+      int left = static_cast<int>(std::floor(values[i] * scale));
+      int top = static_cast<int>(std::floor(values[i + 1] * scale));
+      int right =
+          static_cast<int>(std::ceil((values[i] + values[i + 2]) * scale));
+      int bottom =
+          static_cast<int>(std::ceil((values[i + 1] + values[i + 3]) * scale));
+      if (right > left && bottom > top) {
+        next_.push_back({left, top, right - left, bottom - top});
+      }
+    }
+    if (is_set_ && next_ == rects_) {
+      return false;
+    }
+    rects_.swap(next_);
+    is_set_ = true;
+    return true;
+  }
+
+  // Makes the whole window take input again. Returns whether the region
+  // changed.
+  bool Reset() {
+    if (!is_set_) {
+      return false;
+    }
+    is_set_ = false;
+    rects_.clear();
+    return true;
+  }
+
+  // Whether input is restricted to rects(), which may be empty.
+  bool IsSet() const { return is_set_; }
+
+  const std::vector<PixelRect>& rects() const { return rects_; }
+
+ private:
+  bool is_set_ = false;
+  std::vector<PixelRect> rects_;
+  std::vector<PixelRect> next_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_INPUT_REGION_H_
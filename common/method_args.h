@@ -0,0 +1,597 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_METHOD_ARGS_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_METHOD_ARGS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "event_queue.h"
+#include "tiling.h"
+
+namespace window_manager_plus_v2 {
+
+// A list of doubles of a method call. A Float64List from Dart is pointed
+// into, so it's only valid while the arguments are alive. A List<double>
+// is converted into |converted|, which |data| then points to.
+struct DoubleList {
+  const double* data = nullptr;
+  size_t size = 0;
+  std::shared_ptr<const std::vector<double>> converted;
+};
+
+// An argument of a method call, read from its FlValue or EncodableValue
+// without copying its string nor its list.
+struct ArgValue {
+  enum class Kind { kNull, kBool, kInt, kDouble, kString, kDoubleList, kOther };
+
+  Kind kind = Kind::kNull;
+  bool bool_value = false;
+  int64_t int_value = 0;
+  double double_value = 0;
+  std::string_view string_value;
+  DoubleList double_list_value;
+};
+
+// Why the arguments of a call don't match the schema of its method.
+struct ArgError {
+  std::string argument;
+  // Completes "Argument '<argument>' ".
+  std::string message;
+};
+
+// The arguments of a method, decoded into the fields of |Args| in a single
+// pass over the argument map instead of a lookup per argument. Numbers are
+// coerced, an int is accepted for a double and a double without fraction
+// for an int. Any other mismatch, and a missing required argument, is an
+// error rather than garbage read from the wrong type. Unknown arguments
+// are ignored.
+template <typename Args>
+class ArgSchema {
+ public:
+  template <typename T>
+  ArgSchema& Required(const char* name, T Args::*field) {
+    fields_.push_back({name, true, reinterpret_cast<Member>(field),
+                       [](Member member, Args* args, const ArgValue& value) {
+                         T Args::*field = reinterpret_cast<T Args::*>(member);
+                         return Convert(value, &(args->*field));
+                       }});
+    return *this;
+  }
+
+  // Left unset when missing or null.
+  template <typename T>
+  ArgSchema& Optional(const char* name, std::optional<T> Args::*field) {
+    fields_.push_back(
+        {name, false, reinterpret_cast<Member>(field),
+         [](Member member, Args* args, const ArgValue& value) {
+           auto field = reinterpret_cast<std::optional<T> Args::*>(member);
+           T converted;
+           const char* expected = Convert(value, &converted);
+           if (expected == nullptr) {
+             args->*field = std::move(converted);
+           }
+           return expected;
+         }});
+    return *this;
+  }
+
+  // Adds a check of the decoded arguments for what their types don't tell,
+  // such as ranges. It returns the error of the first invalid argument.
+  ArgSchema& Check(std::optional<ArgError> (*check)(const Args& args)) {
+    checks_.push_back(check);
+    return *this;
+  }
+
+  // |for_each_entry| calls the function it is given with the key and value
+  // of every entry of the argument map.
+  template <typename ForEachEntry>
+  std::optional<ArgError> Decode(ForEachEntry for_each_entry,
+                                 Args* args) const {
+    uint64_t seen = 0;
+    std::optional<ArgError> error;
+    // Dart usually sends the arguments in the order of the schema, so the
+    // search for a key starts after the field of the previous one.
+    size_t next = 0;
+    for_each_entry([&](std::string_view key, const ArgValue& value) {
+      if (error) {
+        return;
+      }
+      for (size_t j = 0; j < fields_.size(); j++) {
+        size_t i = next + j < fields_.size() ? next + j
+                                             : next + j - fields_.size();
+        if (key != fields_[i].name) {
+          continue;
+        }
+        next = i + 1;
+        if (value.kind == ArgValue::Kind::kNull) {
+          break;
+        }
+        const char* expected =
+            fields_[i].set(fields_[i].member, args, value);
+        if (expected != nullptr) {
+          error = ArgError{std::string(fields_[i].name),
+                           std::string("must be ") + expected};
+        } else {
+          seen |= uint64_t{1} << i;
+        }
+        break;
+      }
+    });
+    if (error) {
+      return error;
+    }
+    for (size_t i = 0; i < fields_.size(); i++) {
+      if (fields_[i].required && (seen & (uint64_t{1} << i)) == 0) {
+        return ArgError{std::string(fields_[i].name), "is required"};
+      }
+    }
+    for (auto check : checks_) {
+      if (auto check_error = check(*args)) {
+        return check_error;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  // Any field of |Args|, cast back to its type by the setter of its Field.
+  // Unlike a capturing std::function, it takes no indirect call through a
+  // heap allocation, which made the pass slower than a lookup per argument
+  // for small maps.
+  using Member = char Args::*;
+
+  struct Field {
+    std::string_view name;
+    bool required;
+    Member member;
+    // Returns the expected type when |value| doesn't convert.
+    const char* (*set)(Member member, Args* args, const ArgValue& value);
+  };
+
+  static const char* Convert(const ArgValue& value, bool* out) {
+    if (value.kind != ArgValue::Kind::kBool) {
+      return "a bool";
+    }
+    *out = value.bool_value;
+    return nullptr;
+  }
+
+  static const char* Convert(const ArgValue& value, int64_t* out) {
+    if (value.kind == ArgValue::Kind::kInt) {
+      *out = value.int_value;
+      return nullptr;
+    }
+    if (value.kind == ArgValue::Kind::kDouble &&
+        std::trunc(value.double_value) == value.double_value &&
+        std::fabs(value.double_value) < 9007199254740992.0) {
+      *out = static_cast<int64_t>(value.double_value);
+      return nullptr;
+    }
+    return "an int";
+  }
+
+  static const char* Convert(const ArgValue& value, double* out) {
+    if (value.kind == ArgValue::Kind::kDouble) {
+      *out = value.double_value;
+      return nullptr;
+    }
+    if (value.kind == ArgValue::Kind::kInt) {
+      *out = static_cast<double>(value.int_value);
+      return nullptr;
+    }
+    return "a double";
+  }
+
+  static const char* Convert(const ArgValue& value, std::string* out) {
+    if (value.kind != ArgValue::Kind::kString) {
+      return "a string";
+    }
+    out->assign(value.string_value);
+    return nullptr;
+  }
+
+  static const char* Convert(const ArgValue& value, DoubleList* out) {
+    if (value.kind != ArgValue::Kind::kDoubleList) {
+      return "a Float64List";
+    }
+    *out = value.double_list_value;
+    return nullptr;
+  }
+
+  // Lists of numbers arrive as a DoubleList, which holds ints exactly up to
+  // 2^53.
+  static const char* Convert(const ArgValue& value, std::vector<int64_t>* out) {
+    if (value.kind != ArgValue::Kind::kDoubleList) {
+      return "a list of ints";
+    }
+    out->clear();
+    for (size_t i = 0; i < value.double_list_value.size; i++) {
+      double item = value.double_list_value.data[i];
+      if (std::trunc(item) != item || std::fabs(item) >= 9007199254740992.0) {
+        return "a list of ints";
+      }
+      out->push_back(static_cast<int64_t>(item));
+    }
+    return nullptr;
+  }
+
+  // At most 64, the bits of |seen|.
+  std::vector<Field> fields_;
+  std::vector<std::optional<ArgError> (*)(const Args&)> checks_;
+};
+
+// The arguments of setBounds, the missing ones are left as they are.
+struct BoundsArgs {
+  std::optional<double> x;
+  std::optional<double> y;
+  std::optional<double> width;
+  std::optional<double> height;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<BoundsArgs>& BoundsArgsSchema() {
+  static const ArgSchema<BoundsArgs> schema =
+      ArgSchema<BoundsArgs>()
+          .Optional("x", &BoundsArgs::x)
+          .Optional("y", &BoundsArgs::y)
+          .Optional("width", &BoundsArgs::width)
+          .Optional("height", &BoundsArgs::height)
+          .Optional("devicePixelRatio", &BoundsArgs::device_pixel_ratio);
+  return schema;
+}
+
+// The arguments of setMinimumSize and setMaximumSize, negative sizes
+// remove the constraint.
+struct SizeArgs {
+  double width = 0;
+  double height = 0;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<SizeArgs>& SizeArgsSchema() {
+  static const ArgSchema<SizeArgs> schema =
+      ArgSchema<SizeArgs>()
+          .Required("width", &SizeArgs::width)
+          .Required("height", &SizeArgs::height)
+          .Optional("devicePixelRatio", &SizeArgs::device_pixel_ratio);
+  return schema;
+}
+
+struct OpacityArgs {
+  double opacity = 1;
+};
+
+inline const ArgSchema<OpacityArgs>& OpacityArgsSchema() {
+  static const ArgSchema<OpacityArgs> schema =
+      ArgSchema<OpacityArgs>().Required("opacity", &OpacityArgs::opacity);
+  return schema;
+}
+
+// Channels of setBackgroundColor, from 0 to 255.
+struct BackgroundColorArgs {
+  int64_t r = 0;
+  int64_t g = 0;
+  int64_t b = 0;
+  int64_t a = 0;
+};
+
+inline const ArgSchema<BackgroundColorArgs>& BackgroundColorArgsSchema() {
+  static const ArgSchema<BackgroundColorArgs> schema =
+      ArgSchema<BackgroundColorArgs>()
+          .Required("backgroundColorR", &BackgroundColorArgs::r)
+          .Required("backgroundColorG", &BackgroundColorArgs::g)
+          .Required("backgroundColorB", &BackgroundColorArgs::b)
+          .Required("backgroundColorA", &BackgroundColorArgs::a);
+  return schema;
+}
+
+struct ResizeBorderArgs {
+  double width = 0;
+  bool top = false;
+  bool bottom = false;
+  bool left = false;
+  bool right = false;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<ResizeBorderArgs>& ResizeBorderArgsSchema() {
+  static const ArgSchema<ResizeBorderArgs> schema =
+      ArgSchema<ResizeBorderArgs>()
+          .Required("width", &ResizeBorderArgs::width)
+          .Required("top", &ResizeBorderArgs::top)
+          .Required("bottom", &ResizeBorderArgs::bottom)
+          .Required("left", &ResizeBorderArgs::left)
+          .Required("right", &ResizeBorderArgs::right)
+          .Optional("devicePixelRatio", &ResizeBorderArgs::device_pixel_ratio);
+  return schema;
+}
+
+// The arguments of setParentWindow, no parentId detaches the window and a
+// missing offset keeps its current one.
+struct ParentWindowArgs {
+  std::optional<int64_t> parent_id;
+  std::optional<double> offset_x;
+  std::optional<double> offset_y;
+  bool minimize_with_parent = false;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<ParentWindowArgs>& ParentWindowArgsSchema() {
+  static const ArgSchema<ParentWindowArgs> schema =
+      ArgSchema<ParentWindowArgs>()
+          .Optional("parentId", &ParentWindowArgs::parent_id)
+          .Optional("offsetX", &ParentWindowArgs::offset_x)
+          .Optional("offsetY", &ParentWindowArgs::offset_y)
+          .Required("minimizeWithParent",
+                    &ParentWindowArgs::minimize_with_parent)
+          .Optional("devicePixelRatio", &ParentWindowArgs::device_pixel_ratio);
+  return schema;
+}
+
+// The arguments of setDragRegions, rectangles packed as left, top, width
+// and height in logical pixels.
+struct DragRegionsArgs {
+  DoubleList regions;
+  DoubleList excluded_regions;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<DragRegionsArgs>& DragRegionsArgsSchema() {
+  static const ArgSchema<DragRegionsArgs> schema =
+      ArgSchema<DragRegionsArgs>()
+          .Required("regions", &DragRegionsArgs::regions)
+          .Required("excludedRegions", &DragRegionsArgs::excluded_regions)
+          .Optional("devicePixelRatio", &DragRegionsArgs::device_pixel_ratio);
+  return schema;
+}
+
+struct SnappingArgs {
+  bool is_snapping = false;
+  // In logical pixels.
+  double distance = 0;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline const ArgSchema<SnappingArgs>& SnappingArgsSchema() {
+  static const ArgSchema<SnappingArgs> schema =
+      ArgSchema<SnappingArgs>()
+          .Required("isSnapping", &SnappingArgs::is_snapping)
+          .Required("distance", &SnappingArgs::distance)
+          .Optional("devicePixelRatio", &SnappingArgs::device_pixel_ratio);
+  return schema;
+}
+
+// The alignment of align, from -1 (left, top) to 1 (right, bottom).
+struct AlignArgs {
+  double x = 0;
+  double y = 0;
+};
+
+inline const ArgSchema<AlignArgs>& AlignArgsSchema() {
+  static const ArgSchema<AlignArgs> schema = ArgSchema<AlignArgs>()
+                                                 .Required("x", &AlignArgs::x)
+                                                 .Required("y", &AlignArgs::y);
+  return schema;
+}
+
+struct ShowOnFirstFrameArgs {
+  bool is_show_on_first_frame = false;
+  // In milliseconds, negative ones are 0.
+  std::optional<int64_t> timeout;
+};
+
+inline const ArgSchema<ShowOnFirstFrameArgs>& ShowOnFirstFrameArgsSchema() {
+  static const ArgSchema<ShowOnFirstFrameArgs> schema =
+      ArgSchema<ShowOnFirstFrameArgs>()
+          .Required("isShowOnFirstFrame",
+                    &ShowOnFirstFrameArgs::is_show_on_first_frame)
+          .Optional("timeout", &ShowOnFirstFrameArgs::timeout);
+  return schema;
+}
+
+struct InputLatencyStatsArgs {
+  std::optional<bool> reset;
+};
+
+inline const ArgSchema<InputLatencyStatsArgs>& InputLatencyStatsArgsSchema() {
+  static const ArgSchema<InputLatencyStatsArgs> schema =
+      ArgSchema<InputLatencyStatsArgs>().Optional(
+          "reset", &InputLatencyStatsArgs::reset);
+  return schema;
+}
+
+struct IconArgs {
+  std::string icon_path;
+};
+
+inline const ArgSchema<IconArgs>& IconArgsSchema() {
+  static const ArgSchema<IconArgs> schema =
+      ArgSchema<IconArgs>().Required("iconPath", &IconArgs::icon_path);
+  return schema;
+}
+
+struct CursorStreamArgs {
+  bool enabled = false;
+};
+
+inline const ArgSchema<CursorStreamArgs>& CursorStreamArgsSchema() {
+  static const ArgSchema<CursorStreamArgs> schema =
+      ArgSchema<CursorStreamArgs>().Required("enabled",
+                                             &CursorStreamArgs::enabled);
+  return schema;
+}
+
+struct ThumbnailOptionsArgs {
+  bool enabled = false;
+  // In physical pixels.
+  int64_t max_width = 0;
+  int64_t max_height = 0;
+  // In milliseconds.
+  int64_t interval = 0;
+  int64_t max_stale_ticks = 0;
+};
+
+inline std::optional<ArgError> CheckThumbnailOptions(
+    const ThumbnailOptionsArgs& args) {
+  std::pair<const char*, int64_t> counts[] = {
+      {"maxWidth", args.max_width},
+      {"maxHeight", args.max_height},
+      {"interval", args.interval},
+      {"maxStaleTicks", args.max_stale_ticks},
+  };
+  for (const auto& [name, value] : counts) {
+    if (value < 0) {
+      return ArgError{name, "must not be negative"};
+    }
+  }
+  return std::nullopt;
+}
+
+inline const ArgSchema<ThumbnailOptionsArgs>& ThumbnailOptionsArgsSchema() {
+  static const ArgSchema<ThumbnailOptionsArgs> schema =
+      ArgSchema<ThumbnailOptionsArgs>()
+          .Required("enabled", &ThumbnailOptionsArgs::enabled)
+          .Required("maxWidth", &ThumbnailOptionsArgs::max_width)
+          .Required("maxHeight", &ThumbnailOptionsArgs::max_height)
+          .Required("interval", &ThumbnailOptionsArgs::interval)
+          .Required("maxStaleTicks", &ThumbnailOptionsArgs::max_stale_ticks)
+          .Check(CheckThumbnailOptions);
+  return schema;
+}
+
+// The arguments of setInputRegion, rectangles packed as left, top, width
+// and height in logical pixels. No regions makes the whole window take
+// input again.
+struct InputRegionArgs {
+  std::optional<DoubleList> regions;
+  std::optional<double> device_pixel_ratio;
+};
+
+inline std::optional<ArgError> CheckInputRegion(const InputRegionArgs& args) {
+  if (args.regions && args.regions->size % 4 != 0) {
+    return ArgError{"regions", "must hold 4 values per rectangle"};
+  }
+  return std::nullopt;
+}
+
+inline const ArgSchema<InputRegionArgs>& InputRegionArgsSchema() {
+  static const ArgSchema<InputRegionArgs> schema =
+      ArgSchema<InputRegionArgs>()
+          .Optional("regions", &InputRegionArgs::regions)
+          .Optional("devicePixelRatio", &InputRegionArgs::device_pixel_ratio)
+          .Check(CheckInputRegion);
+  return schema;
+}
+
+struct CaptureArgs {
+  // "rgba" or "bgra", the order of the bytes of a pixel.
+  std::optional<std::string> format;
+  std::optional<bool> premultiplied_alpha;
+
+  bool is_rgba() const { return format.value_or("rgba") == "rgba"; }
+};
+
+inline std::optional<ArgError> CheckCapture(const CaptureArgs& args) {
+  if (args.format && *args.format != "rgba" && *args.format != "bgra") {
+    return ArgError{"format", "must be 'rgba' or 'bgra'"};
+  }
+  return std::nullopt;
+}
+
+inline const ArgSchema<CaptureArgs>& CaptureArgsSchema() {
+  static const ArgSchema<CaptureArgs> schema =
+      ArgSchema<CaptureArgs>()
+          .Optional("format", &CaptureArgs::format)
+          .Optional("premultipliedAlpha", &CaptureArgs::premultiplied_alpha)
+          .Check(CheckCapture);
+  return schema;
+}
+
+struct TileWindowsArgs {
+  std::vector<int64_t> window_ids;
+  std::string mode;
+  std::optional<double> gap;
+  std::optional<double> master_ratio;
+  std::optional<int64_t> columns;
+  std::optional<std::string> display_id;
+
+  // |window_ids| in order, each only at its first position, so that a
+  // repeated id doesn't take two tiles.
+  std::vector<int64_t> unique_window_ids() const {
+    std::vector<int64_t> ids;
+    for (int64_t id : window_ids) {
+      if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }
+
+  TilingOptions tiling_options() const {
+    TilingOptions options;
+    ParseTilingMode(mode, &options.mode);
+    options.gap = gap.value_or(options.gap);
+    options.master_ratio = master_ratio.value_or(options.master_ratio);
+    // SolveTiling caps the columns to the windows.
+    options.columns = static_cast<int>(std::clamp<int64_t>(
+        columns.value_or(options.columns), 0, std::numeric_limits<int>::max()));
+    return options;
+  }
+};
+
+inline std::optional<ArgError> CheckTileWindows(const TileWindowsArgs& args) {
+  TilingMode mode;
+  if (!ParseTilingMode(args.mode, &mode)) {
+    return ArgError{"mode", "must be 'grid', 'columns' or 'masterStack'"};
+  }
+  return std::nullopt;
+}
+
+inline const ArgSchema<TileWindowsArgs>& TileWindowsArgsSchema() {
+  static const ArgSchema<TileWindowsArgs> schema =
+      ArgSchema<TileWindowsArgs>()
+          .Required("windowIds", &TileWindowsArgs::window_ids)
+          .Required("mode", &TileWindowsArgs::mode)
+          .Optional("gap", &TileWindowsArgs::gap)
+          .Optional("masterRatio", &TileWindowsArgs::master_ratio)
+          .Optional("columns", &TileWindowsArgs::columns)
+          .Optional("displayId", &TileWindowsArgs::display_id)
+          .Check(CheckTileWindows);
+  return schema;
+}
+
+struct EventPolicyArgs {
+  std::string event_name;
+  std::string policy;
+};
+
+inline std::optional<ArgError> CheckEventPolicy(const EventPolicyArgs& args) {
+  if (args.event_name.empty()) {
+    return ArgError{"eventName", "must not be empty"};
+  }
+  if (!EventPolicyFromName(args.policy)) {
+    return ArgError{"policy", "must be 'keepAll', 'latestWins' or 'drop'"};
+  }
+  return std::nullopt;
+}
+
+inline const ArgSchema<EventPolicyArgs>& EventPolicyArgsSchema() {
+  static const ArgSchema<EventPolicyArgs> schema =
+      ArgSchema<EventPolicyArgs>()
+          .Required("eventName", &EventPolicyArgs::event_name)
+          .Required("policy", &EventPolicyArgs::policy)
+          .Check(CheckEventPolicy);
+  return schema;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_METHOD_ARGS_H_
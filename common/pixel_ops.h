@@ -0,0 +1,202 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_PIXEL_OPS_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_PIXEL_OPS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WINDOW_MANAGER_PLUS_V2_SSE2 1
+#endif
+
+namespace window_manager_plus_v2 {
+
+// Kernels over 8-bit, 4-channel pixels (RGBA, BGRA, ...), which is what
+// icons and window captures use on every platform. Each one has an SSE2
+// path, always available on x86-64, and a scalar path for the remaining
+// pixels and the other architectures. Both produce the same bytes.
+
+namespace internal {
+
+inline uint8_t Average(uint8_t a, uint8_t b) {
+  return static_cast<uint8_t>((a + b + 1) >> 1);
+}
+
+}  // namespace internal
+
+// Halves a |width| x |height| image with a 2x2 box filter into |dst|, which
+// holds (width / 2) x (height / 2) pixels. An odd last row or column is
+// dropped. Strides are in bytes.
+inline void HalveImage(const uint8_t* src,
+                       size_t src_stride,
+                       int width,
+                       int height,
+                       uint8_t* dst,
+                       size_t dst_stride) {
+  int dst_width = width / 2;
+  int dst_height = height / 2;
+  for (int y = 0; y < dst_height; y++) {
+    const uint8_t* row0 = src + src_stride * (2 * y);
+    const uint8_t* row1 = row0 + src_stride;
+    uint8_t* out = dst + dst_stride * y;
+    int x = 0;
+#ifdef WINDOW_MANAGER_PLUS_V2_SSE2
+    // 8 source pixels of both rows give 4 destination pixels.
+    for (; x + 4 <= dst_width; x += 4) {
+      __m128i a = _mm_avg_epu8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8)),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8)));
+      __m128i b = _mm_avg_epu8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16)),
+          _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(row1 + x * 8 + 16)));
+      __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b),
+                                  _MM_SHUFFLE(3, 1, 3, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4),
+                       _mm_avg_epu8(_mm_castps_si128(even),
+                                    _mm_castps_si128(odd)));
+    }
+#endif
+    for (; x < dst_width; x++) {
+      for (int c = 0; c < 4; c++) {
+        out[x * 4 + c] = internal::Average(
+            internal::Average(row0[x * 8 + c], row1[x * 8 + c]),
+            internal::Average(row0[x * 8 + 4 + c], row1[x * 8 + 4 + c]));
+      }
+    }
+  }
+}
+
+// Swaps the first and third channel of |count| pixels, i.e. converts RGBA to
+// BGRA and back. |src| and |dst| may be the same buffer.
+inline void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t count) {
+  size_t i = 0;
+#ifdef WINDOW_MANAGER_PLUS_V2_SSE2
+  const __m128i green_alpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+  const __m128i red_blue = _mm_set1_epi32(0x00FF00FF);
+  for (; i + 4 <= count; i += 4) {
+    __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    // Within each 32-bit pixel, byte 0 and byte 2 trade places.
+    __m128i swapped = _mm_and_si128(
+        _mm_or_si128(_mm_slli_epi32(pixels, 16), _mm_srli_epi32(pixels, 16)),
+        red_blue);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i * 4),
+        _mm_or_si128(_mm_and_si128(pixels, green_alpha), swapped));
+  }
+#endif
+  for (; i < count; i++) {
+    uint8_t first = src[i * 4];
+    dst[i * 4] = src[i * 4 + 2];
+    dst[i * 4 + 1] = src[i * 4 + 1];
+    dst[i * 4 + 2] = first;
+    dst[i * 4 + 3] = src[i * 4 + 3];
+  }
+}
+
+// Sets the alpha channel (the fourth byte) of |count| pixels to opaque, for
+// captures whose alpha is left undefined by the platform.
+inline void SetOpaque(uint8_t* pixels, size_t count) {
+  size_t i = 0;
+#ifdef WINDOW_MANAGER_PLUS_V2_SSE2
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  for (; i + 4 <= count; i += 4) {
+    __m128i* block = reinterpret_cast<__m128i*>(pixels + i * 4);
+    _mm_storeu_si128(block, _mm_or_si128(_mm_loadu_si128(block), alpha));
+  }
+#endif
+  for (; i < count; i++) {
+    pixels[i * 4 + 3] = 0xFF;
+  }
+}
+
+// Converts |count| pixels from straight to premultiplied alpha in place,
+// whatever the order of the color channels as long as alpha comes last.
+// Filters such as HalveImage must run on premultiplied pixels, otherwise
+// the color of transparent pixels bleeds into the edges.
+inline void Premultiply(uint8_t* pixels, size_t count) {
+  size_t i = 0;
+#ifdef WINDOW_MANAGER_PLUS_V2_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  const __m128i half = _mm_set1_epi16(128);
+  // Two pixels per register, as 8 16-bit channels. c * a / 255 rounded,
+  // exactly, as (t + (t >> 8)) >> 8 with t = c * a + 128.
+  auto premultiply = [&](__m128i channels) {
+    __m128i alpha = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), half);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    __m128i* block = reinterpret_cast<__m128i*>(pixels + i * 4);
+    __m128i source = _mm_loadu_si128(block);
+    __m128i result =
+        _mm_packus_epi16(premultiply(_mm_unpacklo_epi8(source, zero)),
+                         premultiply(_mm_unpackhi_epi8(source, zero)));
+    _mm_storeu_si128(block,
+                     _mm_or_si128(_mm_andnot_si128(alpha_mask, result),
+                                  _mm_and_si128(source, alpha_mask)));
+  }
+#endif
+  for (; i < count; i++) {
+    uint8_t* pixel = pixels + i * 4;
+    for (int c = 0; c < 3; c++) {
+      unsigned t = pixel[c] * pixel[3] + 128u;
+      pixel[c] = static_cast<uint8_t>((t + (t >> 8)) >> 8);
+    }
+  }
+}
+
+// Converts |count| pixels from premultiplied to straight alpha in place,
+// whatever the order of the color channels as long as alpha comes last.
+// Fully transparent pixels become transparent black.
+inline void Unpremultiply(uint8_t* pixels, size_t count) {
+  size_t i = 0;
+#ifdef WINDOW_MANAGER_PLUS_V2_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  const __m128 max = _mm_set1_ps(255.0f);
+  // One pixel per register, as 4 floats.
+  auto unpremultiply = [&](__m128i channels) {
+    __m128 color = _mm_cvtepi32_ps(channels);
+    __m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128 factor = _mm_and_ps(_mm_div_ps(max, alpha),
+                               _mm_cmpgt_ps(alpha, _mm_setzero_ps()));
+    return _mm_cvtps_epi32(_mm_mul_ps(color, factor));
+  };
+  for (; i + 4 <= count; i += 4) {
+    __m128i* block = reinterpret_cast<__m128i*>(pixels + i * 4);
+    __m128i source = _mm_loadu_si128(block);
+    __m128i low = _mm_unpacklo_epi8(source, zero);
+    __m128i high = _mm_unpackhi_epi8(source, zero);
+    __m128i result = _mm_packus_epi16(
+        _mm_packs_epi32(unpremultiply(_mm_unpacklo_epi16(low, zero)),
+                        unpremultiply(_mm_unpackhi_epi16(low, zero))),
+        _mm_packs_epi32(unpremultiply(_mm_unpacklo_epi16(high, zero)),
+                        unpremultiply(_mm_unpackhi_epi16(high, zero))));
+    _mm_storeu_si128(block,
+                     _mm_or_si128(_mm_andnot_si128(alpha_mask, result),
+                                  _mm_and_si128(source, alpha_mask)));
+  }
+#endif
+  for (; i < count; i++) {
+    uint8_t* pixel = pixels + i * 4;
+    float factor = pixel[3] > 0 ? 255.0f / pixel[3] : 0.0f;
+    for (int c = 0; c < 3; c++) {
+      // Rounds to nearest even, like _mm_cvtps_epi32.
+      long value = std::lrint(pixel[c] * factor);
+      pixel[c] = static_cast<uint8_t>(value > 255 ? 255 : value);
+    }
+  }
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_PIXEL_OPS_H_
@@ -0,0 +1,170 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_PROTOCOL_CODEC_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_PROTOCOL_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace window_manager_plus_v2 {
+namespace protocol {
+
+// The codec of the calls declared in protocol/window_manager.idl, mirrored
+// by lib/src/protocol_codec.dart. Values are packed one after the other
+// without padding nor tags, in the order of the declaration:
+// - bool: 1 byte.
+// - int, double: 8 bytes, little-endian like every platform of the plugin.
+// - string: its length as 4 bytes, then its UTF-8 bytes.
+// - T?: 1 byte telling whether the T follows.
+// - struct: its fields.
+// A call is the method index as 2 bytes, the target window id as an int,
+// then the arguments. A reply is a status byte, then the result when it's
+// kReplyOk, or the error code and message strings otherwise.
+constexpr uint8_t kReplyOk = 0;
+constexpr uint8_t kReplyError = 1;
+
+class ProtocolReader {
+ public:
+  ProtocolReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  bool ReadBytes(void* out, size_t count) {
+    if (size_ - offset_ < count) {
+      return false;
+    }
+    std::memcpy(out, data_ + offset_, count);
+    offset_ += count;
+    return true;
+  }
+
+  const uint8_t* Skip(size_t count) {
+    if (size_ - offset_ < count) {
+      return nullptr;
+    }
+    const uint8_t* start = data_ + offset_;
+    offset_ += count;
+    return start;
+  }
+
+  bool AtEnd() const { return offset_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+class ProtocolWriter {
+ public:
+  void WriteBytes(const void* data, size_t count) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + count);
+  }
+
+  std::vector<uint8_t> Take() { return std::move(buffer_); }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+inline bool Read(ProtocolReader* reader, uint16_t* value) {
+  return reader->ReadBytes(value, sizeof(*value));
+}
+
+inline bool Read(ProtocolReader* reader, bool* value) {
+  uint8_t byte;
+  if (!reader->ReadBytes(&byte, 1) || byte > 1) {
+    return false;
+  }
+  *value = byte != 0;
+  return true;
+}
+
+inline bool Read(ProtocolReader* reader, int64_t* value) {
+  return reader->ReadBytes(value, sizeof(*value));
+}
+
+inline bool Read(ProtocolReader* reader, double* value) {
+  return reader->ReadBytes(value, sizeof(*value));
+}
+
+inline bool Read(ProtocolReader* reader, std::string* value) {
+  uint32_t length;
+  if (!reader->ReadBytes(&length, sizeof(length))) {
+    return false;
+  }
+  const uint8_t* bytes = reader->Skip(length);
+  if (bytes == nullptr) {
+    return false;
+  }
+  value->assign(reinterpret_cast<const char*>(bytes), length);
+  return true;
+}
+
+template <typename T>
+bool Read(ProtocolReader* reader, std::optional<T>* value) {
+  bool is_present;
+  if (!Read(reader, &is_present)) {
+    return false;
+  }
+  if (!is_present) {
+    value->reset();
+    return true;
+  }
+  T present;
+  if (!Read(reader, &present)) {
+    return false;
+  }
+  *value = std::move(present);
+  return true;
+}
+
+inline void Write(ProtocolWriter* writer, uint8_t value) {
+  writer->WriteBytes(&value, 1);
+}
+
+inline void Write(ProtocolWriter* writer, uint16_t value) {
+  writer->WriteBytes(&value, sizeof(value));
+}
+
+inline void Write(ProtocolWriter* writer, bool value) {
+  Write(writer, static_cast<uint8_t>(value ? 1 : 0));
+}
+
+inline void Write(ProtocolWriter* writer, int64_t value) {
+  writer->WriteBytes(&value, sizeof(value));
+}
+
+inline void Write(ProtocolWriter* writer, double value) {
+  writer->WriteBytes(&value, sizeof(value));
+}
+
+inline void Write(ProtocolWriter* writer, const std::string& value) {
+  uint32_t length = static_cast<uint32_t>(value.size());
+  writer->WriteBytes(&length, sizeof(length));
+  writer->WriteBytes(value.data(), value.size());
+}
+
+template <typename T>
+void Write(ProtocolWriter* writer, const std::optional<T>& value) {
+  Write(writer, value.has_value());
+  if (value) {
+    Write(writer, *value);
+  }
+}
+
+inline std::vector<uint8_t> EncodeErrorReply(const std::string& code,
+                                             const std::string& message) {
+  ProtocolWriter writer;
+  Write(&writer, kReplyError);
+  Write(&writer, code);
+  Write(&writer, message);
+  return writer.Take();
+}
+
+}  // namespace protocol
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_PROTOCOL_CODEC_H_
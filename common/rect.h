@@ -0,0 +1,43 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_RECT_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_RECT_H_
+
+namespace window_manager_plus_v2 {
+
+struct Point {
+  double x = 0;
+  double y = 0;
+};
+
+// A rectangle in the platform's native units, origin at the top left.
+struct Rect {
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+
+  double right() const { return x + width; }
+  double bottom() const { return y + height; }
+
+  bool Contains(double point_x, double point_y) const {
+    return point_x >= x && point_x < right() && point_y >= y &&
+           point_y < bottom();
+  }
+};
+
+// Top left corner of a |width| x |height| window aligned inside |area| the
+// way Flutter's Alignment works: (-1, -1) is the top left corner of the
+// area, (0, 0) its center and (1, 1) its bottom right corner.
+inline Point AlignWithin(const Rect& area,
+                         double width,
+                         double height,
+                         double alignment_x,
+                         double alignment_y) {
+  double free_width = area.width - width;
+  double free_height = area.height - height;
+  return {area.x + free_width / 2 + alignment_x * free_width / 2,
+          area.y + free_height / 2 + alignment_y * free_height / 2};
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_RECT_H_
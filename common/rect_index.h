@@ -0,0 +1,154 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_RECT_INDEX_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_RECT_INDEX_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "rect.h"
+
+namespace window_manager_plus_v2 {
+
+// Point lookup over a set of rectangles, for hit testing the pointer on
+// every button press or WM_NCHITTEST.
+//
+// The rectangles are bucketed in a uniform grid over their bounding box,
+// kept in two flat arrays (cell starts and items), so a lookup only tests
+// the few rectangles of a single cell however many there are.
+class RectIndex {
+ public:
+  void Reset(std::vector<Rect> rects) {
+    rects_ = std::move(rects);
+    cell_starts_.clear();
+    cell_items_.clear();
+    if (rects_.empty()) {
+      return;
+    }
+
+    double left = rects_.front().x;
+    double top = rects_.front().y;
+    double right = rects_.front().right();
+    double bottom = rects_.front().bottom();
+    for (const Rect& rect : rects_) {
+      left = std::min(left, rect.x);
+      top = std::min(top, rect.y);
+      right = std::max(right, rect.right());
+      bottom = std::max(bottom, rect.bottom());
+    }
+    origin_ = {left, top};
+    columns_ = GridSize(right - left);
+    rows_ = GridSize(bottom - top);
+    cell_width_ = std::max(1.0, (right - left) / columns_);
+    cell_height_ = std::max(1.0, (bottom - top) / rows_);
+
+    // Counts the rectangles of every cell, then fills them in place.
+    cell_starts_.assign(columns_ * rows_ + 1, 0);
+    ForEachCell([this](size_t cell, uint32_t) { cell_starts_[cell + 1]++; });
+    for (size_t i = 1; i < cell_starts_.size(); i++) {
+      cell_starts_[i] += cell_starts_[i - 1];
+    }
+    cell_items_.resize(cell_starts_.back());
+    std::vector<uint32_t> next(cell_starts_.begin(), cell_starts_.end() - 1);
+    ForEachCell([this, &next](size_t cell, uint32_t item) {
+      cell_items_[next[cell]++] = item;
+    });
+  }
+
+  bool IsEmpty() const { return rects_.empty(); }
+
+  bool Contains(double x, double y) const {
+    if (rects_.empty()) {
+      return false;
+    }
+    double column = std::floor((x - origin_.x) / cell_width_);
+    double row = std::floor((y - origin_.y) / cell_height_);
+    if (column < 0 || row < 0 || column >= columns_ || row >= rows_) {
+      return false;
+    }
+    size_t cell = static_cast<size_t>(row) * columns_ +
+                  static_cast<size_t>(column);
+    for (uint32_t i = cell_starts_[cell]; i < cell_starts_[cell + 1]; i++) {
+      if (rects_[cell_items_[i]].Contains(x, y)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // Cells of roughly 32 units, at most 64 per axis.
+  static size_t GridSize(double extent) {
+    return static_cast<size_t>(
+        std::clamp(std::ceil(extent / 32), 1.0, 64.0));
+  }
+
+  template <typename Visitor>
+  void ForEachCell(Visitor visit) const {
+    for (uint32_t item = 0; item < rects_.size(); item++) {
+      const Rect& rect = rects_[item];
+      size_t first_column = CellOf(rect.x - origin_.x, cell_width_, columns_);
+      size_t last_column =
+          CellOf(rect.right() - origin_.x, cell_width_, columns_);
+      size_t first_row = CellOf(rect.y - origin_.y, cell_height_, rows_);
+      size_t last_row = CellOf(rect.bottom() - origin_.y, cell_height_, rows_);
+      for (size_t row = first_row; row <= last_row; row++) {
+        for (size_t column = first_column; column <= last_column; column++) {
+          visit(row * columns_ + column, item);
+        }
+      }
+    }
+  }
+
+  static size_t CellOf(double offset, double cell_size, size_t count) {
+    double cell = std::floor(offset / cell_size);
+    return static_cast<size_t>(
+        std::clamp(cell, 0.0, static_cast<double>(count - 1)));
+  }
+
+  std::vector<Rect> rects_;
+  Point origin_;
+  size_t columns_ = 0;
+  size_t rows_ = 0;
+  double cell_width_ = 1;
+  double cell_height_ = 1;
+  std::vector<uint32_t> cell_starts_;
+  std::vector<uint32_t> cell_items_;
+};
+
+// Rectangles packed as x, y, width, height, which is how they cross the
+// method channel.
+inline std::vector<Rect> RectsFromValues(const double* values, size_t count) {
+  std::vector<Rect> rects;
+  rects.reserve(count / 4);
+  for (size_t i = 0; i + 3 < count; i += 4) {
+    rects.push_back({values[i], values[i + 1], values[i + 2], values[i + 3]});
+  }
+  return rects;
+}
+
+// The areas of a window that drag it like a title bar, in logical pixels
+// relative to the Flutter view. The holes, e.g. caption buttons, are cut
+// out of the regions.
+class DragRegions {
+ public:
+  void Reset(std::vector<Rect> regions, std::vector<Rect> holes) {
+    regions_.Reset(std::move(regions));
+    holes_.Reset(std::move(holes));
+  }
+
+  bool IsEmpty() const { return regions_.IsEmpty(); }
+
+  bool HitTest(double x, double y) const {
+    return regions_.Contains(x, y) && !holes_.Contains(x, y);
+  }
+
+ private:
+  RectIndex regions_;
+  RectIndex holes_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_RECT_INDEX_H_
@@ -0,0 +1,72 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_RESIZE_BORDER_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_RESIZE_BORDER_H_
+
+namespace window_manager_plus_v2 {
+
+enum class ResizeEdge {
+  kNone,
+  kTop,
+  kBottom,
+  kLeft,
+  kRight,
+  kTopLeft,
+  kTopRight,
+  kBottomLeft,
+  kBottomRight,
+};
+
+// The band along the sides of a frameless window that resizes it, hit tested
+// natively on every button press or WM_NCHITTEST.
+struct ResizeBorder {
+  // 0 or less disables the border.
+  double width = 0;
+  bool top = true;
+  bool bottom = true;
+  bool left = true;
+  bool right = true;
+
+  bool IsEnabled() const {
+    return width > 0 && (top || bottom || left || right);
+  }
+
+  // The edge under the point (|x|, |y|) of a |window_width| x
+  // |window_height| window, all in the same units. Corners need both of
+  // their sides enabled, otherwise the enabled side wins.
+  ResizeEdge Classify(double x,
+                      double y,
+                      double window_width,
+                      double window_height) const {
+    if (!IsEnabled() || x < 0 || y < 0 || x >= window_width ||
+        y >= window_height) {
+      return ResizeEdge::kNone;
+    }
+    bool is_top = top && y < width;
+    bool is_bottom = bottom && !is_top && y >= window_height - width;
+    bool is_left = left && x < width;
+    bool is_right = right && !is_left && x >= window_width - width;
+
+    if (is_top) {
+      if (is_left) {
+        return ResizeEdge::kTopLeft;
+      }
+      return is_right ? ResizeEdge::kTopRight : ResizeEdge::kTop;
+    }
+    if (is_bottom) {
+      if (is_left) {
+        return ResizeEdge::kBottomLeft;
+      }
+      return is_right ? ResizeEdge::kBottomRight : ResizeEdge::kBottom;
+    }
+    if (is_left) {
+      return ResizeEdge::kLeft;
+    }
+    if (is_right) {
+      return ResizeEdge::kRight;
+    }
+    return ResizeEdge::kNone;
+  }
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_RESIZE_BORDER_H_
@@ -0,0 +1,45 @@
+#include "cursor_sampler.h"
+
+#include "test.h"
+
+using window_manager_plus_v2::CursorSampler;
+
+TEST(OnlyChangesAreKept) {
+  CursorSampler sampler;
+  sampler.Sample(0, 1, 2);
+  sampler.Sample(8000, 1, 2);
+  sampler.Sample(16000, 3, 4);
+  EXPECT_TRUE(sampler.IsDue(16000));
+  std::vector<double> samples = sampler.TakeSamples(16000);
+  EXPECT_EQ(samples.size(), static_cast<size_t>(6));
+  EXPECT_EQ(samples[3], 16000.0);
+  EXPECT_EQ(samples[5], 4.0);
+  EXPECT_TRUE(!sampler.IsDue(40000));
+}
+
+TEST(IdleAfterUnchangedSamples) {
+  CursorSampler sampler;
+  sampler.Sample(0, 1, 2);
+  for (int i = 1; i < CursorSampler::kIdleSamples; i++) {
+    sampler.Sample(i * 16000, 1, 2);
+  }
+  EXPECT_TRUE(!sampler.IsIdle());
+  sampler.Sample(CursorSampler::kIdleSamples * 16000, 1, 2);
+  EXPECT_TRUE(sampler.IsIdle());
+  sampler.Sample(CursorSampler::kIdleSamples * 16000 + 100000, 5, 2);
+  EXPECT_TRUE(!sampler.IsIdle());
+}
+
+TEST(ResetIsNotIdle) {
+  CursorSampler sampler;
+  for (int i = 0; i <= CursorSampler::kIdleSamples; i++) {
+    sampler.Sample(i * 16000, 1, 2);
+  }
+  EXPECT_TRUE(sampler.IsIdle());
+  sampler.Reset();
+  EXPECT_TRUE(!sampler.IsIdle());
+  sampler.Sample(0, 1, 2);
+  EXPECT_TRUE(sampler.IsDue(16000));
+}
+
+TEST_MAIN()
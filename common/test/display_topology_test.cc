@@ -0,0 +1,78 @@
+#include "display_topology.h"
+
+#include "test.h"
+
+using window_manager_plus_v2::Display;
+using window_manager_plus_v2::DisplayTopology;
+using window_manager_plus_v2::Rect;
+
+// Two 1920x1080 monitors side by side, the right one primary.
+static DisplayTopology SideBySide() {
+  Display left;
+  left.id = "left";
+  left.bounds = {0, 0, 1920, 1080};
+  left.work_area = {0, 0, 1920, 1040};
+  Display right;
+  right.id = "right";
+  right.bounds = {1920, 0, 1920, 1080};
+  right.work_area = {1920, 0, 1920, 1040};
+  right.is_primary = true;
+
+  DisplayTopology topology;
+  topology.Reset({left, right});
+  return topology;
+}
+
+TEST(FindByPointUsesHalfOpenBounds) {
+  DisplayTopology topology = SideBySide();
+  EXPECT_EQ(topology.FindByPoint(0, 0)->id, "left");
+  EXPECT_EQ(topology.FindByPoint(1919.5, 500)->id, "left");
+  EXPECT_EQ(topology.FindByPoint(1920, 500)->id, "right");
+  EXPECT_TRUE(topology.FindByPoint(3840, 500) == nullptr);
+  EXPECT_TRUE(topology.FindByPoint(100, -1) == nullptr);
+}
+
+TEST(FindByRectSpanningTwoDisplaysPicksTheLargerOverlap) {
+  DisplayTopology topology = SideBySide();
+  EXPECT_EQ(topology.FindByRect({1500, 100, 800, 600})->id, "left");
+  EXPECT_EQ(topology.FindByRect({1800, 100, 800, 600})->id, "right");
+}
+
+TEST(FindByRectOffEveryDisplayPicksTheNearest) {
+  DisplayTopology topology = SideBySide();
+  EXPECT_EQ(topology.FindByRect({-900, 100, 800, 600})->id, "left");
+  EXPECT_EQ(topology.FindByRect({4000, 2000, 800, 600})->id, "right");
+  // Above the right display, diagonally off the left one.
+  EXPECT_EQ(topology.FindByRect({2000, -700, 800, 600})->id, "right");
+}
+
+TEST(EmptyTopologyFindsNothing) {
+  DisplayTopology topology;
+  EXPECT_TRUE(!topology.IsValid());
+  EXPECT_TRUE(topology.FindByRect({0, 0, 800, 600}) == nullptr);
+  EXPECT_TRUE(topology.FindByPoint(0, 0) == nullptr);
+  EXPECT_TRUE(topology.Primary() == nullptr);
+
+  topology.Reset({});
+  EXPECT_TRUE(topology.IsValid());
+  EXPECT_TRUE(topology.FindByRect({0, 0, 800, 600}) == nullptr);
+}
+
+TEST(PrimaryFallsBackToTheFirstDisplay) {
+  DisplayTopology topology = SideBySide();
+  EXPECT_EQ(topology.Primary()->id, "right");
+
+  std::vector<Display> displays = topology.displays();
+  displays[1].is_primary = false;
+  topology.Reset(displays);
+  EXPECT_EQ(topology.Primary()->id, "left");
+}
+
+TEST(InvalidateDropsTheDisplays) {
+  DisplayTopology topology = SideBySide();
+  topology.Invalidate();
+  EXPECT_TRUE(!topology.IsValid());
+  EXPECT_TRUE(topology.displays().empty());
+}
+
+TEST_MAIN()
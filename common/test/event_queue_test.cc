@@ -0,0 +1,131 @@
+#include "event_queue.h"
+
+#include "test.h"
+
+using window_manager_plus_v2::EventPolicy;
+using window_manager_plus_v2::EventPolicyFromName;
+using window_manager_plus_v2::EventQueue;
+
+using Queue = EventQueue<int>;
+
+// Fills the in-flight slots with unrelated events.
+static void Saturate(Queue* queue) {
+  for (size_t i = 0; i < Queue::kMaxInFlight; i++) {
+    EXPECT_TRUE(queue->Push("focus", "focus", -1).has_value());
+  }
+}
+
+TEST(SendsRightAwayUntilMaxInFlight) {
+  Queue queue;
+  Saturate(&queue);
+  EXPECT_TRUE(!queue.Push("focus", "focus", 1).has_value());
+  EXPECT_EQ(queue.stats().in_flight, Queue::kMaxInFlight);
+  EXPECT_EQ(queue.stats().depth, 1u);
+  EXPECT_EQ(queue.stats().sent, Queue::kMaxInFlight);
+}
+
+TEST(RepliesReleaseTheQueuedEventsInOrder) {
+  Queue queue;
+  Saturate(&queue);
+  queue.Push("focus", "focus", 1);
+  queue.Push("blur", "blur", 2);
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(1));
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(2));
+  EXPECT_EQ(queue.stats().in_flight, Queue::kMaxInFlight);
+  EXPECT_TRUE(!queue.OnReply().has_value());
+  EXPECT_EQ(queue.stats().in_flight, Queue::kMaxInFlight - 1);
+
+  // Once a slot is free and nothing is queued, events go right away.
+  EXPECT_TRUE(queue.Push("focus", "focus", 3).has_value());
+}
+
+TEST(InFlightNeverUnderflows) {
+  Queue queue;
+  EXPECT_TRUE(!queue.OnReply().has_value());
+  EXPECT_EQ(queue.stats().in_flight, 0u);
+  EXPECT_TRUE(queue.Push("focus", "focus", 1).has_value());
+  EXPECT_EQ(queue.stats().in_flight, 1u);
+}
+
+TEST(LatestWinsReplacesTheQueuedEventWithTheSameKey) {
+  Queue queue;
+  Saturate(&queue);
+  queue.Push("move", "move:1", 10);
+  queue.Push("move", "move:2", 20);
+  queue.Push("move", "move:1", 11);
+  queue.Push("move", "move:1", 12);
+  EXPECT_EQ(queue.stats().depth, 2u);
+  EXPECT_EQ(queue.stats().coalesced, 2u);
+  // The replaced event keeps its place.
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(12));
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(20));
+}
+
+TEST(StreamsDefaultToLatestWins) {
+  Queue queue;
+  Saturate(&queue);
+  queue.Push("cursorSamples", "cursorSamples", 1);
+  queue.Push("cursorSamples", "cursorSamples", 2);
+  queue.Push("thumbnails", "thumbnails", 3);
+  queue.Push("thumbnails", "thumbnails", 4);
+  EXPECT_EQ(queue.stats().depth, 2u);
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(2));
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(4));
+}
+
+TEST(KeepAllQueuesEveryEvent) {
+  Queue queue;
+  Saturate(&queue);
+  queue.Push("focus", "focus", 1);
+  queue.Push("focus", "focus", 2);
+  EXPECT_EQ(queue.stats().depth, 2u);
+  EXPECT_EQ(queue.stats().coalesced, 0u);
+}
+
+TEST(DropPolicyDropsWhileBehind) {
+  Queue queue;
+  queue.SetPolicy("resize", EventPolicy::kDrop);
+  Saturate(&queue);
+  EXPECT_TRUE(!queue.Push("resize", "resize", 2).has_value());
+  EXPECT_EQ(queue.stats().depth, 0u);
+  EXPECT_EQ(queue.stats().dropped, 1u);
+}
+
+TEST(FullQueueEvictsTheOldestEvent) {
+  Queue queue;
+  Saturate(&queue);
+  for (int i = 0; i < static_cast<int>(Queue::kCapacity) + 3; i++) {
+    queue.Push("focus", "focus", i);
+  }
+  EXPECT_EQ(queue.stats().depth, Queue::kCapacity);
+  EXPECT_EQ(queue.stats().max_depth, Queue::kCapacity);
+  EXPECT_EQ(queue.stats().dropped, 3u);
+  EXPECT_EQ(queue.OnReply(), std::optional<int>(3));
+}
+
+TEST(DropPendingCountsTheEventAndTheQueue) {
+  Queue queue;
+  Saturate(&queue);
+  queue.Push("focus", "focus", 1);
+  queue.Push("focus", "focus", 2);
+  std::optional<int> next = queue.OnReply();
+  EXPECT_EQ(next, std::optional<int>(1));
+  // |next| can't be delivered.
+  queue.DropPending();
+  EXPECT_EQ(queue.stats().depth, 0u);
+  EXPECT_EQ(queue.stats().dropped, 2u);
+  EXPECT_EQ(queue.stats().in_flight, Queue::kMaxInFlight - 1);
+  EXPECT_EQ(queue.stats().sent, Queue::kMaxInFlight);
+}
+
+TEST(ParsesPolicyNames) {
+  EXPECT_EQ(EventPolicyFromName("keepAll"),
+            std::optional<EventPolicy>(EventPolicy::kKeepAll));
+  EXPECT_EQ(EventPolicyFromName("latestWins"),
+            std::optional<EventPolicy>(EventPolicy::kLatestWins));
+  EXPECT_EQ(EventPolicyFromName("drop"),
+            std::optional<EventPolicy>(EventPolicy::kDrop));
+  EXPECT_TRUE(!EventPolicyFromName("newest").has_value());
+}
+
+TEST_MAIN()
@@ -0,0 +1,319 @@
+#include "method_args.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+
+using namespace window_manager_plus_v2;
+
+namespace {
+
+using Entries = std::vector<std::pair<std::string, ArgValue>>;
+
+ArgValue Bool(bool value) {
+  ArgValue arg;
+  arg.kind = ArgValue::Kind::kBool;
+  arg.bool_value = value;
+  return arg;
+}
+
+ArgValue Int(int64_t value) {
+  ArgValue arg;
+  arg.kind = ArgValue::Kind::kInt;
+  arg.int_value = value;
+  return arg;
+}
+
+ArgValue Double(double value) {
+  ArgValue arg;
+  arg.kind = ArgValue::Kind::kDouble;
+  arg.double_value = value;
+  return arg;
+}
+
+// |value| must outlive the ArgValue, like the strings of a method call.
+ArgValue String(std::string_view value) {
+  ArgValue arg;
+  arg.kind = ArgValue::Kind::kString;
+  arg.string_value = value;
+  return arg;
+}
+
+ArgValue List(const std::vector<double>& values) {
+  ArgValue arg;
+  arg.kind = ArgValue::Kind::kDoubleList;
+  arg.double_list_value.data = values.data();
+  arg.double_list_value.size = values.size();
+  return arg;
+}
+
+template <typename Args>
+std::optional<ArgError> Decode(const ArgSchema<Args>& schema,
+                               const Entries& entries,
+                               Args* args) {
+  return schema.Decode(
+      [&entries](auto&& visit) {
+        for (const auto& [key, value] : entries) {
+          visit(key, value);
+        }
+      },
+      args);
+}
+
+}  // namespace
+
+TEST(DecodesRequiredAndOptionalArguments) {
+  SnappingArgs args;
+  EXPECT_TRUE(!Decode(SnappingArgsSchema(),
+                      {{"isSnapping", Bool(true)},
+                       {"distance", Double(12.5)},
+                       {"unknown", Int(1)}},
+                      &args));
+  EXPECT_TRUE(args.is_snapping);
+  EXPECT_EQ(args.distance, 12.5);
+  EXPECT_TRUE(!args.device_pixel_ratio.has_value());
+}
+
+TEST(CoercesNumbers) {
+  AlignArgs args;
+  EXPECT_TRUE(!Decode(AlignArgsSchema(), {{"x", Int(1)}, {"y", Double(-1)}},
+                      &args));
+  EXPECT_EQ(args.x, 1.0);
+  EXPECT_EQ(args.y, -1.0);
+
+  BackgroundColorArgs color;
+  EXPECT_TRUE(!Decode(BackgroundColorArgsSchema(),
+                      {{"backgroundColorR", Double(255)},
+                       {"backgroundColorG", Int(0)},
+                       {"backgroundColorB", Int(0)},
+                       {"backgroundColorA", Int(255)}},
+                      &color));
+  EXPECT_EQ(color.r, int64_t{255});
+  std::optional<ArgError> error =
+      Decode(BackgroundColorArgsSchema(),
+             {{"backgroundColorR", Double(0.5)},
+              {"backgroundColorG", Int(0)},
+              {"backgroundColorB", Int(0)},
+              {"backgroundColorA", Int(255)}},
+             &color);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("backgroundColorR"));
+  EXPECT_EQ(error->message, std::string("must be an int"));
+}
+
+TEST(MissingOrNullRequiredArgumentFails) {
+  AlignArgs args;
+  std::optional<ArgError> error =
+      Decode(AlignArgsSchema(), {{"x", Double(0)}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("y"));
+  EXPECT_EQ(error->message, std::string("is required"));
+
+  error = Decode(AlignArgsSchema(), {{"x", Double(0)}, {"y", ArgValue()}},
+                 &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("y"));
+}
+
+TEST(NullOptionalArgumentsStayUnset) {
+  ParentWindowArgs args;
+  EXPECT_TRUE(!Decode(ParentWindowArgsSchema(),
+                      {{"parentId", Int(3)},
+                       {"offsetX", ArgValue()},
+                       {"offsetY", ArgValue()},
+                       {"minimizeWithParent", Bool(true)}},
+                      &args));
+  EXPECT_EQ(args.parent_id, std::optional<int64_t>(3));
+  EXPECT_TRUE(!args.offset_x.has_value());
+  EXPECT_TRUE(!args.offset_y.has_value());
+  EXPECT_TRUE(args.minimize_with_parent);
+}
+
+TEST(WrongTypeFails) {
+  SnappingArgs args;
+  std::optional<ArgError> error = Decode(
+      SnappingArgsSchema(), {{"isSnapping", Int(1)}, {"distance", Double(1)}},
+      &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("isSnapping"));
+  EXPECT_EQ(error->message, std::string("must be a bool"));
+}
+
+TEST(DecodesDoubleListsWithoutCopying) {
+  std::vector<double> regions = {0, 0, 100, 20};
+  std::vector<double> holes;
+  DragRegionsArgs args;
+  EXPECT_TRUE(!Decode(DragRegionsArgsSchema(),
+                      {{"regions", List(regions)},
+                       {"excludedRegions", List(holes)},
+                       {"devicePixelRatio", Double(2)}},
+                      &args));
+  EXPECT_TRUE(args.regions.data == regions.data());
+  EXPECT_EQ(args.regions.size, size_t{4});
+  EXPECT_EQ(args.excluded_regions.size, size_t{0});
+  EXPECT_EQ(args.device_pixel_ratio, std::optional<double>(2));
+
+  std::optional<ArgError> error =
+      Decode(DragRegionsArgsSchema(),
+             {{"regions", Double(0)}, {"excludedRegions", List(holes)}},
+             &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("regions"));
+  EXPECT_EQ(error->message, std::string("must be a Float64List"));
+}
+
+TEST(ConvertedListsOutliveTheArgument) {
+  DragRegionsArgs args;
+  {
+    auto converted =
+        std::make_shared<std::vector<double>>(std::vector<double>{1, 2, 3, 4});
+    ArgValue regions;
+    regions.kind = ArgValue::Kind::kDoubleList;
+    regions.double_list_value.data = converted->data();
+    regions.double_list_value.size = converted->size();
+    regions.double_list_value.converted = std::move(converted);
+    std::vector<double> holes;
+    EXPECT_TRUE(!Decode(
+        DragRegionsArgsSchema(),
+        {{"regions", regions}, {"excludedRegions", List(holes)}}, &args));
+  }
+  EXPECT_EQ(args.regions.size, size_t{4});
+  EXPECT_EQ(args.regions.data[3], 4.0);
+}
+
+TEST(DecodesArgumentsInAnyOrder) {
+  BoundsArgs args;
+  EXPECT_TRUE(!Decode(BoundsArgsSchema(),
+                      {{"devicePixelRatio", Double(2)},
+                       {"height", Double(4)},
+                       {"width", Double(3)},
+                       {"windowId", Int(0)},
+                       {"x", Double(1)},
+                       {"y", Double(2)}},
+                      &args));
+  EXPECT_EQ(args.x, std::optional<double>(1));
+  EXPECT_EQ(args.y, std::optional<double>(2));
+  EXPECT_EQ(args.width, std::optional<double>(3));
+  EXPECT_EQ(args.height, std::optional<double>(4));
+  EXPECT_EQ(args.device_pixel_ratio, std::optional<double>(2));
+}
+
+TEST(ChecksRunAfterTheTypes) {
+  ThumbnailOptionsArgs args;
+  Entries entries = {{"enabled", Bool(true)},
+                     {"maxWidth", Int(320)},
+                     {"maxHeight", Int(240)},
+                     {"interval", Int(0)},
+                     {"maxStaleTicks", Int(8)}};
+  EXPECT_TRUE(!Decode(ThumbnailOptionsArgsSchema(), entries, &args));
+  EXPECT_EQ(args.interval, int64_t{0});
+
+  entries[3].second = Int(-1);
+  std::optional<ArgError> error =
+      Decode(ThumbnailOptionsArgsSchema(), entries, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("interval"));
+  EXPECT_EQ(error->message, std::string("must not be negative"));
+}
+
+TEST(InputRegionNeedsWholeRectangles) {
+  std::vector<double> regions = {0, 0, 10, 10, 20};
+  InputRegionArgs args;
+  std::optional<ArgError> error =
+      Decode(InputRegionArgsSchema(), {{"regions", List(regions)}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("regions"));
+
+  regions.pop_back();
+  EXPECT_TRUE(
+      !Decode(InputRegionArgsSchema(), {{"regions", List(regions)}}, &args));
+  EXPECT_EQ(args.regions->size, size_t{4});
+  args = InputRegionArgs();
+  EXPECT_TRUE(
+      !Decode(InputRegionArgsSchema(), {{"regions", ArgValue()}}, &args));
+  EXPECT_TRUE(!args.regions.has_value());
+}
+
+TEST(CaptureFormatMustBeKnown) {
+  ArgValue format;
+  format.kind = ArgValue::Kind::kString;
+  format.string_value = "argb";
+  CaptureArgs args;
+  std::optional<ArgError> error =
+      Decode(CaptureArgsSchema(), {{"format", format}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->message, std::string("must be 'rgba' or 'bgra'"));
+
+  format.string_value = "bgra";
+  args = CaptureArgs();
+  EXPECT_TRUE(!Decode(CaptureArgsSchema(),
+                      {{"format", format}, {"premultipliedAlpha", Bool(true)}},
+                      &args));
+  EXPECT_TRUE(!args.is_rgba());
+  EXPECT_EQ(args.premultiplied_alpha, std::optional<bool>(true));
+
+  error = Decode(CaptureArgsSchema(), {{"premultipliedAlpha", Int(1)}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("premultipliedAlpha"));
+}
+
+TEST(TileWindowsIdsAreIntsTiledOnce) {
+  std::vector<double> ids = {3, 1, 3, 2, 1};
+  TileWindowsArgs args;
+  EXPECT_TRUE(!Decode(TileWindowsArgsSchema(),
+                      {{"windowIds", List(ids)},
+                       {"mode", String("grid")},
+                       {"columns", Int(2)}},
+                      &args));
+  EXPECT_TRUE(args.unique_window_ids() == std::vector<int64_t>({3, 1, 2}));
+  EXPECT_EQ(args.tiling_options().columns, 2);
+
+  std::vector<double> fractional = {1, 2.5};
+  std::optional<ArgError> error = Decode(
+      TileWindowsArgsSchema(),
+      {{"windowIds", List(fractional)}, {"mode", String("grid")}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->message, std::string("must be a list of ints"));
+
+  ArgValue mixed;
+  mixed.kind = ArgValue::Kind::kOther;
+  error = Decode(TileWindowsArgsSchema(),
+                 {{"windowIds", mixed}, {"mode", String("grid")}}, &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("windowIds"));
+
+  error = Decode(TileWindowsArgsSchema(),
+                 {{"windowIds", List(ids)}, {"mode", String("spiral")}},
+                 &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("mode"));
+}
+
+TEST(EventPolicyMustBeKnown) {
+  EventPolicyArgs args;
+  std::optional<ArgError> error =
+      Decode(EventPolicyArgsSchema(),
+             {{"eventName", String("move")}, {"policy", String("latest")}},
+             &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("policy"));
+
+  error = Decode(EventPolicyArgsSchema(),
+                 {{"eventName", String("")}, {"policy", String("drop")}},
+                 &args);
+  EXPECT_TRUE(error.has_value());
+  EXPECT_EQ(error->argument, std::string("eventName"));
+
+  error = Decode(EventPolicyArgsSchema(),
+                 {{"eventName", String("move")}, {"policy", String("drop")}},
+                 &args);
+  EXPECT_TRUE(!error.has_value());
+  EXPECT_EQ(args.policy, std::string("drop"));
+}
+
+TEST_MAIN()
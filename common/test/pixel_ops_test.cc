@@ -0,0 +1,71 @@
+#include "pixel_ops.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "test.h"
+
+using window_manager_plus_v2::HalveImage;
+using window_manager_plus_v2::Premultiply;
+using window_manager_plus_v2::Unpremultiply;
+
+// Every alpha for a few colors, more pixels than a register holds and not
+// a multiple of it, so both paths run.
+static std::vector<uint8_t> AllAlphas() {
+  std::vector<uint8_t> pixels;
+  for (int alpha = 0; alpha < 256; alpha++) {
+    for (int color : {0, 1, 127, 128, 200, 255}) {
+      pixels.push_back(static_cast<uint8_t>(color));
+      pixels.push_back(static_cast<uint8_t>(255 - color));
+      pixels.push_back(static_cast<uint8_t>(color / 2));
+      pixels.push_back(static_cast<uint8_t>(alpha));
+    }
+  }
+  pixels.insert(pixels.end(), {10, 20, 30, 40});
+  return pixels;
+}
+
+TEST(PremultiplyRoundsToNearest) {
+  std::vector<uint8_t> pixels = AllAlphas();
+  std::vector<uint8_t> expected = pixels;
+  for (size_t i = 0; i < expected.size(); i += 4) {
+    for (size_t c = 0; c < 3; c++) {
+      expected[i + c] = static_cast<uint8_t>(
+          (expected[i + c] * expected[i + 3] * 2 + 255) / 510);
+    }
+  }
+  Premultiply(pixels.data(), pixels.size() / 4);
+  EXPECT_TRUE(pixels == expected);
+}
+
+TEST(PremultiplyThenUnpremultiplyKeepsOpaquePixels) {
+  std::vector<uint8_t> pixels = {1, 2, 3, 255, 250, 128, 0, 255};
+  std::vector<uint8_t> expected = pixels;
+  Premultiply(pixels.data(), 2);
+  EXPECT_TRUE(pixels == expected);
+  Unpremultiply(pixels.data(), 2);
+  EXPECT_TRUE(pixels == expected);
+}
+
+TEST(PremultiplyClearsTransparentPixels) {
+  std::vector<uint8_t> pixels = {255, 255, 255, 0};
+  Premultiply(pixels.data(), 1);
+  EXPECT_TRUE(pixels == (std::vector<uint8_t>{0, 0, 0, 0}));
+}
+
+// A red pixel next to transparent white ones, halved premultiplied, stays
+// red instead of turning pink.
+TEST(HalvingPremultipliedKeepsTheColorOfEdges) {
+  std::vector<uint8_t> pixels = {255, 0, 0, 255, 255, 255, 255, 0,
+                                 255, 255, 255, 0, 255, 255, 255, 0};
+  Premultiply(pixels.data(), 4);
+  uint8_t half[4];
+  HalveImage(pixels.data(), 8, 2, 2, half, 4);
+  Unpremultiply(half, 1);
+  EXPECT_EQ(half[0], 255);
+  EXPECT_EQ(half[1], 0);
+  EXPECT_EQ(half[2], 0);
+  EXPECT_EQ(half[3], 64);
+}
+
+TEST_MAIN()
@@ -0,0 +1,182 @@
+#include "window_manager_protocol.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using namespace window_manager_plus_v2::protocol;
+
+namespace {
+
+constexpr int64_t kWindowId = 7;
+
+// Records the calls it gets.
+class FakeApi : public WindowManagerApi {
+ public:
+  Bounds GetBounds(double device_pixel_ratio) override {
+    return {1, 2, 3 * device_pixel_ratio, 4};
+  }
+  void SetBounds(const std::optional<double>& x,
+                 const std::optional<double>& y,
+                 const std::optional<double>& width,
+                 const std::optional<double>& height,
+                 double device_pixel_ratio) override {
+    set_bounds_calls++;
+    last_x = x;
+    last_y = y;
+    last_width = width;
+    last_height = height;
+    last_device_pixel_ratio = device_pixel_ratio;
+  }
+  bool IsFocused() override { return true; }
+  bool IsVisible() override { return true; }
+  bool IsMaximized() override { return false; }
+  bool IsMinimized() override { return false; }
+  bool IsFullScreen() override { return false; }
+  double GetOpacity() override { return opacity; }
+  void SetOpacity(double value) override { opacity = value; }
+
+  int set_bounds_calls = 0;
+  std::optional<double> last_x;
+  std::optional<double> last_y;
+  std::optional<double> last_width;
+  std::optional<double> last_height;
+  double last_device_pixel_ratio = 0;
+  double opacity = 1;
+};
+
+ProtocolWriter StartCall(Method method, int64_t window_id = kWindowId) {
+  ProtocolWriter writer;
+  Write(&writer, static_cast<uint16_t>(method));
+  Write(&writer, window_id);
+  return writer;
+}
+
+std::vector<uint8_t> Handle(FakeApi* api, const std::vector<uint8_t>& call) {
+  return HandleCall(
+      [api](int64_t window_id) -> WindowManagerApi* {
+        return window_id == kWindowId ? api : nullptr;
+      },
+      call.data(), call.size());
+}
+
+// Returns the error code of |reply|, or "" when it succeeded.
+std::string ErrorCode(const std::vector<uint8_t>& reply) {
+  ProtocolReader reader(reply.data(), reply.size());
+  uint8_t status = kReplyOk;
+  reader.ReadBytes(&status, 1);
+  std::string code;
+  if (status != kReplyOk) {
+    Read(&reader, &code);
+  }
+  return code;
+}
+
+}  // namespace
+
+TEST(RoundTripsAResult) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kGetBounds);
+  Write(&writer, 2.0);
+  std::vector<uint8_t> reply = Handle(&api, writer.Take());
+
+  EXPECT_EQ(reply.size(), 1 + 4 * sizeof(double));
+  ProtocolReader reader(reply.data(), reply.size());
+  uint8_t status = kReplyError;
+  Bounds bounds;
+  EXPECT_TRUE(reader.ReadBytes(&status, 1));
+  EXPECT_EQ(status, kReplyOk);
+  EXPECT_TRUE(Read(&reader, &bounds));
+  EXPECT_TRUE(reader.AtEnd());
+  EXPECT_EQ(bounds.x, 1.0);
+  EXPECT_EQ(bounds.y, 2.0);
+  EXPECT_EQ(bounds.width, 6.0);
+  EXPECT_EQ(bounds.height, 4.0);
+}
+
+TEST(DecodesOptionalArguments) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kSetBounds);
+  Write(&writer, std::optional<double>(5.0));
+  Write(&writer, std::optional<double>());
+  Write(&writer, std::optional<double>(300.0));
+  Write(&writer, std::optional<double>());
+  Write(&writer, 1.5);
+  std::vector<uint8_t> reply = Handle(&api, writer.Take());
+
+  EXPECT_EQ(reply, std::vector<uint8_t>{kReplyOk});
+  EXPECT_EQ(api.set_bounds_calls, 1);
+  EXPECT_EQ(api.last_x, std::optional<double>(5.0));
+  EXPECT_TRUE(!api.last_y.has_value());
+  EXPECT_EQ(api.last_width, std::optional<double>(300.0));
+  EXPECT_TRUE(!api.last_height.has_value());
+  EXPECT_EQ(api.last_device_pixel_ratio, 1.5);
+}
+
+TEST(UnknownWindowFails) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kSetOpacity, kWindowId + 1);
+  Write(&writer, 0.5);
+  std::vector<uint8_t> reply = Handle(&api, writer.Take());
+
+  EXPECT_EQ(ErrorCode(reply), std::string("no-window"));
+  EXPECT_EQ(api.opacity, 1.0);
+}
+
+TEST(TruncatedCallFails) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kSetOpacity);
+  Write(&writer, 0.5);
+  std::vector<uint8_t> call = writer.Take();
+  call.pop_back();
+  EXPECT_EQ(ErrorCode(Handle(&api, call)), std::string("bad-message"));
+
+  // Too short for the window id.
+  call.resize(5);
+  EXPECT_EQ(ErrorCode(Handle(&api, call)), std::string("bad-message"));
+  EXPECT_EQ(api.opacity, 1.0);
+}
+
+TEST(TrailingBytesFail) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kSetOpacity);
+  Write(&writer, 0.5);
+  Write(&writer, true);
+  EXPECT_EQ(ErrorCode(Handle(&api, writer.Take())), std::string("bad-message"));
+  EXPECT_EQ(api.opacity, 1.0);
+}
+
+TEST(UnknownMethodFails) {
+  FakeApi api;
+  ProtocolWriter writer;
+  Write(&writer, static_cast<uint16_t>(0xffff));
+  Write(&writer, kWindowId);
+  EXPECT_EQ(ErrorCode(Handle(&api, writer.Take())), std::string("bad-message"));
+}
+
+TEST(InvalidBoolFails) {
+  FakeApi api;
+  ProtocolWriter writer = StartCall(Method::kSetBounds);
+  Write(&writer, static_cast<uint8_t>(2));
+  EXPECT_EQ(ErrorCode(Handle(&api, writer.Take())), std::string("bad-message"));
+  EXPECT_EQ(api.set_bounds_calls, 0);
+}
+
+TEST(ErrorReplyCarriesCodeAndMessage) {
+  std::vector<uint8_t> reply = EncodeErrorReply("code", "message");
+  ProtocolReader reader(reply.data(), reply.size());
+  uint8_t status = kReplyOk;
+  std::string code;
+  std::string message;
+  EXPECT_TRUE(reader.ReadBytes(&status, 1));
+  EXPECT_EQ(status, kReplyError);
+  EXPECT_TRUE(Read(&reader, &code));
+  EXPECT_TRUE(Read(&reader, &message));
+  EXPECT_TRUE(reader.AtEnd());
+  EXPECT_EQ(code, std::string("code"));
+  EXPECT_EQ(message, std::string("message"));
+}
+
+TEST_MAIN()
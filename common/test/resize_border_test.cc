@@ -0,0 +1,83 @@
+#include "resize_border.h"
+
+#include "test.h"
+
+using window_manager_plus_v2::ResizeBorder;
+using window_manager_plus_v2::ResizeEdge;
+
+static ResizeBorder Border(double width) {
+  ResizeBorder border;
+  border.width = width;
+  return border;
+}
+
+TEST(ClassifiesSidesAndCorners) {
+  ResizeBorder border = Border(8);
+  EXPECT_EQ(border.Classify(2, 2, 200, 100), ResizeEdge::kTopLeft);
+  EXPECT_EQ(border.Classify(197, 2, 200, 100), ResizeEdge::kTopRight);
+  EXPECT_EQ(border.Classify(2, 97, 200, 100), ResizeEdge::kBottomLeft);
+  EXPECT_EQ(border.Classify(197, 97, 200, 100), ResizeEdge::kBottomRight);
+  EXPECT_EQ(border.Classify(100, 2, 200, 100), ResizeEdge::kTop);
+  EXPECT_EQ(border.Classify(100, 97, 200, 100), ResizeEdge::kBottom);
+  EXPECT_EQ(border.Classify(2, 50, 200, 100), ResizeEdge::kLeft);
+  EXPECT_EQ(border.Classify(197, 50, 200, 100), ResizeEdge::kRight);
+  EXPECT_EQ(border.Classify(100, 50, 200, 100), ResizeEdge::kNone);
+}
+
+TEST(BorderEndsAtItsWidth) {
+  ResizeBorder border = Border(8);
+  EXPECT_EQ(border.Classify(100, 7.9, 200, 100), ResizeEdge::kTop);
+  EXPECT_EQ(border.Classify(100, 8, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(192, 50, 200, 100), ResizeEdge::kRight);
+  EXPECT_EQ(border.Classify(191.9, 50, 200, 100), ResizeEdge::kNone);
+}
+
+TEST(CornersWithOneSideDisabledGoToTheEnabledSide) {
+  ResizeBorder border = Border(8);
+  border.top = false;
+  EXPECT_EQ(border.Classify(2, 2, 200, 100), ResizeEdge::kLeft);
+  EXPECT_EQ(border.Classify(197, 2, 200, 100), ResizeEdge::kRight);
+  EXPECT_EQ(border.Classify(100, 2, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(2, 97, 200, 100), ResizeEdge::kBottomLeft);
+
+  border = Border(8);
+  border.right = false;
+  EXPECT_EQ(border.Classify(197, 2, 200, 100), ResizeEdge::kTop);
+  EXPECT_EQ(border.Classify(197, 97, 200, 100), ResizeEdge::kBottom);
+  EXPECT_EQ(border.Classify(197, 50, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(2, 2, 200, 100), ResizeEdge::kTopLeft);
+}
+
+TEST(DisabledBorderNeverHits) {
+  EXPECT_EQ(Border(0).Classify(0, 0, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(Border(-4).Classify(0, 0, 200, 100), ResizeEdge::kNone);
+
+  ResizeBorder border = Border(8);
+  border.top = border.bottom = border.left = border.right = false;
+  EXPECT_TRUE(!border.IsEnabled());
+  EXPECT_EQ(border.Classify(0, 0, 200, 100), ResizeEdge::kNone);
+}
+
+TEST(PointsOutsideTheWindowNeverHit) {
+  ResizeBorder border = Border(8);
+  EXPECT_EQ(border.Classify(-1, 50, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(50, -1, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(200, 50, 200, 100), ResizeEdge::kNone);
+  EXPECT_EQ(border.Classify(50, 100, 200, 100), ResizeEdge::kNone);
+}
+
+TEST(BorderWiderThanHalfTheWindowPrefersTopAndLeft) {
+  ResizeBorder border = Border(60);
+  // Between 40 and 60 points are within the border of both opposite sides.
+  EXPECT_EQ(border.Classify(50, 50, 100, 100), ResizeEdge::kTopLeft);
+  EXPECT_EQ(border.Classify(50, 70, 100, 100), ResizeEdge::kBottomLeft);
+  EXPECT_EQ(border.Classify(70, 50, 100, 100), ResizeEdge::kTopRight);
+  EXPECT_EQ(border.Classify(70, 70, 100, 100), ResizeEdge::kBottomRight);
+
+  border.top = false;
+  border.left = false;
+  EXPECT_EQ(border.Classify(50, 50, 100, 100), ResizeEdge::kBottomRight);
+  EXPECT_EQ(border.Classify(10, 10, 100, 100), ResizeEdge::kNone);
+}
+
+TEST_MAIN()
@@ -0,0 +1,76 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_TEST_TEST_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_TEST_TEST_H_
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// A minimal test harness for the dependency-free headers of common/, so
+// that they build and run with any C++17 compiler, without the Flutter
+// engine. Each test file defines TEST()s and is its own executable.
+
+namespace window_manager_plus_v2 {
+namespace test {
+
+struct TestCase {
+  const char* name;
+  std::function<void()> body;
+};
+
+inline std::vector<TestCase>& TestCases() {
+  static std::vector<TestCase> test_cases;
+  return test_cases;
+}
+
+inline int& FailureCount() {
+  static int failure_count = 0;
+  return failure_count;
+}
+
+struct TestRegistration {
+  TestRegistration(const char* name, std::function<void()> body) {
+    TestCases().push_back({name, std::move(body)});
+  }
+};
+
+}  // namespace test
+}  // namespace window_manager_plus_v2
+
+#define TEST(name)                                                     \
+  static void name();                                                  \
+  static ::window_manager_plus_v2::test::TestRegistration name##_reg_( \
+      #name, name);                                                    \
+  static void name()
+
+#define EXPECT_TRUE(condition)                                        \
+  do {                                                                \
+    if (!(condition)) {                                               \
+      std::fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, \
+                   #condition);                                       \
+      ::window_manager_plus_v2::test::FailureCount()++;               \
+    }                                                                 \
+  } while (false)
+
+#define EXPECT_EQ(a, b) EXPECT_TRUE((a) == (b))
+#define EXPECT_NEAR(a, b, tolerance) \
+  EXPECT_TRUE(std::fabs((a) - (b)) <= (tolerance))
+
+#define TEST_MAIN()                                                    \
+  int main() {                                                         \
+    for (const auto& test_case :                                       \
+         ::window_manager_plus_v2::test::TestCases()) {                \
+      int failures = ::window_manager_plus_v2::test::FailureCount();   \
+      test_case.body();                                                \
+      std::printf("%s %s\n",                                           \
+                  failures == ::window_manager_plus_v2::test::         \
+                                  FailureCount()                       \
+                      ? "[  OK  ]"                                     \
+                      : "[FAILED]",                                    \
+                  test_case.name);                                     \
+    }                                                                  \
+    return ::window_manager_plus_v2::test::FailureCount() == 0 ? 0 : 1; \
+  }
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_TEST_TEST_H_
@@ -0,0 +1,131 @@
+#include "tiling.h"
+
+#include "test.h"
+
+using window_manager_plus_v2::ParseTilingMode;
+using window_manager_plus_v2::Rect;
+using window_manager_plus_v2::SolveTiling;
+using window_manager_plus_v2::TileConstraints;
+using window_manager_plus_v2::TilingMode;
+using window_manager_plus_v2::TilingOptions;
+
+static bool RectEq(const Rect& a, const Rect& b) {
+  return std::fabs(a.x - b.x) < 1e-9 && std::fabs(a.y - b.y) < 1e-9 &&
+         std::fabs(a.width - b.width) < 1e-9 &&
+         std::fabs(a.height - b.height) < 1e-9;
+}
+
+static const Rect kArea = {0, 0, 1200, 900};
+
+static TilingOptions Options(TilingMode mode, double gap = 0) {
+  TilingOptions options;
+  options.mode = mode;
+  options.gap = gap;
+  return options;
+}
+
+TEST(NoWindowsNoTiles) {
+  EXPECT_TRUE(SolveTiling(kArea, {}, Options(TilingMode::kGrid)).empty());
+}
+
+TEST(GridIsNearSquareAndSpreadsTheLastRow) {
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, std::vector<TileConstraints>(5),
+                  Options(TilingMode::kGrid));
+  EXPECT_EQ(tiles.size(), 5u);
+  // 3 columns, 2 rows.
+  EXPECT_TRUE(RectEq(tiles[0], {0, 0, 400, 450}));
+  EXPECT_TRUE(RectEq(tiles[2], {800, 0, 400, 450}));
+  EXPECT_TRUE(RectEq(tiles[3], {0, 450, 600, 450}));
+  EXPECT_TRUE(RectEq(tiles[4], {600, 450, 600, 450}));
+}
+
+TEST(GridHonoursColumnsAndGap) {
+  TilingOptions options = Options(TilingMode::kGrid, 20);
+  options.columns = 2;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, std::vector<TileConstraints>(4), options);
+  // Every tile is inset by the gap from the area and from its neighbours.
+  EXPECT_TRUE(RectEq(tiles[0], {20, 20, 570, 420}));
+  EXPECT_TRUE(RectEq(tiles[1], {610, 20, 570, 420}));
+  EXPECT_TRUE(RectEq(tiles[3], {610, 460, 570, 420}));
+}
+
+TEST(ColumnsSplitTheWidth) {
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, std::vector<TileConstraints>(3),
+                  Options(TilingMode::kColumns));
+  EXPECT_TRUE(RectEq(tiles[0], {0, 0, 400, 900}));
+  EXPECT_TRUE(RectEq(tiles[1], {400, 0, 400, 900}));
+  EXPECT_TRUE(RectEq(tiles[2], {800, 0, 400, 900}));
+}
+
+TEST(MasterStackGivesTheRatioToTheFirstWindow) {
+  TilingOptions options = Options(TilingMode::kMasterStack);
+  options.master_ratio = 0.75;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, std::vector<TileConstraints>(4), options);
+  EXPECT_TRUE(RectEq(tiles[0], {0, 0, 900, 900}));
+  EXPECT_TRUE(RectEq(tiles[1], {900, 0, 300, 300}));
+  EXPECT_TRUE(RectEq(tiles[3], {900, 600, 300, 300}));
+
+  // The ratio is clamped, and a single window takes the whole area.
+  options.master_ratio = 2;
+  tiles = SolveTiling(kArea, std::vector<TileConstraints>(2), options);
+  EXPECT_TRUE(RectEq(tiles[0], {0, 0, 1080, 900}));
+  tiles = SolveTiling(kArea, std::vector<TileConstraints>(1), options);
+  EXPECT_TRUE(RectEq(tiles[0], kArea));
+}
+
+TEST(MaximumSizeIsCenteredInTheCell) {
+  std::vector<TileConstraints> windows(2);
+  windows[0].max_width = 300;
+  windows[0].max_height = 200;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, windows, Options(TilingMode::kColumns));
+  EXPECT_TRUE(RectEq(tiles[0], {150, 350, 300, 200}));
+  EXPECT_TRUE(RectEq(tiles[1], {600, 0, 600, 900}));
+}
+
+TEST(MinimumSizeOverflowsTheCell) {
+  std::vector<TileConstraints> windows(3);
+  windows[1].min_width = 500;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, windows, Options(TilingMode::kColumns));
+  EXPECT_TRUE(RectEq(tiles[1], {350, 0, 500, 900}));
+}
+
+TEST(AspectRatioShrinksTheLongerSide) {
+  std::vector<TileConstraints> windows(2);
+  windows[0].aspect_ratio = 16.0 / 9;
+  windows[1].aspect_ratio = 0.5;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, windows, Options(TilingMode::kColumns));
+  // 600 x 900 cells: the wide window loses height, the tall one width.
+  EXPECT_TRUE(RectEq(tiles[0], {0, 281.25, 600, 337.5}));
+  EXPECT_TRUE(RectEq(tiles[1], {675, 0, 450, 900}));
+}
+
+TEST(ConstraintsCombine) {
+  std::vector<TileConstraints> windows(1);
+  windows[0].max_width = 400;
+  windows[0].aspect_ratio = 2;
+  windows[0].min_height = 300;
+  std::vector<Rect> tiles =
+      SolveTiling(kArea, windows, Options(TilingMode::kGrid));
+  // 400 wide from the maximum, 200 high from the ratio, then 300 from the
+  // minimum, which wins.
+  EXPECT_TRUE(RectEq(tiles[0], {400, 300, 400, 300}));
+}
+
+TEST(ParsesModeNames) {
+  TilingMode mode = TilingMode::kGrid;
+  EXPECT_TRUE(ParseTilingMode("masterStack", &mode));
+  EXPECT_EQ(mode, TilingMode::kMasterStack);
+  EXPECT_TRUE(ParseTilingMode("columns", &mode));
+  EXPECT_EQ(mode, TilingMode::kColumns);
+  EXPECT_TRUE(!ParseTilingMode("rows", &mode));
+  EXPECT_EQ(mode, TilingMode::kColumns);
+}
+
+TEST_MAIN()
@@ -0,0 +1,98 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_THUMBNAILS_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_THUMBNAILS_H_
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "pixel_ops.h"
+
+namespace window_manager_plus_v2 {
+
+// The shortest tick of the thumbnail service, a frame at 60 Hz. Shorter
+// intervals, down to 0, would capture every window in a busy loop.
+constexpr int64_t kMinThumbnailIntervalMs = 16;
+
+// Straight-alpha RGBA preview of a window, kept between ticks of the
+// thumbnail service so that unchanged windows are not sent again.
+struct Thumbnail {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+// Downscales a premultiplied |width| x |height| capture, in BGRA when
+// |is_bgra| or RGBA otherwise, by successive SIMD halvings until it fits
+// |max_width| x |max_height|, then converts it to straight RGBA. Halving
+// before the conversion filters premultiplied pixels, which is what keeps
+// transparent edges from darkening. Returns whether |thumbnail| changed.
+inline bool UpdateThumbnail(const uint8_t* capture,
+                            size_t stride,
+                            int width,
+                            int height,
+                            bool is_bgra,
+                            int max_width,
+                            int max_height,
+                            Thumbnail* thumbnail) {
+  std::vector<uint8_t> current;
+  std::vector<uint8_t> half;
+  const uint8_t* source = capture;
+  size_t source_stride = stride;
+  while ((width > max_width || height > max_height) && width >= 2 &&
+         height >= 2) {
+    half.resize(static_cast<size_t>(width / 2) * (height / 2) * 4);
+    HalveImage(source, source_stride, width, height, half.data(),
+               static_cast<size_t>(width / 2) * 4);
+    std::swap(current, half);
+    source = current.data();
+    width /= 2;
+    height /= 2;
+    source_stride = static_cast<size_t>(width) * 4;
+  }
+  if (source == capture) {
+    // Already small enough, the rows are only repacked.
+    size_t row_size = static_cast<size_t>(width) * 4;
+    current.resize(row_size * height);
+    for (int y = 0; y < height; y++) {
+      std::memcpy(current.data() + row_size * y, capture + stride * y,
+                  row_size);
+    }
+  }
+
+  size_t count = static_cast<size_t>(width) * height;
+  if (is_bgra) {
+    SwapRedBlue(current.data(), current.data(), count);
+  }
+  Unpremultiply(current.data(), count);
+  if (thumbnail->width == width && thumbnail->height == height &&
+      thumbnail->pixels == current) {
+    return false;
+  }
+  thumbnail->width = width;
+  thumbnail->height = height;
+  thumbnail->pixels = std::move(current);
+  return true;
+}
+
+// The thumbnails refreshed by a tick, packed into a single buffer so that
+// they all cross the method channel in one message. |index| holds the
+// window id, width, height and byte offset of each of them.
+struct ThumbnailBatch {
+  std::vector<uint8_t> pixels;
+  std::vector<int64_t> index;
+
+  void Add(int64_t window_id, const Thumbnail& thumbnail) {
+    index.insert(index.end(),
+                 {window_id, thumbnail.width, thumbnail.height,
+                  static_cast<int64_t>(pixels.size())});
+    pixels.insert(pixels.end(), thumbnail.pixels.begin(),
+                  thumbnail.pixels.end());
+  }
+
+  bool IsEmpty() const { return index.empty(); }
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_THUMBNAILS_H_
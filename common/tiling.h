@@ -0,0 +1,167 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_TILING_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_TILING_H_
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "rect.h"
+
+namespace window_manager_plus_v2 {
+
+enum class TilingMode {
+  // Rows of equal cells; the last row spreads its windows over the width.
+  kGrid,
+  // One column per window.
+  kColumns,
+  // The first window fills the left part, the others are stacked on the
+  // right.
+  kMasterStack,
+};
+
+inline bool ParseTilingMode(const std::string& name, TilingMode* mode) {
+  if (name == "grid") {
+    *mode = TilingMode::kGrid;
+  } else if (name == "columns") {
+    *mode = TilingMode::kColumns;
+  } else if (name == "masterStack") {
+    *mode = TilingMode::kMasterStack;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+struct TilingOptions {
+  TilingMode mode = TilingMode::kGrid;
+  // Space between the tiles and around them.
+  double gap = 0;
+  // Share of the width given to the master window in kMasterStack.
+  double master_ratio = 0.5;
+  // Number of columns in kGrid, 0 picks a near-square grid.
+  int columns = 0;
+};
+
+// Size constraints of a window; a maximum of 0 or less means unbounded and
+// an aspect ratio (width / height) of 0 or less means free.
+struct TileConstraints {
+  double min_width = 0;
+  double min_height = 0;
+  double max_width = 0;
+  double max_height = 0;
+  double aspect_ratio = 0;
+};
+
+namespace internal {
+
+inline void SplitRow(const Rect& row, size_t count, std::vector<Rect>* cells) {
+  double width = row.width / count;
+  for (size_t i = 0; i < count; i++) {
+    cells->push_back({row.x + width * i, row.y, width, row.height});
+  }
+}
+
+inline void SplitColumn(const Rect& column,
+                        size_t count,
+                        std::vector<Rect>* cells) {
+  double height = column.height / count;
+  for (size_t i = 0; i < count; i++) {
+    cells->push_back({column.x, column.y + height * i, column.width, height});
+  }
+}
+
+// Largest rect honouring |constraints| that fits in |cell|, centered in it.
+// Minimum sizes win over the cell, so a window may overflow a cell that is
+// too small for it.
+inline Rect FitInCell(const Rect& cell, const TileConstraints& constraints) {
+  double width = cell.width;
+  double height = cell.height;
+  if (constraints.max_width > 0) {
+    width = std::min(width, constraints.max_width);
+  }
+  if (constraints.max_height > 0) {
+    height = std::min(height, constraints.max_height);
+  }
+  if (constraints.aspect_ratio > 0) {
+    if (width / height > constraints.aspect_ratio) {
+      width = height * constraints.aspect_ratio;
+    } else {
+      height = width / constraints.aspect_ratio;
+    }
+  }
+  width = std::max(width, constraints.min_width);
+  height = std::max(height, constraints.min_height);
+  return {cell.x + (cell.width - width) / 2,
+          cell.y + (cell.height - height) / 2, width, height};
+}
+
+}  // namespace internal
+
+// Computes one tile per entry of |windows|, in order, inside |area|. Linear
+// in the number of windows and allocation-free besides the result.
+inline std::vector<Rect> SolveTiling(
+    const Rect& area,
+    const std::vector<TileConstraints>& windows,
+    const TilingOptions& options) {
+  std::vector<Rect> cells;
+  size_t count = windows.size();
+  if (count == 0) {
+    return cells;
+  }
+  cells.reserve(count);
+
+  double gap = std::max(0.0, options.gap);
+  // Every cell is inset by half a gap below, so the outer margin only needs
+  // the other half.
+  Rect inner = {area.x + gap / 2, area.y + gap / 2,
+                std::max(0.0, area.width - gap),
+                std::max(0.0, area.height - gap)};
+
+  switch (options.mode) {
+    case TilingMode::kColumns:
+      internal::SplitRow(inner, count, &cells);
+      break;
+    case TilingMode::kMasterStack: {
+      if (count == 1) {
+        cells.push_back(inner);
+        break;
+      }
+      double ratio = std::clamp(options.master_ratio, 0.1, 0.9);
+      double master_width = inner.width * ratio;
+      cells.push_back({inner.x, inner.y, master_width, inner.height});
+      internal::SplitColumn({inner.x + master_width, inner.y,
+                             inner.width - master_width, inner.height},
+                            count - 1, &cells);
+      break;
+    }
+    case TilingMode::kGrid: {
+      size_t columns =
+          options.columns > 0
+              ? static_cast<size_t>(options.columns)
+              : static_cast<size_t>(std::ceil(std::sqrt(double(count))));
+      columns = std::min(columns, count);
+      size_t rows = (count + columns - 1) / columns;
+      double row_height = inner.height / rows;
+      for (size_t row = 0; row < rows; row++) {
+        size_t in_row = std::min(columns, count - row * columns);
+        internal::SplitRow(
+            {inner.x, inner.y + row_height * row, inner.width, row_height},
+            in_row, &cells);
+      }
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    Rect cell = {cells[i].x + gap / 2, cells[i].y + gap / 2,
+                 std::max(0.0, cells[i].width - gap),
+                 std::max(0.0, cells[i].height - gap)};
+    cells[i] = internal::FitInCell(cell, windows[i]);
+  }
+  return cells;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_TILING_H_
@@ -0,0 +1,84 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_EVENT_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_EVENT_H_
+
+#include <cstdint>
+
+namespace window_manager_plus_v2 {
+
+// The events sent to Dart, as their integer code rather than their name.
+// Mirrored by WindowEvent in lib/src/window_event.dart, keep both in the
+// same order.
+enum class WindowEvent : int32_t {
+  kInitialized = 0,
+  kClose,
+  kFocus,
+  kBlur,
+  kShow,
+  kHide,
+  kMaximize,
+  kUnmaximize,
+  kMinimize,
+  kRestore,
+  kResize,
+  kResized,
+  kMove,
+  kMoved,
+  kEnterFullScreen,
+  kLeaveFullScreen,
+  kFirstFrame,
+  kDisplaysChanged,
+  kDocked,
+  kUndocked,
+};
+
+// The name Dart passes to onWindowEvent, and that event policies are set
+// for.
+inline const char* WindowEventName(WindowEvent event) {
+  switch (event) {
+    case WindowEvent::kInitialized:
+      return "initialized";
+    case WindowEvent::kClose:
+      return "close";
+    case WindowEvent::kFocus:
+      return "focus";
+    case WindowEvent::kBlur:
+      return "blur";
+    case WindowEvent::kShow:
+      return "show";
+    case WindowEvent::kHide:
+      return "hide";
+    case WindowEvent::kMaximize:
+      return "maximize";
+    case WindowEvent::kUnmaximize:
+      return "unmaximize";
+    case WindowEvent::kMinimize:
+      return "minimize";
+    case WindowEvent::kRestore:
+      return "restore";
+    case WindowEvent::kResize:
+      return "resize";
+    case WindowEvent::kResized:
+      return "resized";
+    case WindowEvent::kMove:
+      return "move";
+    case WindowEvent::kMoved:
+      return "moved";
+    case WindowEvent::kEnterFullScreen:
+      return "enter-full-screen";
+    case WindowEvent::kLeaveFullScreen:
+      return "leave-full-screen";
+    case WindowEvent::kFirstFrame:
+      return "first-frame";
+    case WindowEvent::kDisplaysChanged:
+      return "displays-changed";
+    case WindowEvent::kDocked:
+      return "docked";
+    case WindowEvent::kUndocked:
+      return "undocked";
+  }
+  return "";
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_EVENT_H_
@@ -0,0 +1,188 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_GEOMETRY_STORE_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_GEOMETRY_STORE_H_
+
+#include <iomanip>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace window_manager_plus_v2 {
+
+// The persisted geometry of a window. Bounds are the window's normal (not
+// maximized, not full-screen) bounds in the platform's native units.
+struct WindowGeometry {
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+  bool maximized = false;
+  bool full_screen = false;
+  // Only meaningful for layouts, a single window's geometry does not restore
+  // them.
+  bool visible = true;
+  bool always_on_top = false;
+  // Platform identifier of the monitor the window was on.
+  std::string monitor;
+
+  bool operator==(const WindowGeometry& other) const {
+    return x == other.x && y == other.y && width == other.width &&
+           height == other.height && maximized == other.maximized &&
+           full_screen == other.full_screen && visible == other.visible &&
+           always_on_top == other.always_on_top && monitor == other.monitor;
+  }
+  bool operator!=(const WindowGeometry& other) const {
+    return !(*this == other);
+  }
+};
+
+// In-memory form of the geometry file: one INI-style section per window key.
+//
+//   [main]
+//   x=100
+//   y=80
+//   width=1280
+//   height=720
+//   maximized=0
+//   fullScreen=0
+//   visible=1
+//   alwaysOnTop=0
+//   monitor=DP-1|U2720Q|0,0,2560x1440
+//
+// Reading and writing the file itself is left to the platform, which is
+// expected to replace it atomically.
+class WindowGeometryStore {
+ public:
+  void Parse(const std::string& contents) {
+    entries_.clear();
+    std::istringstream stream(contents);
+    std::string line;
+    WindowGeometry* current = nullptr;
+    while (std::getline(stream, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (line.empty() || line[0] == '#' || line[0] == ';') {
+        continue;
+      }
+      if (line.front() == '[' && line.back() == ']') {
+        current = &entries_[line.substr(1, line.size() - 2)];
+        continue;
+      }
+      size_t separator = line.find('=');
+      if (current == nullptr || separator == std::string::npos) {
+        continue;
+      }
+      std::string name = line.substr(0, separator);
+      std::string value = line.substr(separator + 1);
+      if (name == "x") {
+        current->x = ParseDouble(value);
+      } else if (name == "y") {
+        current->y = ParseDouble(value);
+      } else if (name == "width") {
+        current->width = ParseDouble(value);
+      } else if (name == "height") {
+        current->height = ParseDouble(value);
+      } else if (name == "maximized") {
+        current->maximized = value == "1";
+      } else if (name == "fullScreen") {
+        current->full_screen = value == "1";
+      } else if (name == "visible") {
+        current->visible = value == "1";
+      } else if (name == "alwaysOnTop") {
+        current->always_on_top = value == "1";
+      } else if (name == "monitor") {
+        current->monitor = value;
+      }
+    }
+  }
+
+  std::string Serialize() const {
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << std::setprecision(10);
+    for (const auto& [key, geometry] : entries_) {
+      stream << '[' << key << "]\n"
+             << "x=" << geometry.x << '\n'
+             << "y=" << geometry.y << '\n'
+             << "width=" << geometry.width << '\n'
+             << "height=" << geometry.height << '\n'
+             << "maximized=" << (geometry.maximized ? 1 : 0) << '\n'
+             << "fullScreen=" << (geometry.full_screen ? 1 : 0) << '\n'
+             << "visible=" << (geometry.visible ? 1 : 0) << '\n'
+             << "alwaysOnTop=" << (geometry.always_on_top ? 1 : 0) << '\n'
+             << "monitor=" << geometry.monitor << "\n\n";
+    }
+    return stream.str();
+  }
+
+  const WindowGeometry* Find(const std::string& key) const {
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : &it->second;
+  }
+
+  // Returns whether the stored geometry changed, so that callers can skip
+  // rewriting the file when nothing moved.
+  bool Set(const std::string& key, const WindowGeometry& geometry) {
+    if (!IsValidKey(key)) {
+      return false;
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second == geometry) {
+      return false;
+    }
+    entries_[key] = geometry;
+    return true;
+  }
+
+  // Entries whose key starts with |prefix|, in key order.
+  std::vector<std::pair<std::string, WindowGeometry>> FindByPrefix(
+      const std::string& prefix) const {
+    std::vector<std::pair<std::string, WindowGeometry>> result;
+    for (auto it = entries_.lower_bound(prefix);
+         it != entries_.end() && HasPrefix(it->first, prefix); ++it) {
+      result.push_back(*it);
+    }
+    return result;
+  }
+
+  bool Erase(const std::string& key) { return entries_.erase(key) > 0; }
+
+  // Returns whether anything was removed.
+  bool EraseByPrefix(const std::string& prefix) {
+    auto begin = entries_.lower_bound(prefix);
+    auto end = begin;
+    while (end != entries_.end() && HasPrefix(end->first, prefix)) {
+      ++end;
+    }
+    bool is_erased = begin != end;
+    entries_.erase(begin, end);
+    return is_erased;
+  }
+
+  static bool IsValidKey(const std::string& key) {
+    return !key.empty() && key.find_first_of("[]\r\n") == std::string::npos;
+  }
+
+ private:
+  static bool HasPrefix(const std::string& key, const std::string& prefix) {
+    return key.compare(0, prefix.size(), prefix) == 0;
+  }
+
+  // Unlike strtod, not affected by the locale GTK installs with setlocale().
+  static double ParseDouble(const std::string& value) {
+    std::istringstream stream(value);
+    stream.imbue(std::locale::classic());
+    double result = 0;
+    stream >> result;
+    return result;
+  }
+
+  std::map<std::string, WindowGeometry> entries_;
+};
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_GEOMETRY_STORE_H_
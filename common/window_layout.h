@@ -0,0 +1,59 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_LAYOUT_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_LAYOUT_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "window_geometry_store.h"
+
+namespace window_manager_plus_v2 {
+
+// The geometry of every window of a named layout, keyed by window id.
+using WindowLayout = std::map<int64_t, WindowGeometry>;
+
+// Layouts share the geometry file format: each window of a layout is stored
+// in its own "<layout name>:<window id>" section.
+inline std::string GetLayoutKey(const std::string& name, int64_t window_id) {
+  return name + ':' + std::to_string(window_id);
+}
+
+inline bool IsValidLayoutName(const std::string& name) {
+  return WindowGeometryStore::IsValidKey(name);
+}
+
+inline WindowLayout FindLayout(const WindowGeometryStore& store,
+                               const std::string& name) {
+  WindowLayout layout;
+  std::string prefix = name + ':';
+  for (const auto& [key, geometry] : store.FindByPrefix(prefix)) {
+    std::string id = key.substr(prefix.size());
+    // Skips the windows of a longer layout name sharing the prefix.
+    if (id.empty() || id.size() > 18 ||
+        id.find_first_not_of("0123456789") != std::string::npos) {
+      continue;
+    }
+    layout[std::stoll(id)] = geometry;
+  }
+  return layout;
+}
+
+// Replaces the layout called |name|. Returns whether the store changed.
+inline bool SetLayout(WindowGeometryStore& store,
+                      const std::string& name,
+                      const WindowLayout& layout) {
+  if (!IsValidLayoutName(name) || FindLayout(store, name) == layout) {
+    return false;
+  }
+  for (const auto& [window_id, geometry] : FindLayout(store, name)) {
+    store.Erase(GetLayoutKey(name, window_id));
+  }
+  for (const auto& [window_id, geometry] : layout) {
+    store.Set(GetLayoutKey(name, window_id), geometry);
+  }
+  return true;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_LAYOUT_H_
@@ -0,0 +1,188 @@
+// Generated by tool/generate_protocol.py from protocol/window_manager.idl.
+// Do not edit.
+
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_MANAGER_PROTOCOL_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_MANAGER_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "protocol_codec.h"
+
+namespace window_manager_plus_v2 {
+namespace protocol {
+
+enum class Method : uint16_t {
+  kGetBounds = 0,
+  kSetBounds = 1,
+  kIsFocused = 2,
+  kIsVisible = 3,
+  kIsMaximized = 4,
+  kIsMinimized = 5,
+  kIsFullScreen = 6,
+  kGetOpacity = 7,
+  kSetOpacity = 8,
+};
+
+struct Bounds {
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+};
+
+inline bool Read(ProtocolReader* reader, Bounds* value) {
+  return Read(reader, &value->x) &&
+         Read(reader, &value->y) &&
+         Read(reader, &value->width) &&
+         Read(reader, &value->height);
+}
+
+inline void Write(ProtocolWriter* writer, const Bounds& value) {
+  Write(writer, value.x);
+  Write(writer, value.y);
+  Write(writer, value.width);
+  Write(writer, value.height);
+}
+
+// Implemented by the plugin, called with the arguments of a call once
+// decoded.
+class WindowManagerApi {
+ public:
+  virtual ~WindowManagerApi() = default;
+
+  virtual Bounds GetBounds(double device_pixel_ratio) = 0;
+  virtual void SetBounds(const std::optional<double>& x,
+                         const std::optional<double>& y,
+                         const std::optional<double>& width,
+                         const std::optional<double>& height,
+                         double device_pixel_ratio) = 0;
+  virtual bool IsFocused() = 0;
+  virtual bool IsVisible() = 0;
+  virtual bool IsMaximized() = 0;
+  virtual bool IsMinimized() = 0;
+  virtual bool IsFullScreen() = 0;
+  virtual double GetOpacity() = 0;
+  virtual void SetOpacity(double opacity) = 0;
+};
+
+// Decodes the call in |message|, calls it on the api of its target window,
+// and returns the reply to send back.
+inline std::vector<uint8_t> HandleCall(
+    const std::function<WindowManagerApi*(int64_t)>& api_for_window,
+    const uint8_t* message,
+    size_t size) {
+  ProtocolReader reader(message, size);
+  uint16_t method;
+  int64_t window_id;
+  if (!Read(&reader, &method) || !Read(&reader, &window_id)) {
+    return EncodeErrorReply("bad-message", "Truncated call");
+  }
+  WindowManagerApi* api = api_for_window(window_id);
+  if (api == nullptr) {
+    return EncodeErrorReply("no-window",
+                            "No window " + std::to_string(window_id));
+  }
+  ProtocolWriter writer;
+  switch (static_cast<Method>(method)) {
+    case Method::kGetBounds: {
+      double device_pixel_ratio = 0;
+      if (!Read(&reader, &device_pixel_ratio) || !reader.AtEnd()) {
+        break;
+      }
+      Bounds result = api->GetBounds(device_pixel_ratio);
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kSetBounds: {
+      std::optional<double> x;
+      std::optional<double> y;
+      std::optional<double> width;
+      std::optional<double> height;
+      double device_pixel_ratio = 0;
+      if (!Read(&reader, &x) || !Read(&reader, &y) || !Read(&reader, &width) ||
+          !Read(&reader, &height) || !Read(&reader, &device_pixel_ratio) ||
+          !reader.AtEnd()) {
+        break;
+      }
+      api->SetBounds(x, y, width, height, device_pixel_ratio);
+      Write(&writer, kReplyOk);
+      return writer.Take();
+    }
+    case Method::kIsFocused: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      bool result = api->IsFocused();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kIsVisible: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      bool result = api->IsVisible();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kIsMaximized: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      bool result = api->IsMaximized();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kIsMinimized: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      bool result = api->IsMinimized();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kIsFullScreen: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      bool result = api->IsFullScreen();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kGetOpacity: {
+      if (!reader.AtEnd()) {
+        break;
+      }
+      double result = api->GetOpacity();
+      Write(&writer, kReplyOk);
+      Write(&writer, result);
+      return writer.Take();
+    }
+    case Method::kSetOpacity: {
+      double opacity = 0;
+      if (!Read(&reader, &opacity) || !reader.AtEnd()) {
+        break;
+      }
+      api->SetOpacity(opacity);
+      Write(&writer, kReplyOk);
+      return writer.Take();
+    }
+  }
+  return EncodeErrorReply("bad-message",
+                          "Malformed call of method " + std::to_string(method));
+}
+
+}  // namespace protocol
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_MANAGER_PROTOCOL_H_
@@ -0,0 +1,147 @@
+#ifndef WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_SNAPSHOT_H_
+#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace window_manager_plus_v2 {
+
+// Bits of WindowSnapshot::flags, the same as those of the snapshot struct
+// of the plugin headers.
+constexpr uint32_t kSnapshotPublished = 1 << 0;
+constexpr uint32_t kSnapshotFocused = 1 << 1;
+constexpr uint32_t kSnapshotVisible = 1 << 2;
+constexpr uint32_t kSnapshotMaximized = 1 << 3;
+constexpr uint32_t kSnapshotMinimized = 1 << 4;
+constexpr uint32_t kSnapshotFullScreen = 1 << 5;
+
+// The state of a window that Dart reads synchronously through dart:ffi,
+// laid out like the snapshot struct of the plugin headers.
+struct WindowSnapshot {
+  // Bounds of the window in logical pixels.
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+  // Physical pixels per logical pixel.
+  double scale_factor = 1;
+  uint32_t flags = 0;
+};
+
+// The last published snapshot of every window of the process.
+//
+// Thread safety: Publish and Remove are only called from the platform
+// thread, which owns the windows, so there is a single writer and it never
+// waits. Read may be called from any thread, including the Dart UI thread
+// through dart:ffi. It never blocks nor allocates, it retries the few loads
+// of a slot while the platform thread is writing it (a seqlock), so it
+// returns a snapshot that was published as a whole, never a mix of two.
+// A snapshot is only as recent as the last event handled by the platform
+// thread, e.g. a getter that follows setBounds may still see the previous
+// bounds until the window manager applied them.
+class WindowSnapshotRegistry {
+ public:
+  // More windows than this are not published, Read fails for them.
+  static constexpr size_t kCapacity = 64;
+
+  void Publish(int64_t window_id, const WindowSnapshot& snapshot) {
+    Slot* slot = Find(window_id);
+    if (slot == nullptr) {
+      slot = Find(-1);
+    }
+    if (slot != nullptr) {
+      Write(slot, window_id, snapshot);
+    }
+  }
+
+  void Remove(int64_t window_id) {
+    Slot* slot = Find(window_id);
+    if (slot != nullptr) {
+      Write(slot, -1, WindowSnapshot());
+    }
+  }
+
+  // Returns false when |window_id| has no snapshot.
+  bool Read(int64_t window_id, WindowSnapshot* snapshot) const {
+    for (const Slot& slot : slots_) {
+      if (slot.window_id.load(std::memory_order_relaxed) != window_id) {
+        continue;
+      }
+      while (true) {
+        uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0) {
+          continue;
+        }
+        int64_t id = slot.window_id.load(std::memory_order_relaxed);
+        snapshot->x = slot.x.load(std::memory_order_relaxed);
+        snapshot->y = slot.y.load(std::memory_order_relaxed);
+        snapshot->width = slot.width.load(std::memory_order_relaxed);
+        snapshot->height = slot.height.load(std::memory_order_relaxed);
+        snapshot->scale_factor =
+            slot.scale_factor.load(std::memory_order_relaxed);
+        snapshot->flags = slot.flags.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+          // The slot may have been given to another window meanwhile.
+          return id == window_id;
+        }
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Slot {
+    // Odd while the platform thread writes the slot.
+    std::atomic<uint32_t> sequence{0};
+    // -1 when free.
+    std::atomic<int64_t> window_id{-1};
+    std::atomic<double> x{0};
+    std::atomic<double> y{0};
+    std::atomic<double> width{0};
+    std::atomic<double> height{0};
+    std::atomic<double> scale_factor{1};
+    std::atomic<uint32_t> flags{0};
+  };
+
+  Slot* Find(int64_t window_id) {
+    for (Slot& slot : slots_) {
+      if (slot.window_id.load(std::memory_order_relaxed) == window_id) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  static void Write(Slot* slot,
+                    int64_t window_id,
+                    const WindowSnapshot& snapshot) {
+    uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->window_id.store(window_id, std::memory_order_relaxed);
+    slot->x.store(snapshot.x, std::memory_order_relaxed);
+    slot->y.store(snapshot.y, std::memory_order_relaxed);
+    slot->width.store(snapshot.width, std::memory_order_relaxed);
+    slot->height.store(snapshot.height, std::memory_order_relaxed);
+    slot->scale_factor.store(snapshot.scale_factor,
+                             std::memory_order_relaxed);
+    slot->flags.store(snapshot.flags | kSnapshotPublished,
+                      std::memory_order_relaxed);
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  Slot slots_[kCapacity];
+};
+
+// Shared by the plugin instances of every window, it lives as long as the
+// plugin library so that Read never sees a freed slot.
+inline WindowSnapshotRegistry& GetWindowSnapshotRegistry() {
+  static WindowSnapshotRegistry registry;
+  return registry;
+}
+
+}  // namespace window_manager_plus_v2
+
+#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_SNAPSHOT_H_
@@ -0,0 +1,15 @@
+import 'dart:ui';
+
+/// A global pointer position from `WindowManagerPlus.cursorPositions`.
+class CursorSample {
+  const CursorSample({
+    required this.timestamp,
+    required this.position,
+  });
+
+  /// Monotonic time of the frame the position was sampled on.
+  final Duration timestamp;
+
+  /// Position on the virtual screen, in logical pixels.
+  final Offset position;
+}
@@ -0,0 +1,47 @@
+/// What happens to the events of a name while Dart is behind on them.
+enum EventPolicy {
+  /// Every event is delivered, unless more than the queue holds pile up.
+  keepAll,
+
+  /// Only the latest pending event is delivered, e.g. for `move`.
+  latestWins,
+
+  /// The events are dropped until Dart catches up.
+  drop,
+}
+
+/// Counters of the native queue holding the events Dart hasn't caught up
+/// with yet.
+class EventQueueStats {
+  const EventQueueStats({
+    required this.depth,
+    required this.maxDepth,
+    required this.inFlight,
+    required this.sent,
+    required this.coalesced,
+    required this.dropped,
+  });
+
+  factory EventQueueStats.fromJson(Map<dynamic, dynamic> json) {
+    return EventQueueStats(
+      depth: json['depth'],
+      maxDepth: json['maxDepth'],
+      inFlight: json['inFlight'],
+      sent: json['sent'],
+      coalesced: json['coalesced'],
+      dropped: json['dropped'],
+    );
+  }
+
+  /// The events waiting in the queue.
+  final int depth;
+  final int maxDepth;
+
+  /// The events sent and not yet handled by Dart.
+  final int inFlight;
+  final int sent;
+
+  /// The events replaced by a later one under [EventPolicy.latestWins].
+  final int coalesced;
+  final int dropped;
+}
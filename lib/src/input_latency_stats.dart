@@ -0,0 +1,67 @@
+/// Latencies of one kind of input action, bucketed by powers of two: bucket
+/// `i` of [buckets] counts the latencies in `[2^i, 2^(i+1))` microseconds.
+///
+/// The percentiles are the upper bound of their bucket.
+class LatencyHistogram {
+  const LatencyHistogram({
+    required this.count,
+    required this.min,
+    required this.max,
+    required this.mean,
+    required this.p50,
+    required this.p90,
+    required this.p99,
+    required this.buckets,
+  });
+
+  factory LatencyHistogram.fromJson(Map<dynamic, dynamic> json) {
+    Duration micros(String key) => Duration(microseconds: json[key] as int);
+    return LatencyHistogram(
+      count: json['count'],
+      min: micros('minUs'),
+      max: micros('maxUs'),
+      mean: micros('meanUs'),
+      p50: micros('p50Us'),
+      p90: micros('p90Us'),
+      p99: micros('p99Us'),
+      buckets: List<int>.from(json['buckets']),
+    );
+  }
+
+  final int count;
+  final Duration min;
+  final Duration max;
+  final Duration mean;
+  final Duration p50;
+  final Duration p90;
+  final Duration p99;
+  final List<int> buckets;
+}
+
+/// How long the window takes to react to the button press that drags or
+/// resizes it, measured natively from the timestamp of the press.
+class InputLatencyStats {
+  const InputLatencyStats({
+    required this.dragStart,
+    required this.resizeStart,
+    required this.firstMove,
+  });
+
+  factory InputLatencyStats.fromJson(Map<dynamic, dynamic> json) {
+    return InputLatencyStats(
+      dragStart: LatencyHistogram.fromJson(json['dragStart']),
+      resizeStart: LatencyHistogram.fromJson(json['resizeStart']),
+      firstMove: LatencyHistogram.fromJson(json['firstMove']),
+    );
+  }
+
+  /// From the press to the start of a move drag.
+  final LatencyHistogram dragStart;
+
+  /// From the press to the start of a resize.
+  final LatencyHistogram resizeStart;
+
+  /// From the press to the first move or resize of the window after a drag
+  /// or resize started.
+  final LatencyHistogram firstMove;
+}
@@ -0,0 +1,129 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+
+const _kReplyOk = 0;
+
+/// Writes the packed values of a call, see common/protocol_codec.h.
+class ProtocolWriter {
+  /// Starts the call of the method at [methodIndex] on [windowId].
+  ProtocolWriter.call(int methodIndex, int windowId) {
+    writeUint16(methodIndex);
+    writeInt(windowId);
+  }
+
+  Uint8List _bytes = Uint8List(64);
+  late ByteData _data = ByteData.sublistView(_bytes);
+  int _length = 0;
+
+  void _reserve(int count) {
+    if (_length + count <= _bytes.length) {
+      return;
+    }
+    final bytes = Uint8List((_length + count) * 2)..setAll(0, _bytes);
+    _bytes = bytes;
+    _data = ByteData.sublistView(bytes);
+  }
+
+  void writeUint16(int value) {
+    _reserve(2);
+    _data.setUint16(_length, value, Endian.little);
+    _length += 2;
+  }
+
+  void writeBool(bool value) {
+    _reserve(1);
+    _data.setUint8(_length, value ? 1 : 0);
+    _length += 1;
+  }
+
+  void writeInt(int value) {
+    _reserve(8);
+    _data.setInt64(_length, value, Endian.little);
+    _length += 8;
+  }
+
+  void writeDouble(double value) {
+    _reserve(8);
+    _data.setFloat64(_length, value, Endian.little);
+    _length += 8;
+  }
+
+  void writeString(String value) {
+    final bytes = utf8.encode(value);
+    _reserve(4 + bytes.length);
+    _data.setUint32(_length, bytes.length, Endian.little);
+    _bytes.setAll(_length + 4, bytes);
+    _length += 4 + bytes.length;
+  }
+
+  void writeOptional<T>(T? value, void Function(T value) write) {
+    writeBool(value != null);
+    if (value != null) {
+      write(value);
+    }
+  }
+
+  ByteData done() => ByteData.sublistView(_bytes, 0, _length);
+}
+
+/// Reads the packed values of a reply, see common/protocol_codec.h.
+class ProtocolReader {
+  ProtocolReader(this._data);
+
+  final ByteData _data;
+  int _offset = 0;
+
+  int readUint8() => _data.getUint8(_offset++);
+
+  bool readBool() => readUint8() != 0;
+
+  int readInt() {
+    final value = _data.getInt64(_offset, Endian.little);
+    _offset += 8;
+    return value;
+  }
+
+  double readDouble() {
+    final value = _data.getFloat64(_offset, Endian.little);
+    _offset += 8;
+    return value;
+  }
+
+  String readString() {
+    final length = _data.getUint32(_offset, Endian.little);
+    _offset += 4;
+    final value = utf8.decode(
+      Uint8List.sublistView(_data, _offset, _offset + length),
+    );
+    _offset += length;
+    return value;
+  }
+
+  T? readOptional<T>(T Function() read) => readBool() ? read() : null;
+}
+
+/// Sends the call written by [writer] and returns the reader of its result.
+///
+/// Throws a [PlatformException] when the call failed, and a
+/// [MissingPluginException] when nothing handles [channel].
+Future<ProtocolReader> sendProtocolCall(
+  BasicMessageChannel<ByteData?> channel,
+  ProtocolWriter writer,
+) async {
+  final reply = await channel.send(writer.done());
+  if (reply == null) {
+    throw MissingPluginException(
+      'No implementation found on channel ${channel.name}',
+    );
+  }
+  final reader = ProtocolReader(reply);
+  if (reader.readUint8() != _kReplyOk) {
+    throw PlatformException(
+      code: reader.readString(),
+      message: reader.readString(),
+    );
+  }
+  return reader;
+}
@@ -0,0 +1,5 @@
+enum TilingMode {
+  grid,
+  columns,
+  masterStack,
+}
@@ -0,0 +1,21 @@
+import 'dart:ui';
+
+/// A move or resize of a window from `WindowManagerPlus.boundsEvents`.
+class WindowBoundsEvent {
+  const WindowBoundsEvent({
+    required this.eventName,
+    required this.windowId,
+    required this.timestamp,
+    required this.bounds,
+  });
+
+  /// `move`, `moved`, `resize` or `resized`.
+  final String eventName;
+  final int windowId;
+
+  /// Monotonic time of the event.
+  final Duration timestamp;
+
+  /// Bounds of the window after the event, in logical pixels.
+  final Rect bounds;
+}
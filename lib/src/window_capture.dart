@@ -0,0 +1,26 @@
+import 'dart:typed_data';
+
+/// Byte order of the pixels of a [WindowCapture].
+enum CapturePixelFormat {
+  rgba,
+  bgra,
+}
+
+/// The content of a window, as returned by `captureWindow` or kept in
+/// `WindowManagerPlus.thumbnails`.
+class WindowCapture {
+  const WindowCapture({
+    required this.width,
+    required this.height,
+    required this.bytes,
+  });
+
+  /// Width in physical pixels.
+  final int width;
+
+  /// Height in physical pixels.
+  final int height;
+
+  /// `width * height` pixels of 4 bytes, row after row.
+  final Uint8List bytes;
+}
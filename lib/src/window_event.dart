@@ -0,0 +1,41 @@
+/// The events of a window, sent by the native plugins as their [index]
+/// instead of their name. Mirrors `common/window_event.h`, keep both in the
+/// same order.
+enum WindowEvent {
+  initialized('initialized'),
+  close('close'),
+  focus('focus'),
+  blur('blur'),
+  show('show'),
+  hide('hide'),
+  maximize('maximize'),
+  unmaximize('unmaximize'),
+  minimize('minimize'),
+  restore('restore'),
+  resize('resize'),
+  resized('resized'),
+  move('move'),
+  moved('moved'),
+  enterFullScreen('enter-full-screen'),
+  leaveFullScreen('leave-full-screen'),
+  firstFrame('first-frame'),
+  displaysChanged('displays-changed'),
+  docked('docked'),
+  undocked('undocked');
+
+  const WindowEvent(this.eventName);
+
+  /// The name passed to [WindowListener.onWindowEvent].
+  final String eventName;
+
+  /// The event with the native code [code], if any.
+  static WindowEvent? fromCode(int code) =>
+      code >= 0 && code < values.length ? values[code] : null;
+
+  /// The event named [eventName], for the plugins that still send names.
+  static WindowEvent? fromName(String eventName) => _byName[eventName];
+
+  static final Map<String, WindowEvent> _byName = {
+    for (final WindowEvent event in values) event.eventName: event,
+  };
+}
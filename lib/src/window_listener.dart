@@ -1,3 +1,4 @@
+import 'package:window_manager_plus_v2/src/window_event.dart';
 import 'package:window_manager_plus_v2/src/window_manager.dart';
 
 /// The `WindowListener` mixin class is used to listen to window events.
@@ -52,6 +53,20 @@ abstract mixin class WindowListener {
   /// Emitted when the window leaves a full-screen state.
   void onWindowLeaveFullScreen([int? windowId]) {}
 
+  /// Emitted once when the Flutter view has rendered its first frame.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  void onWindowFirstFrame([int? windowId]) {}
+
+  /// Emitted when a display is added, removed or changes its geometry, work
+  /// area or scale factor.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  void onWindowDisplaysChanged([int? windowId]) {}
+
   /// Emitted when the window entered a docked state.
   ///
   /// **Supported Platforms**:
@@ -64,7 +79,8 @@ abstract mixin class WindowListener {
   /// - Windows
   void onWindowUndocked([int? windowId]) {}
 
-  /// Emitted all events.
+  /// Emitted all events, [eventName] being the [WindowEvent.eventName] of
+  /// the event.
   void onWindowEvent(String eventName, [int? windowId]) {}
 
   /// Event from other windows.
@@ -1,16 +1,27 @@
 import 'dart:async';
 import 'dart:io';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import 'package:path/path.dart' as path;
+import 'package:screen_retriever/screen_retriever.dart';
+import 'package:window_manager_plus_v2/src/cursor_sample.dart';
+import 'package:window_manager_plus_v2/src/event_queue_stats.dart';
+import 'package:window_manager_plus_v2/src/input_latency_stats.dart';
 import 'package:window_manager_plus_v2/src/resize_edge.dart';
+import 'package:window_manager_plus_v2/src/tiling_mode.dart';
 import 'package:window_manager_plus_v2/src/title_bar_style.dart';
 import 'package:window_manager_plus_v2/src/utils/calc_window_position.dart';
+import 'package:window_manager_plus_v2/src/window_bounds_event.dart';
+import 'package:window_manager_plus_v2/src/window_capture.dart';
+import 'package:window_manager_plus_v2/src/window_event.dart';
 import 'package:window_manager_plus_v2/src/window_listener.dart';
+import 'package:window_manager_plus_v2/src/window_manager_protocol.dart';
 import 'package:window_manager_plus_v2/src/window_options.dart';
+import 'package:window_manager_plus_v2/src/window_snapshot.dart';
 
 const kWindowEventInitialized = 'initialized';
 const kWindowEventClose = 'close';
@@ -26,6 +37,8 @@ const kWindowEventMove = 'move';
 const kWindowEventMoved = 'moved';
 const kWindowEventEnterFullScreen = 'enter-full-screen';
 const kWindowEventLeaveFullScreen = 'leave-full-screen';
+const kWindowEventFirstFrame = 'first-frame';
+const kWindowEventDisplaysChanged = 'displays-changed';
 const kEventFromWindow = 'event-from-window';
 
 const kWindowEventDocked = 'docked';
@@ -37,15 +50,34 @@ enum DockSide { left, right }
 class WindowManagerPlus {
   WindowManagerPlus._(int id)
       : _id = id,
-        _channel = MethodChannel('window_manager_plus_v2_$id') {
+        _channel = MethodChannel('window_manager_plus_v2_$id'),
+        _protocol = WindowManagerProtocol(
+          'window_manager_plus_v2_protocol_$id',
+          id,
+        ) {
     _channel.setMethodCallHandler(_methodCallHandler);
+    BasicMessageChannel<ByteData?>(
+      'window_manager_plus_v2_events_$id',
+      const BinaryCodec(),
+    ).setMessageHandler(_eventRecordHandler);
   }
 
   WindowManagerPlus._fromWindowId(int id)
       : _id = id,
-        _channel = _current!._channel {}
+        _channel = _current!._channel,
+        _protocol = WindowManagerProtocol(
+          'window_manager_plus_v2_protocol_${_current!._id}',
+          id,
+        ) {}
 
   final MethodChannel _channel;
+
+  /// The calls of protocol/window_manager.idl, with packed arguments
+  /// instead of a map. Only the Linux and Windows plugins implement it.
+  final WindowManagerProtocol _protocol;
+
+  static bool get _hasProtocol => Platform.isLinux || Platform.isWindows;
+
   static const MethodChannel _staticChannel =
       MethodChannel('window_manager_plus_v2_static');
 
@@ -67,20 +99,132 @@ class WindowManagerPlus {
 
   static final Map<int, Completer> _completers = {};
 
+  // Layout of the event records, see common/event_record.h.
+  static const int _kEventRecordSize = 56;
+  static const int _kEventRecordGlobal = 1;
+
+  /// Moves and resizes arrive as fixed-size records on their own channel,
+  /// read in place rather than decoded into a map.
+  Future<ByteData?> _eventRecordHandler(ByteData? record) async {
+    if (record == null || record.lengthInBytes < _kEventRecordSize) {
+      return null;
+    }
+    final WindowEvent? event =
+        WindowEvent.fromCode(record.getInt32(0, Endian.host));
+    if (event == null) return null;
+    final bool isGlobal =
+        (record.getUint32(4, Endian.host) & _kEventRecordGlobal) != 0;
+    final int windowId = record.getInt64(8, Endian.host);
+
+    if (isGlobal) {
+      for (final WindowListener listener in globalListeners) {
+        if (!_globalListeners.contains(listener)) {
+          break;
+        }
+        _dispatchWindowEvent(listener, event, windowId);
+      }
+    } else {
+      for (final WindowListener listener in listeners) {
+        if (!_listeners.contains(listener)) {
+          break;
+        }
+        _dispatchWindowEvent(listener, event, null);
+      }
+    }
+
+    if (!isGlobal && _boundsController.hasListener) {
+      _boundsController.add(WindowBoundsEvent(
+        eventName: event.eventName,
+        windowId: windowId,
+        timestamp: Duration(microseconds: record.getInt64(16, Endian.host)),
+        bounds: Rect.fromLTWH(
+          record.getFloat64(24, Endian.host),
+          record.getFloat64(32, Endian.host),
+          record.getFloat64(40, Endian.host),
+          record.getFloat64(48, Endian.host),
+        ),
+      ));
+    }
+    return null;
+  }
+
+  /// Calls [WindowListener.onWindowEvent] and the callback of [event], with
+  /// [windowId] for global listeners.
+  static void _dispatchWindowEvent(
+    WindowListener listener,
+    WindowEvent event,
+    int? windowId,
+  ) {
+    listener.onWindowEvent(event.eventName, windowId);
+    switch (event) {
+      case WindowEvent.close:
+        listener.onWindowClose(windowId);
+      case WindowEvent.focus:
+        listener.onWindowFocus(windowId);
+      case WindowEvent.blur:
+        listener.onWindowBlur(windowId);
+      case WindowEvent.maximize:
+        listener.onWindowMaximize(windowId);
+      case WindowEvent.unmaximize:
+        listener.onWindowUnmaximize(windowId);
+      case WindowEvent.minimize:
+        listener.onWindowMinimize(windowId);
+      case WindowEvent.restore:
+        listener.onWindowRestore(windowId);
+      case WindowEvent.resize:
+        listener.onWindowResize(windowId);
+      case WindowEvent.resized:
+        listener.onWindowResized(windowId);
+      case WindowEvent.move:
+        listener.onWindowMove(windowId);
+      case WindowEvent.moved:
+        listener.onWindowMoved(windowId);
+      case WindowEvent.enterFullScreen:
+        listener.onWindowEnterFullScreen(windowId);
+      case WindowEvent.leaveFullScreen:
+        listener.onWindowLeaveFullScreen(windowId);
+      case WindowEvent.firstFrame:
+        listener.onWindowFirstFrame(windowId);
+      case WindowEvent.displaysChanged:
+        listener.onWindowDisplaysChanged(windowId);
+      case WindowEvent.docked:
+        listener.onWindowDocked(windowId);
+      case WindowEvent.undocked:
+        listener.onWindowUndocked(windowId);
+      case WindowEvent.initialized:
+      case WindowEvent.show:
+      case WindowEvent.hide:
+        break;
+    }
+  }
+
   Future<dynamic> _methodCallHandler(MethodCall call) async {
+    if (call.method == 'onThumbnails') {
+      _updateThumbnails(call.arguments);
+      return;
+    }
+    if (call.method == 'onCursorSamples') {
+      final List<double> samples = call.arguments;
+      for (int i = 0; i + 2 < samples.length; i += 3) {
+        _cursorController.add(CursorSample(
+          timestamp: Duration(microseconds: samples[i].toInt()),
+          position: Offset(samples[i + 1], samples[i + 2]),
+        ));
+      }
+      return;
+    }
     if (call.method != 'onEvent') throw UnimplementedError();
 
-    String eventName = call.arguments['eventName'];
+    // Events from Linux and Windows carry their code, those from macOS and
+    // from other windows their name.
+    final int? code = call.arguments['event'];
+    final WindowEvent? event = code != null
+        ? WindowEvent.fromCode(code)
+        : WindowEvent.fromName(call.arguments['eventName']);
     int? windowId = call.arguments['windowId'];
 
     if (windowId != null) {
-      if (eventName == kWindowEventInitialized) {
-        if (_completers[windowId] != null &&
-            !_completers[windowId]!.isCompleted) {
-          _completers[windowId]?.complete();
-        }
-        _completers.remove(windowId);
-      } else if (eventName == kWindowEventClose) {
+      if (event == WindowEvent.initialized || event == WindowEvent.close) {
         if (_completers[windowId] != null &&
             !_completers[windowId]!.isCompleted) {
           _completers[windowId]?.complete();
@@ -88,76 +232,34 @@ class WindowManagerPlus {
         _completers.remove(windowId);
       }
 
-      for (final WindowListener listener in globalListeners) {
-        if (!_globalListeners.contains(listener)) {
-          break;
+      if (event != null) {
+        for (final WindowListener listener in globalListeners) {
+          if (!_globalListeners.contains(listener)) {
+            break;
+          }
+          _dispatchWindowEvent(listener, event, windowId);
         }
-
-        listener.onWindowEvent(eventName, windowId);
-        Map<String, Function> funcMap = {
-          kWindowEventClose: listener.onWindowClose,
-          kWindowEventFocus: listener.onWindowFocus,
-          kWindowEventBlur: listener.onWindowBlur,
-          kWindowEventMaximize: listener.onWindowMaximize,
-          kWindowEventUnmaximize: listener.onWindowUnmaximize,
-          kWindowEventMinimize: listener.onWindowMinimize,
-          kWindowEventRestore: listener.onWindowRestore,
-          kWindowEventResize: listener.onWindowResize,
-          kWindowEventResized: listener.onWindowResized,
-          kWindowEventMove: listener.onWindowMove,
-          kWindowEventMoved: listener.onWindowMoved,
-          kWindowEventEnterFullScreen: listener.onWindowEnterFullScreen,
-          kWindowEventLeaveFullScreen: listener.onWindowLeaveFullScreen,
-          kWindowEventDocked: listener.onWindowDocked,
-          kWindowEventUndocked: listener.onWindowUndocked,
-        };
-        funcMap[eventName]?.call(windowId);
       }
 
       if (_current != null && _id != _current!.id) {
-        for (final WindowListener listener in listeners) {
-          if (!_listeners.contains(listener)) {
-            break;
-          }
-
-          if (eventName == kEventFromWindow) {
-            String method = call.arguments['method'];
-            int fromWindowId = call.arguments['fromWindowId'];
-            dynamic eventArguments = call.arguments['arguments'];
-            try {
-              return await listener.onEventFromWindow(
-                  method, fromWindowId, eventArguments);
-            } catch (_) {}
-          }
-
-          listener.onWindowEvent(eventName);
-          Map<String, Function> funcMap = {
-            kWindowEventClose: listener.onWindowClose,
-            kWindowEventFocus: listener.onWindowFocus,
-            kWindowEventBlur: listener.onWindowBlur,
-            kWindowEventMaximize: listener.onWindowMaximize,
-            kWindowEventUnmaximize: listener.onWindowUnmaximize,
-            kWindowEventMinimize: listener.onWindowMinimize,
-            kWindowEventRestore: listener.onWindowRestore,
-            kWindowEventResize: listener.onWindowResize,
-            kWindowEventResized: listener.onWindowResized,
-            kWindowEventMove: listener.onWindowMove,
-            kWindowEventMoved: listener.onWindowMoved,
-            kWindowEventEnterFullScreen: listener.onWindowEnterFullScreen,
-            kWindowEventLeaveFullScreen: listener.onWindowLeaveFullScreen,
-            kWindowEventDocked: listener.onWindowDocked,
-            kWindowEventUndocked: listener.onWindowUndocked,
-          };
-          funcMap[eventName]?.call();
-        }
+        return _dispatchToListeners(call, event);
       }
     } else if (_current != null && _id == _current!.id) {
-      for (final WindowListener listener in listeners) {
-        if (!_listeners.contains(listener)) {
-          break;
-        }
+      return _dispatchToListeners(call, event);
+    }
+  }
+
+  Future<dynamic> _dispatchToListeners(
+    MethodCall call,
+    WindowEvent? event,
+  ) async {
+    for (final WindowListener listener in listeners) {
+      if (!_listeners.contains(listener)) {
+        break;
+      }
 
-        if (eventName == kEventFromWindow) {
+      if (event == null) {
+        if (call.arguments['eventName'] == kEventFromWindow) {
           String method = call.arguments['method'];
           int fromWindowId = call.arguments['fromWindowId'];
           dynamic eventArguments = call.arguments['arguments'];
@@ -166,30 +268,42 @@ class WindowManagerPlus {
                 method, fromWindowId, eventArguments);
           } catch (_) {}
         }
-
-        listener.onWindowEvent(eventName);
-        Map<String, Function> funcMap = {
-          kWindowEventClose: listener.onWindowClose,
-          kWindowEventFocus: listener.onWindowFocus,
-          kWindowEventBlur: listener.onWindowBlur,
-          kWindowEventMaximize: listener.onWindowMaximize,
-          kWindowEventUnmaximize: listener.onWindowUnmaximize,
-          kWindowEventMinimize: listener.onWindowMinimize,
-          kWindowEventRestore: listener.onWindowRestore,
-          kWindowEventResize: listener.onWindowResize,
-          kWindowEventResized: listener.onWindowResized,
-          kWindowEventMove: listener.onWindowMove,
-          kWindowEventMoved: listener.onWindowMoved,
-          kWindowEventEnterFullScreen: listener.onWindowEnterFullScreen,
-          kWindowEventLeaveFullScreen: listener.onWindowLeaveFullScreen,
-          kWindowEventDocked: listener.onWindowDocked,
-          kWindowEventUndocked: listener.onWindowUndocked,
-        };
-        funcMap[eventName]?.call();
+        listener.onWindowEvent(call.arguments['eventName']);
+        continue;
       }
+
+      _dispatchWindowEvent(listener, event, null);
     }
   }
 
+  /// Applies a tick of the thumbnail service. The new previews are views into
+  /// its single buffer, and the previews of closed windows are dropped.
+  void _updateThumbnails(Map<dynamic, dynamic> arguments) {
+    final List<int> windowIds = arguments['windowIds'];
+    final List<int> index = arguments['index'];
+    final Uint8List pixels = arguments['pixels'];
+    final Map<int, WindowCapture> previous = thumbnails.value;
+    final Map<int, WindowCapture> updated = {
+      for (final int windowId in windowIds)
+        if (previous.containsKey(windowId)) windowId: previous[windowId]!,
+    };
+    for (int i = 0; i + 3 < index.length; i += 4) {
+      final int width = index[i + 1];
+      final int height = index[i + 2];
+      final int offset = index[i + 3];
+      updated[index[i]] = WindowCapture(
+        width: width,
+        height: height,
+        bytes: Uint8List.sublistView(
+          pixels,
+          offset,
+          offset + width * height * 4,
+        ),
+      );
+    }
+    thumbnails.value = updated;
+  }
+
   /// Get the window listeners.
   List<WindowListener> get listeners {
     final List<WindowListener> localListeners =
@@ -256,6 +370,84 @@ class WindowManagerPlus {
     return WindowManagerPlus._fromWindowId(windowId);
   }
 
+  /// Straight-alpha RGBA previews of every window of the process by window
+  /// id, kept up to date natively while [setThumbnailOptions] is enabled in
+  /// the current window.
+  static final ValueNotifier<Map<int, WindowCapture>> thumbnails =
+      ValueNotifier(const {});
+
+  static final StreamController<CursorSample> _cursorController =
+      StreamController<CursorSample>.broadcast(
+    onListen: () => current._invokeMethod(
+      'setCursorStreamEnabled',
+      {'enabled': true},
+    ),
+    onCancel: () => current._invokeMethod(
+      'setCursorStreamEnabled',
+      {'enabled': false},
+    ),
+  );
+
+  /// The global pointer position, sampled natively once per frame while the
+  /// stream has listeners. Only changes are reported, and they arrive in
+  /// batches of at most one message per 16 ms.
+  ///
+  /// Listening has a cost even when nothing is reported: while the pointer
+  /// moves, the window is woken every frame, and on Linux its frame clock
+  /// keeps producing frames. After about half a second without a change,
+  /// sampling drops to every 100 ms, so the first move after a rest may be
+  /// reported up to 100 ms late. Cancel the subscription when the positions
+  /// are not needed.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Stream<CursorSample> get cursorPositions => _cursorController.stream;
+
+  static final StreamController<WindowBoundsEvent> _boundsController =
+      StreamController<WindowBoundsEvent>.broadcast();
+
+  /// The moves and resizes of the current window, with its bounds after
+  /// each of them.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Stream<WindowBoundsEvent> get boundsEvents =>
+      _boundsController.stream;
+
+  /// Starts or stops the native thumbnail service, which refreshes
+  /// [thumbnails] every [interval] for the current window, e.g. a window
+  /// switcher. Only one window receives thumbnails at a time. Intervals
+  /// shorter than 16 ms, a frame, are raised to it.
+  ///
+  /// Every tick only captures the windows redrawn since the previous one,
+  /// or not refreshed for [maxStaleTicks] ticks (0 never forces a refresh),
+  /// and all the previews that changed arrive in a single message. Previews
+  /// are halved until they fit [maxSize], in physical pixels.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Future<void> setThumbnailOptions({
+    bool enabled = true,
+    Size maxSize = const Size(320, 240),
+    Duration interval = const Duration(milliseconds: 250),
+    int maxStaleTicks = 8,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'enabled': enabled,
+      'maxWidth': maxSize.width.round(),
+      'maxHeight': maxSize.height.round(),
+      'interval': interval.inMilliseconds,
+      'maxStaleTicks': maxStaleTicks,
+    };
+    await current._invokeMethod('setThumbnailOptions', arguments);
+    if (!enabled) {
+      thumbnails.value = const {};
+    }
+  }
+
   /// Get all window manager ids.
   static Future<List<int>> getAllWindowManagerIds() async {
     return (await _staticChannel
@@ -264,6 +456,103 @@ class WindowManagerPlus {
         [];
   }
 
+  /// Saves the bounds, maximized / full-screen state, visibility and
+  /// always-on-top state of every window under the layout [name], and
+  /// returns the number of windows saved.
+  ///
+  /// Layouts are stored natively and survive restarts.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Future<int> saveLayout(String name) async {
+    final Map<String, dynamic> arguments = {
+      'name': name,
+    };
+    final Map<dynamic, dynamic> result =
+        await _staticChannel.invokeMethod('saveLayout', arguments);
+    return result['windowCount'] as int;
+  }
+
+  /// Applies the layout saved under [name] to every window in a single
+  /// native batch, so that no intermediate arrangement is visible, and
+  /// returns how long the switch took.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Future<Duration> applyLayout(String name) async {
+    final Map<String, dynamic> arguments = {
+      'name': name,
+    };
+    final Map<dynamic, dynamic> result =
+        await _staticChannel.invokeMethod('applyLayout', arguments);
+    return Duration(microseconds: result['elapsedMicros'] as int);
+  }
+
+  /// Tiles the windows of [windowIds], in order, over the work area of the
+  /// display [displayId] (see [getDisplays]), or of the display the first
+  /// window is on. A repeated id is only tiled at its first position. Each window's minimum / maximum size and aspect ratio are
+  /// honoured, and all of them are moved in a single native transaction.
+  ///
+  /// [gap] is the space between and around the tiles, [masterRatio] the
+  /// share of the width given to the first window in [TilingMode.masterStack]
+  /// and [columns] the number of columns of [TilingMode.grid] (a near-square
+  /// grid by default). Returns how long the operation took.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Future<Duration> tileWindows(
+    List<int> windowIds, {
+    TilingMode mode = TilingMode.grid,
+    String? displayId,
+    double gap = 0,
+    double masterRatio = 0.5,
+    int? columns,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'windowIds': windowIds,
+      'mode': mode.name,
+      'displayId': displayId,
+      'gap': gap,
+      'masterRatio': masterRatio,
+      'columns': columns,
+    }..removeWhere((key, value) => value == null);
+    final Map<dynamic, dynamic> result =
+        await _staticChannel.invokeMethod('tileWindows', arguments);
+    return Duration(microseconds: result['elapsedMicros'] as int);
+  }
+
+  /// Returns the connected displays from the native display cache, which is
+  /// refreshed when the monitor configuration changes (see
+  /// [WindowListener.onWindowDisplaysChanged]).
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  static Future<List<Display>> getDisplays() async {
+    final List<dynamic> result =
+        await _staticChannel.invokeMethod('getDisplays') ?? [];
+    return result.map((item) {
+      final Map<dynamic, dynamic> display = item;
+      return Display(
+        id: display['id'],
+        name: display['name'],
+        size: Size(display['size']['width'], display['size']['height']),
+        visiblePosition: Offset(
+          display['visiblePosition']['dx'],
+          display['visiblePosition']['dy'],
+        ),
+        visibleSize: Size(
+          display['visibleSize']['width'],
+          display['visibleSize']['height'],
+        ),
+        scaleFactor: display['scaleFactor'],
+      );
+    }).toList();
+  }
+
   /// Get the window manager from the window id.
   static WindowManagerPlus fromWindowId(int windowId) {
     return WindowManagerPlus._fromWindowId(windowId);
@@ -345,6 +634,196 @@ class WindowManagerPlus {
     }
   }
 
+  /// Sets whether [show] should keep the window unmapped until the Flutter
+  /// view has rendered its first frame, so that no empty window flashes at
+  /// startup. If no frame arrives within [timeout] the window is shown anyway.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  Future<void> setShowOnFirstFrame(
+    bool isShowOnFirstFrame, {
+    Duration timeout = const Duration(seconds: 1),
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'isShowOnFirstFrame': isShowOnFirstFrame,
+      'timeout': timeout.inMilliseconds,
+    };
+    await _invokeMethod('setShowOnFirstFrame', arguments);
+  }
+
+  /// Returns `Duration?` - The time between the plugin registration and the
+  /// first frame rendered by the Flutter view, or `null` if no frame has been
+  /// rendered yet.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  Future<Duration?> getTimeToFirstFrame() async {
+    final double? milliseconds = await _invokeMethod('getTimeToFirstFrame');
+    if (milliseconds == null) return null;
+    return Duration(microseconds: (milliseconds * 1000).round());
+  }
+
+  /// Persists the window bounds, maximized / full-screen state and monitor
+  /// under [key], and restores the ones saved under the same key right away.
+  ///
+  /// The geometry is saved natively when a move or resize ends and when the
+  /// window closes. Pass `null` to stop persisting.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setGeometryPersistenceKey(String? key) async {
+    final Map<String, dynamic> arguments = {
+      'key': key,
+    };
+    await _invokeMethod('setGeometryPersistenceKey', arguments);
+  }
+
+  /// Attaches the window to the window [parentId], so that it follows the
+  /// parent natively when the parent moves, without a round trip through
+  /// Dart.
+  ///
+  /// [offset] is the position of the window relative to the parent, it
+  /// defaults to the current one. When [minimizeWithParent] is `true` the
+  /// window is also minimized and restored together with its parent.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> attachToParent(
+    int parentId, {
+    Offset? offset,
+    bool minimizeWithParent = false,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'parentId': parentId,
+      'offsetX': offset?.dx,
+      'offsetY': offset?.dy,
+      'minimizeWithParent': minimizeWithParent,
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setParentWindow', arguments);
+  }
+
+  /// Detaches the window from the parent set with [attachToParent].
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> detachFromParent() async {
+    final Map<String, dynamic> arguments = {
+      'parentId': null,
+      'minimizeWithParent': false,
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setParentWindow', arguments);
+  }
+
+  /// Sets whether the window snaps to the edges of the other windows and of
+  /// the work area when it is dragged, once it comes within [distance]
+  /// logical pixels of them.
+  ///
+  /// Snapping runs natively in the move path. On Linux it applies to drags
+  /// started with [startDragging] on X11.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setSnapping(bool isSnapping, {double distance = 10}) async {
+    final Map<String, dynamic> arguments = {
+      'isSnapping': isSnapping,
+      'distance': distance,
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setSnapping', arguments);
+  }
+
+  /// Sets the areas of the window, in logical pixels, that drag it like a
+  /// title bar, without the [excludedRegions] such as caption buttons.
+  ///
+  /// The areas are hit tested natively, so the drag starts right from the
+  /// button press instead of waiting for [startDragging], and a double click
+  /// maximizes or restores the window. Pass an empty list to remove them.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setDragRegions(
+    List<Rect> regions, {
+    List<Rect> excludedRegions = const [],
+  }) async {
+    Float64List pack(List<Rect> rects) => Float64List.fromList([
+          for (final Rect rect in rects) ...[
+            rect.left,
+            rect.top,
+            rect.width,
+            rect.height,
+          ],
+        ]);
+    final Map<String, dynamic> arguments = {
+      'regions': pack(regions),
+      'excludedRegions': pack(excludedRegions),
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setDragRegions', arguments);
+  }
+
+  /// Restricts pointer input to [regions], in logical pixels relative to the
+  /// window content, e.g. the interactive widgets of an overlay. Clicks
+  /// anywhere else go through to what is below the window. Pass `null` to
+  /// make the whole window take input again.
+  ///
+  /// Unchanged regions are skipped natively, so it can be called every
+  /// frame.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setInputRegion(List<Rect>? regions) async {
+    final Map<String, dynamic> arguments = {
+      'regions': regions == null
+          ? null
+          : Float64List.fromList([
+              for (final Rect rect in regions) ...[
+                rect.left,
+                rect.top,
+                rect.width,
+                rect.height,
+              ],
+            ]),
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setInputRegion', arguments);
+  }
+
+  /// Sets the band of [width] logical pixels along the sides of a frameless
+  /// window that resizes it, on the sides that are enabled. A width of 0
+  /// removes it.
+  ///
+  /// The border is hit tested natively, so the resize starts right from the
+  /// button press, without the widgets of `DragToResizeArea`.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setResizeBorder(
+    double width, {
+    bool top = true,
+    bool bottom = true,
+    bool left = true,
+    bool right = true,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'width': width,
+      'top': top,
+      'bottom': bottom,
+      'left': left,
+      'right': right,
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    await _invokeMethod('setResizeBorder', arguments);
+  }
+
   /// Force closing the window.
   Future<void> destroy() async {
     await _invokeMethod('destroy');
@@ -389,6 +868,9 @@ class WindowManagerPlus {
   /// - Windows
   /// - macOS
   Future<bool> isFocused() async {
+    if (_hasProtocol) {
+      return _protocol.isFocused();
+    }
     return await _invokeMethod('isFocused');
   }
 
@@ -409,13 +891,33 @@ class WindowManagerPlus {
     await _invokeMethod('hide');
   }
 
+  /// Returns the bounds, scale factor and state of the window as of the last
+  /// event handled by the platform thread, or null when they aren't
+  /// published, e.g. before [ensureInitialized].
+  ///
+  /// Unlike [getBounds] or [isFocused] it doesn't await a round trip to the
+  /// platform thread, so it can be read from layout code. A change
+  /// requested by [setBounds] or [maximize] only shows once the window
+  /// manager applied it.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  WindowSnapshot? getSnapshot() => readWindowSnapshot(_id);
+
   /// Returns `bool` - Whether the window is visible to the user.
   Future<bool> isVisible() async {
+    if (_hasProtocol) {
+      return _protocol.isVisible();
+    }
     return await _invokeMethod('isVisible');
   }
 
   /// Returns `bool` - Whether the window is maximized.
   Future<bool> isMaximized() async {
+    if (_hasProtocol) {
+      return _protocol.isMaximized();
+    }
     return await _invokeMethod('isMaximized');
   }
 
@@ -434,6 +936,9 @@ class WindowManagerPlus {
 
   /// Returns `bool` - Whether the window is minimized.
   Future<bool> isMinimized() async {
+    if (_hasProtocol) {
+      return _protocol.isMinimized();
+    }
     return await _invokeMethod('isMinimized');
   }
 
@@ -449,6 +954,9 @@ class WindowManagerPlus {
 
   /// Returns `bool` - Whether the window is in fullscreen mode.
   Future<bool> isFullScreen() async {
+    if (_hasProtocol) {
+      return _protocol.isFullScreen();
+    }
     return await _invokeMethod('isFullScreen');
   }
 
@@ -528,10 +1036,25 @@ class WindowManagerPlus {
   }
 
   /// Move the window to a position aligned with the screen.
+  ///
+  /// On Linux and Windows the position is computed natively from the work
+  /// area of the monitor the window is on, in a single call.
   Future<void> setAlignment(
     Alignment alignment, {
     bool animate = false,
   }) async {
+    if (!animate) {
+      try {
+        final Map<String, dynamic> arguments = {
+          'x': alignment.x,
+          'y': alignment.y,
+        };
+        await _invokeMethod('align', arguments);
+        return;
+      } on MissingPluginException {
+        // Not implemented natively on this platform.
+      }
+    }
     Size windowSize = await getSize();
     Offset position = await calcWindowPosition(windowSize, alignment);
     await setPosition(position, animate: animate);
@@ -541,13 +1064,15 @@ class WindowManagerPlus {
   Future<void> center({
     bool animate = false,
   }) async {
-    Size windowSize = await getSize();
-    Offset position = await calcWindowPosition(windowSize, Alignment.center);
-    await setPosition(position, animate: animate);
+    await setAlignment(Alignment.center, animate: animate);
   }
 
   /// Returns `Rect` - The bounds of the window as Object.
   Future<Rect> getBounds() async {
+    if (_hasProtocol) {
+      final bounds = await _protocol.getBounds(getDevicePixelRatio());
+      return Rect.fromLTWH(bounds.x, bounds.y, bounds.width, bounds.height);
+    }
     final Map<String, dynamic> arguments = {
       'devicePixelRatio': getDevicePixelRatio(),
     };
@@ -571,6 +1096,16 @@ class WindowManagerPlus {
     Size? size,
     bool animate = false,
   }) async {
+    // Only the macOS plugin animates.
+    if (_hasProtocol) {
+      return _protocol.setBounds(
+        bounds?.topLeft.dx ?? position?.dx,
+        bounds?.topLeft.dy ?? position?.dy,
+        bounds?.size.width ?? size?.width,
+        bounds?.size.height ?? size?.height,
+        getDevicePixelRatio(),
+      );
+    }
     final Map<String, dynamic> arguments = {
       'devicePixelRatio': getDevicePixelRatio(),
       'x': bounds?.topLeft.dx ?? position?.dx,
@@ -808,7 +1343,12 @@ class WindowManagerPlus {
 
   /// Sets window/taskbar icon.
   ///
+  /// The icon is decoded off the main thread and cached until the file
+  /// changes, so switching between a few icons is cheap. On Linux, a file
+  /// that can't be read or decoded throws a [PlatformException].
+  ///
   /// **Supported Platforms**:
+  /// - Linux
   /// - Windows
   Future<void> setIcon(String iconPath) async {
     final Map<String, dynamic> arguments = {
@@ -822,6 +1362,54 @@ class WindowManagerPlus {
     await _invokeMethod('setIcon', arguments);
   }
 
+  /// Sets window/taskbar icon from [bytes] in memory, either an encoded
+  /// image such as PNG, or straight-alpha RGBA pixels when [width] and
+  /// [height] are given.
+  ///
+  /// Avoids writing generated icons, e.g. with a badge, to a file for
+  /// [setIcon]. The smaller sizes are generated natively.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setIconFromBytes(
+    Uint8List bytes, {
+    int? width,
+    int? height,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'bytes': bytes,
+      'width': width,
+      'height': height,
+    };
+    await _invokeMethod('setIconFromBytes', arguments);
+  }
+
+  /// Captures the content of the window, frame included where the platform
+  /// draws one, in the pixel [format] asked for.
+  ///
+  /// The pixels have straight alpha unless [premultipliedAlpha] is true.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<WindowCapture> captureWindow({
+    CapturePixelFormat format = CapturePixelFormat.rgba,
+    bool premultipliedAlpha = false,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'format': format.name,
+      'premultipliedAlpha': premultipliedAlpha,
+    };
+    final Map<dynamic, dynamic> result =
+        await _invokeMethod('captureWindow', arguments);
+    return WindowCapture(
+      width: result['width'],
+      height: result['height'],
+      bytes: result['bytes'],
+    );
+  }
+
   /// Returns `bool` - Whether the window is visible on all workspaces.
   ///
   /// **Supported Platforms**:
@@ -892,11 +1480,17 @@ class WindowManagerPlus {
 
   /// Returns `double` - between 0.0 (fully transparent) and 1.0 (fully opaque).
   Future<double> getOpacity() async {
+    if (_hasProtocol) {
+      return _protocol.getOpacity();
+    }
     return await _invokeMethod('getOpacity');
   }
 
   /// Sets the opacity of the window.
   Future<void> setOpacity(double opacity) async {
+    if (_hasProtocol) {
+      return _protocol.setOpacity(opacity);
+    }
     final Map<String, dynamic> arguments = {
       'opacity': opacity,
     };
@@ -927,6 +1521,51 @@ class WindowManagerPlus {
     await _invokeMethod('popUpWindowMenu', arguments);
   }
 
+  /// Returns the latencies from the button presses that dragged or resized
+  /// the window to the drag or resize starting, and to the first move.
+  ///
+  /// Set [reset] to start the next measurements from scratch.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<InputLatencyStats> getInputLatencyStats({bool reset = false}) async {
+    final Map<String, dynamic> arguments = {
+      'reset': reset,
+    };
+    final Map<dynamic, dynamic> result =
+        await _invokeMethod('getInputLatencyStats', arguments);
+    return InputLatencyStats.fromJson(result);
+  }
+
+  /// Sets what happens to the [eventName] events while the listeners of
+  /// this window are behind on them. `move`, `resize`, and the batches of
+  /// [cursorPositions] (`cursorSamples`) and [thumbnails] (`thumbnails`)
+  /// default to [EventPolicy.latestWins], the others to
+  /// [EventPolicy.keepAll].
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<void> setEventPolicy(String eventName, EventPolicy policy) async {
+    final Map<String, dynamic> arguments = {
+      'eventName': eventName,
+      'policy': policy.name,
+    };
+    await _invokeMethod('setEventPolicy', arguments);
+  }
+
+  /// Returns the counters of the queue of the events sent to this window.
+  ///
+  /// **Supported Platforms**:
+  /// - Linux
+  /// - Windows
+  Future<EventQueueStats> getEventQueueStats() async {
+    final Map<dynamic, dynamic> result =
+        await _invokeMethod('getEventQueueStats');
+    return EventQueueStats.fromJson(result);
+  }
+
   /// Starts a window drag based on the specified mouse-down event.
   /// On Windows, this is disabled during full screen mode.
   Future<void> startDragging() async {
@@ -0,0 +1,110 @@
+// Generated by tool/generate_protocol.py from protocol/window_manager.idl.
+// Do not edit.
+
+import 'package:flutter/services.dart';
+import 'package:window_manager_plus_v2/src/protocol_codec.dart';
+
+class Bounds {
+  const Bounds({
+    required this.x,
+    required this.y,
+    required this.width,
+    required this.height,
+  });
+
+  factory Bounds.read(ProtocolReader reader) => Bounds(
+        x: reader.readDouble(),
+        y: reader.readDouble(),
+        width: reader.readDouble(),
+        height: reader.readDouble(),
+      );
+
+  final double x;
+  final double y;
+  final double width;
+  final double height;
+
+  void write(ProtocolWriter writer) {
+    writer.writeDouble(x);
+    writer.writeDouble(y);
+    writer.writeDouble(width);
+    writer.writeDouble(height);
+  }
+}
+
+/// The calls of protocol/window_manager.idl to the window [windowId].
+class WindowManagerProtocol {
+  WindowManagerProtocol(String channelName, this.windowId)
+      : _channel = BasicMessageChannel<ByteData?>(
+          channelName,
+          const BinaryCodec(),
+        );
+
+  final BasicMessageChannel<ByteData?> _channel;
+  final int windowId;
+
+  Future<Bounds> getBounds(double devicePixelRatio) async {
+    final writer = ProtocolWriter.call(0, windowId);
+    writer.writeDouble(devicePixelRatio);
+    final reader = await sendProtocolCall(_channel, writer);
+    return Bounds.read(reader);
+  }
+
+  Future<void> setBounds(
+    double? x,
+    double? y,
+    double? width,
+    double? height,
+    double devicePixelRatio,
+  ) async {
+    final writer = ProtocolWriter.call(1, windowId);
+    writer.writeOptional(x, writer.writeDouble);
+    writer.writeOptional(y, writer.writeDouble);
+    writer.writeOptional(width, writer.writeDouble);
+    writer.writeOptional(height, writer.writeDouble);
+    writer.writeDouble(devicePixelRatio);
+    await sendProtocolCall(_channel, writer);
+  }
+
+  Future<bool> isFocused() async {
+    final writer = ProtocolWriter.call(2, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readBool();
+  }
+
+  Future<bool> isVisible() async {
+    final writer = ProtocolWriter.call(3, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readBool();
+  }
+
+  Future<bool> isMaximized() async {
+    final writer = ProtocolWriter.call(4, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readBool();
+  }
+
+  Future<bool> isMinimized() async {
+    final writer = ProtocolWriter.call(5, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readBool();
+  }
+
+  Future<bool> isFullScreen() async {
+    final writer = ProtocolWriter.call(6, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readBool();
+  }
+
+  Future<double> getOpacity() async {
+    final writer = ProtocolWriter.call(7, windowId);
+    final reader = await sendProtocolCall(_channel, writer);
+    return reader.readDouble();
+  }
+
+  Future<void> setOpacity(double opacity) async {
+    final writer = ProtocolWriter.call(8, windowId);
+    writer.writeDouble(opacity);
+    await sendProtocolCall(_channel, writer);
+  }
+}
@@ -0,0 +1,115 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:ui';
+
+/// The state of a window read synchronously, see
+/// `WindowManagerPlus.getSnapshot`.
+class WindowSnapshot {
+  const WindowSnapshot({
+    required this.bounds,
+    required this.scaleFactor,
+    required this.isFocused,
+    required this.isVisible,
+    required this.isMaximized,
+    required this.isMinimized,
+    required this.isFullScreen,
+  });
+
+  /// Bounds of the window in logical pixels.
+  final Rect bounds;
+
+  /// Physical pixels per logical pixel.
+  final double scaleFactor;
+
+  final bool isFocused;
+  final bool isVisible;
+  final bool isMaximized;
+  final bool isMinimized;
+  final bool isFullScreen;
+}
+
+// Bits of the flags of the snapshot struct of the plugin headers.
+const _kSnapshotPublished = 1 << 0;
+const _kSnapshotFocused = 1 << 1;
+const _kSnapshotVisible = 1 << 2;
+const _kSnapshotMaximized = 1 << 3;
+const _kSnapshotMinimized = 1 << 4;
+const _kSnapshotFullScreen = 1 << 5;
+
+final class _NativeSnapshot extends Struct {
+  @Double()
+  external double x;
+
+  @Double()
+  external double y;
+
+  @Double()
+  external double width;
+
+  @Double()
+  external double height;
+
+  @Double()
+  external double scaleFactor;
+
+  @Uint32()
+  external int flags;
+}
+
+typedef _GetSnapshotNative = _NativeSnapshot Function(Int64 windowId);
+typedef _GetSnapshot = _NativeSnapshot Function(int windowId);
+
+final _GetSnapshot? _getSnapshot = _lookUpGetSnapshot();
+
+// A leaf call: the native side only copies the snapshot published by the
+// platform thread, so it never calls back into Dart nor blocks.
+_GetSnapshot? _lookUpGetSnapshot() {
+  try {
+    if (Platform.isLinux) {
+      // The plugin library is linked into the runner.
+      return DynamicLibrary.process()
+          .lookupFunction<_GetSnapshotNative, _GetSnapshot>(
+        'window_manager_plugin_get_snapshot',
+        isLeaf: true,
+      );
+    }
+    if (Platform.isWindows) {
+      return DynamicLibrary.open('window_manager_plus_v2_plugin.dll')
+          .lookupFunction<_GetSnapshotNative, _GetSnapshot>(
+        'WindowManagerPlusPluginGetSnapshot',
+        isLeaf: true,
+      );
+    }
+  } on ArgumentError {
+    // Not exported by this build of the plugin.
+  }
+  return null;
+}
+
+/// Returns the last snapshot published for [windowId], or null when the
+/// plugin doesn't publish snapshots or has none for this window.
+WindowSnapshot? readWindowSnapshot(int windowId) {
+  final getSnapshot = _getSnapshot;
+  if (getSnapshot == null) {
+    return null;
+  }
+  final snapshot = getSnapshot(windowId);
+  final flags = snapshot.flags;
+  if ((flags & _kSnapshotPublished) == 0) {
+    return null;
+  }
+  return WindowSnapshot(
+    bounds: Rect.fromLTWH(
+      snapshot.x,
+      snapshot.y,
+      snapshot.width,
+      snapshot.height,
+    ),
+    scaleFactor: snapshot.scaleFactor,
+    isFocused: (flags & _kSnapshotFocused) != 0,
+    isVisible: (flags & _kSnapshotVisible) != 0,
+    isMaximized: (flags & _kSnapshotMaximized) != 0,
+    isMinimized: (flags & _kSnapshotMinimized) != 0,
+    isFullScreen: (flags & _kSnapshotFullScreen) != 0,
+  );
+}
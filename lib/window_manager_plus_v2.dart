@@ -1,4 +1,8 @@
+export 'src/cursor_sample.dart';
+export 'src/event_queue_stats.dart';
+export 'src/input_latency_stats.dart';
 export 'src/resize_edge.dart';
+export 'src/tiling_mode.dart';
 export 'src/title_bar_style.dart';
 export 'src/utils/calc_window_position.dart';
 export 'src/widgets/drag_to_move_area.dart';
@@ -6,6 +10,10 @@ export 'src/widgets/drag_to_resize_area.dart';
 export 'src/widgets/virtual_window_frame.dart';
 export 'src/widgets/window_caption.dart';
 export 'src/widgets/window_caption_button.dart';
+export 'src/window_bounds_event.dart';
+export 'src/window_capture.dart';
+export 'src/window_event.dart';
 export 'src/window_listener.dart';
 export 'src/window_manager.dart';
 export 'src/window_options.dart';
+export 'src/window_snapshot.dart' show WindowSnapshot;
@@ -21,6 +21,35 @@ FLUTTER_PLUGIN_EXPORT GType window_manager_plugin_get_type();
 FLUTTER_PLUGIN_EXPORT void window_manager_plugin_register_with_registrar(
     FlPluginRegistrar* registrar);
 
+// Bits of WindowManagerSnapshot.flags.
+#define WINDOW_MANAGER_SNAPSHOT_PUBLISHED (1 << 0)
+#define WINDOW_MANAGER_SNAPSHOT_FOCUSED (1 << 1)
+#define WINDOW_MANAGER_SNAPSHOT_VISIBLE (1 << 2)
+#define WINDOW_MANAGER_SNAPSHOT_MAXIMIZED (1 << 3)
+#define WINDOW_MANAGER_SNAPSHOT_MINIMIZED (1 << 4)
+#define WINDOW_MANAGER_SNAPSHOT_FULL_SCREEN (1 << 5)
+
+typedef struct {
+  // Bounds of the window in logical pixels.
+  gdouble x;
+  gdouble y;
+  gdouble width;
+  gdouble height;
+  // Physical pixels per logical pixel.
+  gdouble scale_factor;
+  guint32 flags;
+} WindowManagerSnapshot;
+
+// Returns the state of the window |window_id| as of the last event handled
+// by the platform thread, without a round trip through the method channel.
+// It is meant for dart:ffi and may be called from any thread: it reads a
+// copy that the platform thread publishes, never the GTK window, and it
+// neither blocks nor allocates. flags lacks
+// WINDOW_MANAGER_SNAPSHOT_PUBLISHED when no window |window_id| was
+// initialized by Dart.
+FLUTTER_PLUGIN_EXPORT WindowManagerSnapshot
+window_manager_plugin_get_snapshot(gint64 window_id);
+
 G_END_DECLS
 
 #endif  // FLUTTER_PLUGIN_WINDOW_MANAGER_PLUGIN_H_
@@ -3,6 +3,57 @@
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 
+#include <memory>
+#include <optional>
+
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
+#include "cursor_sampler.h"
+#include "display_topology.h"
+#include "edge_snapper.h"
+#include "event_queue.h"
+#include "event_record.h"
+#include "input_latency.h"
+#include "input_region.h"
+#include "method_args.h"
+#include "pixel_ops.h"
+#include "rect.h"
+#include "rect_index.h"
+#include "resize_border.h"
+#include "thumbnails.h"
+#include "tiling.h"
+#include "window_event.h"
+#include "window_geometry_store.h"
+#include "window_layout.h"
+#include "window_manager_protocol.h"
+#include "window_snapshot.h"
+
+using window_manager_plus_v2::WindowEvent;
+using window_manager_plus_v2::WindowGeometry;
+using window_manager_plus_v2::WindowGeometryStore;
+using window_manager_plus_v2::WindowLayout;
+using window_manager_plus_v2::WindowSnapshot;
+using window_manager_plus_v2::protocol::WindowManagerApi;
+
+// The last button press in the view, all that is needed to synthesize its
+// release after a native drag or resize.
+struct ButtonPress {
+  gdouble x;
+  gdouble y;
+  guint button;
+  // Event time, for the drags and resizes started from Dart.
+  guint32 time;
+};
+
+// An event waiting for Dart, sent by calling |method|, or on the event
+// channel when it's nullptr.
+struct QueuedEvent {
+  const gchar* method;
+  std::shared_ptr<FlValue> value;
+};
+
 #define WINDOW_MANAGER_PLUGIN(obj)                                     \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), window_manager_plugin_get_type(), \
                               WindowManagerPlugin))
@@ -11,6 +62,40 @@ struct _WindowManagerPlugin {
   GObject parent_instance;
   FlPluginRegistrar* registrar;
   FlMethodChannel* channel;
+  gint64 window_id;
+  gint64 parent_id;
+  GdkPoint parent_offset;
+  bool _is_minimized_with_parent;
+  // 0 when snapping is off.
+  gdouble snap_distance;
+  window_manager_plus_v2::EdgeSnapper* snapper;
+  // Set while start_dragging moves the window itself.
+  GdkSeat* drag_seat;
+  GdkPoint drag_pointer;
+  GdkPoint drag_origin;
+  window_manager_plus_v2::DragRegions* drag_regions;
+  window_manager_plus_v2::ResizeBorder resize_border;
+  window_manager_plus_v2::InputLatencyTracker* input_latency;
+  // The events waiting for Dart to catch up.
+  window_manager_plus_v2::EventQueue<QueuedEvent>* event_queue;
+  // Binary channel of the moves and resizes, named after window_id once
+  // Dart is initialized.
+  gchar* event_channel;
+  // Binary channel of the calls of protocol/window_manager.idl, also named
+  // after window_id.
+  gchar* protocol_channel;
+  // Set once setInputRegion is called.
+  window_manager_plus_v2::InputRegion* input_region;
+  // The frame clock sampling the cursor while the stream is enabled, and
+  // the slower poll replacing it while the pointer rests.
+  GdkFrameClock* cursor_clock;
+  gulong cursor_frame_handler;
+  guint cursor_idle_source;
+  window_manager_plus_v2::CursorSampler* cursor_sampler;
+  GtkGesture* press_gesture;
+  // Last press in a drag region, to detect double clicks.
+  guint32 drag_region_press_time;
+  GdkPoint drag_region_press;
   GdkGeometry window_geometry;
   GdkWindowHints window_hints;
   GtkWidget* _event_box;
@@ -20,14 +105,42 @@ struct _WindowManagerPlugin {
   bool _is_always_on_bottom;
   bool _is_dragging;
   bool _is_resizing;
+  bool _is_show_on_first_frame;
+  bool _is_first_frame_rendered;
+  bool _is_show_pending;
+  guint first_frame_timeout_ms;
+  guint first_frame_timeout_id;
+  gint64 registered_time;
+  gint64 time_to_first_frame;
+  gchar* geometry_key;
+  guint geometry_save_id;
+  GdkRectangle normal_bounds;
   gchar* title_bar_style_;
-  GdkEventButton _event_button;
+  ButtonPress _last_press;
+  // Incremented by every set_icon, so that a slow decode never replaces the
+  // icon of a later call.
+  guint icon_generation;
+  // Preview kept by the thumbnail service, allocated on its first tick.
+  window_manager_plus_v2::Thumbnail* thumbnail;
+  // Drawn since the last preview.
+  bool thumbnail_dirty;
+  guint thumbnail_age;
   GdkDevice* grab_pointer;
   GtkCssProvider* css_provider;
 };
 
 G_DEFINE_TYPE(WindowManagerPlugin, window_manager_plugin, g_object_get_type())
 
+// Every plugin instance of the process, one per window, for the operations
+// spanning several windows such as layouts.
+static GList* plugins = nullptr;
+
+static bool push_event(WindowManagerPlugin* plugin,
+                       const gchar* name,
+                       const std::string& key,
+                       const gchar* method,
+                       FlValue* value);
+
 // Gets the window being controlled.
 GtkWindow* get_window(WindowManagerPlugin* self) {
   FlView* view = fl_plugin_registrar_get_view(self->registrar);
@@ -92,13 +205,78 @@ static FlMethodResponse* is_focused(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Maps the window if a show request was held back waiting for the first
+// frame.
+static void show_pending_window(WindowManagerPlugin* self) {
+  g_clear_handle_id(&self->first_frame_timeout_id, g_source_remove);
+  if (self->_is_show_pending) {
+    self->_is_show_pending = false;
+    gtk_widget_show(GTK_WIDGET(get_window(self)));
+  }
+}
+
+// Fallback used when the engine takes too long to render its first frame, so
+// that the window never stays hidden forever.
+static gboolean on_first_frame_timeout(gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  self->first_frame_timeout_id = 0;
+  show_pending_window(self);
+  return G_SOURCE_REMOVE;
+}
+
+static FlMethodResponse* set_show_on_first_frame(WindowManagerPlugin* self,
+                                                 FlValue* args) {
+  window_manager_plus_v2::ShowOnFirstFrameArgs show_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::ShowOnFirstFrameArgsSchema(), args,
+          &show_args)) {
+    return error;
+  }
+  self->_is_show_on_first_frame = show_args.is_show_on_first_frame;
+  if (show_args.timeout) {
+    self->first_frame_timeout_ms = static_cast<guint>(
+        CLAMP(*show_args.timeout, G_GINT64_CONSTANT(0), G_MAXUINT));
+  }
+
+  if (!self->_is_show_on_first_frame) {
+    show_pending_window(self);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* get_time_to_first_frame(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result =
+      self->_is_first_frame_rendered && self->time_to_first_frame >= 0
+          ? fl_value_new_float(self->time_to_first_frame / 1000.0)
+          : fl_value_new_null();
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
 static FlMethodResponse* show(WindowManagerPlugin* self) {
+  if (self->_is_show_on_first_frame && !self->_is_first_frame_rendered) {
+    // Keep the window unmapped until the view has something to present,
+    // otherwise the compositor shows (and composites) an empty window.
+    self->_is_show_pending = true;
+    if (self->first_frame_timeout_id == 0) {
+      self->first_frame_timeout_id = g_timeout_add(
+          self->first_frame_timeout_ms, on_first_frame_timeout, self);
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(true);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
   gtk_widget_show(GTK_WIDGET(get_window(self)));
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
 static FlMethodResponse* hide(WindowManagerPlugin* self) {
+  // A show still waiting for the first frame must not map the window later.
+  self->_is_show_pending = false;
+  g_clear_handle_id(&self->first_frame_timeout_id, g_source_remove);
+
   gint x, y, width, height;
   // store the bound of window before hide
   gtk_window_get_position(get_window(self), &x, &y);
@@ -219,21 +397,110 @@ static FlMethodResponse* set_aspect_ratio(WindowManagerPlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+static window_manager_plus_v2::ArgValue arg_value_from_fl(FlValue* value) {
+  using Kind = window_manager_plus_v2::ArgValue::Kind;
+  window_manager_plus_v2::ArgValue arg;
+  switch (fl_value_get_type(value)) {
+    case FL_VALUE_TYPE_NULL:
+      arg.kind = Kind::kNull;
+      break;
+    case FL_VALUE_TYPE_BOOL:
+      arg.kind = Kind::kBool;
+      arg.bool_value = fl_value_get_bool(value);
+      break;
+    case FL_VALUE_TYPE_INT:
+      arg.kind = Kind::kInt;
+      arg.int_value = fl_value_get_int(value);
+      break;
+    case FL_VALUE_TYPE_FLOAT:
+      arg.kind = Kind::kDouble;
+      arg.double_value = fl_value_get_float(value);
+      break;
+    case FL_VALUE_TYPE_STRING:
+      arg.kind = Kind::kString;
+      arg.string_value = fl_value_get_string(value);
+      break;
+    case FL_VALUE_TYPE_FLOAT_LIST:
+      arg.kind = Kind::kDoubleList;
+      arg.double_list_value.data = fl_value_get_float_list(value);
+      arg.double_list_value.size = fl_value_get_length(value);
+      break;
+    case FL_VALUE_TYPE_LIST: {
+      // A List<double> rather than a Float64List, copied if it only holds
+      // numbers.
+      auto converted = std::make_shared<std::vector<double>>();
+      arg.kind = Kind::kDoubleList;
+      for (size_t i = 0; i < fl_value_get_length(value); i++) {
+        FlValue* item = fl_value_get_list_value(value, i);
+        if (fl_value_get_type(item) == FL_VALUE_TYPE_FLOAT) {
+          converted->push_back(fl_value_get_float(item));
+        } else if (fl_value_get_type(item) == FL_VALUE_TYPE_INT) {
+          converted->push_back(static_cast<double>(fl_value_get_int(item)));
+        } else {
+          arg.kind = Kind::kOther;
+          break;
+        }
+      }
+      if (arg.kind == Kind::kDoubleList) {
+        arg.double_list_value.data = converted->data();
+        arg.double_list_value.size = converted->size();
+        arg.double_list_value.converted = std::move(converted);
+      }
+      break;
+    }
+    default:
+      arg.kind = Kind::kOther;
+      break;
+  }
+  return arg;
+}
+
+// Decodes |args| into |out| with |schema|. Returns the invalid_argument
+// error to send back when they don't match, nullptr otherwise.
+template <typename Args>
+static FlMethodResponse* decode_args(
+    const window_manager_plus_v2::ArgSchema<Args>& schema,
+    FlValue* args,
+    Args* out) {
+  auto error = schema.Decode(
+      [args](auto&& visit) {
+        if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+          return;
+        }
+        for (size_t i = 0; i < fl_value_get_length(args); i++) {
+          FlValue* key = fl_value_get_map_key(args, i);
+          if (fl_value_get_type(key) == FL_VALUE_TYPE_STRING) {
+            visit(fl_value_get_string(key),
+                  arg_value_from_fl(fl_value_get_map_value(args, i)));
+          }
+        }
+      },
+      out);
+  if (!error) {
+    return nullptr;
+  }
+  g_autofree gchar* message = g_strdup_printf(
+      "Argument '%s' %s", error->argument.c_str(), error->message.c_str());
+  g_autoptr(FlValue) details = fl_value_new_map();
+  fl_value_set_string_take(details, "argument",
+                           fl_value_new_string(error->argument.c_str()));
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new("invalid_argument", message, details));
+}
+
 static FlMethodResponse* set_background_color(WindowManagerPlugin* self,
                                               FlValue* args) {
+  window_manager_plus_v2::BackgroundColorArgs color_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::BackgroundColorArgsSchema(), args,
+          &color_args)) {
+    return error;
+  }
   GdkRGBA rgba;
-  rgba.red = ((double)fl_value_get_int(
-                  fl_value_lookup_string(args, "backgroundColorR")) /
-              255.0);
-  rgba.green = ((double)fl_value_get_int(
-                    fl_value_lookup_string(args, "backgroundColorG")) /
-                255.0);
-  rgba.blue = ((double)fl_value_get_int(
-                   fl_value_lookup_string(args, "backgroundColorB")) /
-               255.0);
-  rgba.alpha = ((double)fl_value_get_int(
-                    fl_value_lookup_string(args, "backgroundColorA")) /
-                255.0);
+  rgba.red = color_args.r / 255.0;
+  rgba.green = color_args.g / 255.0;
+  rgba.blue = color_args.b / 255.0;
+  rgba.alpha = color_args.a / 255.0;
 
   g_autofree gchar* color = gdk_rgba_to_string(&rgba);
   g_autofree gchar* css =
@@ -273,21 +540,159 @@ static FlMethodResponse* get_bounds(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result_data));
 }
 
+static void apply_bounds(WindowManagerPlugin* self,
+                         const window_manager_plus_v2::BoundsArgs& bounds) {
+  if (bounds.x && bounds.y) {
+    gtk_window_move(get_window(self), static_cast<gint>(*bounds.x),
+                    static_cast<gint>(*bounds.y));
+  }
+  if (bounds.width && bounds.height) {
+    gtk_window_resize(get_window(self), static_cast<gint>(*bounds.width),
+                      static_cast<gint>(*bounds.height));
+  }
+}
+
 static FlMethodResponse* set_bounds(WindowManagerPlugin* self, FlValue* args) {
-  FlValue* x = fl_value_lookup_string(args, "x");
-  FlValue* y = fl_value_lookup_string(args, "y");
-  if (x != nullptr && y != nullptr) {
-    gtk_window_move(get_window(self), static_cast<gint>(fl_value_get_float(x)),
-                    static_cast<gint>(fl_value_get_float(y)));
+  window_manager_plus_v2::BoundsArgs bounds;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::BoundsArgsSchema(), args, &bounds)) {
+    return error;
   }
+  apply_bounds(self, bounds);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
 
-  FlValue* width = fl_value_lookup_string(args, "width");
-  FlValue* height = fl_value_lookup_string(args, "height");
-  if (width != nullptr && height != nullptr) {
-    gtk_window_resize(get_window(self),
-                      static_cast<gint>(fl_value_get_float(width)),
-                      static_cast<gint>(fl_value_get_float(height)));
+// The connector, e.g. DP-1, and the model, which tell apart two monitors of
+// the same model, then the geometry, all that is left when the names are
+// unknown. Like the device names of Windows, it changes when the monitor
+// moves to another connector.
+static std::string get_monitor_id(GdkMonitor* monitor) {
+  if (monitor == nullptr)
+    return "";
+
+  GdkDisplay* display = gdk_monitor_get_display(monitor);
+  g_autofree gchar* connector = nullptr;
+  for (gint i = 0; i < gdk_display_get_n_monitors(display); i++) {
+    if (gdk_display_get_monitor(display, i) == monitor) {
+      // GdkMonitor has no getter for it in GTK 3.
+      G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+      connector = gdk_screen_get_monitor_plug_name(
+          gdk_display_get_default_screen(display), i);
+      G_GNUC_END_IGNORE_DEPRECATIONS
+      break;
+    }
+  }
+  std::string id;
+  for (const gchar* name : {static_cast<const gchar*>(connector),
+                            gdk_monitor_get_model(monitor)}) {
+    if (name != nullptr && name[0] != '\0') {
+      id.append(name).append("|");
+    }
+  }
+  GdkRectangle geometry;
+  gdk_monitor_get_geometry(monitor, &geometry);
+  g_autofree gchar* bounds = g_strdup_printf(
+      "%d,%d,%dx%d", geometry.x, geometry.y, geometry.width, geometry.height);
+  return id.append(bounds);
+}
+
+static window_manager_plus_v2::Rect rect_from_gdk(const GdkRectangle& rect) {
+  return {static_cast<double>(rect.x), static_cast<double>(rect.y),
+          static_cast<double>(rect.width), static_cast<double>(rect.height)};
+}
+
+// Monitors of the default display, refreshed on GdkScreen::monitors-changed.
+static window_manager_plus_v2::DisplayTopology display_topology;
+
+static const window_manager_plus_v2::DisplayTopology& get_display_topology() {
+  if (!display_topology.IsValid()) {
+    std::vector<window_manager_plus_v2::Display> displays;
+    GdkDisplay* display = gdk_display_get_default();
+    gint n_monitors = display != nullptr ? gdk_display_get_n_monitors(display)
+                                         : 0;
+    for (gint i = 0; i < n_monitors; i++) {
+      GdkMonitor* monitor = gdk_display_get_monitor(display, i);
+      GdkRectangle geometry, work_area;
+      gdk_monitor_get_geometry(monitor, &geometry);
+      gdk_monitor_get_workarea(monitor, &work_area);
+      const gchar* manufacturer = gdk_monitor_get_manufacturer(monitor);
+      const gchar* model = gdk_monitor_get_model(monitor);
+
+      window_manager_plus_v2::Display entry;
+      entry.id = get_monitor_id(monitor);
+      entry.name = model != nullptr ? model : "";
+      if (manufacturer != nullptr)
+        entry.name = std::string(manufacturer) + " " + entry.name;
+      entry.bounds = rect_from_gdk(geometry);
+      entry.work_area = rect_from_gdk(work_area);
+      entry.scale_factor = gdk_monitor_get_scale_factor(monitor);
+      entry.is_primary = gdk_monitor_is_primary(monitor);
+      displays.push_back(entry);
+    }
+    display_topology.Reset(std::move(displays));
   }
+  return display_topology;
+}
+
+static FlValue* size_to_value(const window_manager_plus_v2::Rect& rect) {
+  FlValue* size = fl_value_new_map();
+  fl_value_set_string_take(size, "width", fl_value_new_float(rect.width));
+  fl_value_set_string_take(size, "height", fl_value_new_float(rect.height));
+  return size;
+}
+
+static FlMethodResponse* get_displays(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result = fl_value_new_list();
+  for (const auto& display : get_display_topology().displays()) {
+    FlValue* value = fl_value_new_map();
+    fl_value_set_string_take(value, "id",
+                             fl_value_new_string(display.id.c_str()));
+    fl_value_set_string_take(value, "name",
+                             fl_value_new_string(display.name.c_str()));
+    fl_value_set_string_take(value, "size", size_to_value(display.bounds));
+    FlValue* visible_position = fl_value_new_map();
+    fl_value_set_string_take(visible_position, "dx",
+                             fl_value_new_float(display.work_area.x));
+    fl_value_set_string_take(visible_position, "dy",
+                             fl_value_new_float(display.work_area.y));
+    fl_value_set_string_take(value, "visiblePosition", visible_position);
+    fl_value_set_string_take(value, "visibleSize",
+                             size_to_value(display.work_area));
+    fl_value_set_string_take(value, "scaleFactor",
+                             fl_value_new_float(display.scale_factor));
+    fl_value_set_string_take(value, "isPrimary",
+                             fl_value_new_bool(display.is_primary));
+    fl_value_append_take(result, value);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* align(WindowManagerPlugin* self, FlValue* args) {
+  window_manager_plus_v2::AlignArgs alignment;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::AlignArgsSchema(), args, &alignment)) {
+    return error;
+  }
+  GtkWindow* window = get_window(self);
+  gint x, y, width, height;
+  gtk_window_get_position(window, &x, &y);
+  gtk_window_get_size(window, &width, &height);
+  const window_manager_plus_v2::Display* display =
+      get_display_topology().FindByRect({static_cast<double>(x),
+                                         static_cast<double>(y),
+                                         static_cast<double>(width),
+                                         static_cast<double>(height)});
+  if (display == nullptr) {
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("align", "No monitor found", nullptr));
+  }
+
+  window_manager_plus_v2::Point position = window_manager_plus_v2::AlignWithin(
+      display->work_area, width, height, alignment.x, alignment.y);
+  gtk_window_move(window, static_cast<gint>(position.x),
+                  static_cast<gint>(position.y));
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
@@ -295,9 +700,13 @@ static FlMethodResponse* set_bounds(WindowManagerPlugin* self, FlValue* args) {
 
 static FlMethodResponse* set_minimum_size(WindowManagerPlugin* self,
                                           FlValue* args) {
-  const float width = fl_value_get_float(fl_value_lookup_string(args, "width"));
-  const float height =
-      fl_value_get_float(fl_value_lookup_string(args, "height"));
+  window_manager_plus_v2::SizeArgs size;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::SizeArgsSchema(), args, &size)) {
+    return error;
+  }
+  const double width = size.width;
+  const double height = size.height;
 
   if (width >= 0 && height >= 0) {
     self->window_geometry.min_width = static_cast<gint>(width);
@@ -318,9 +727,13 @@ static FlMethodResponse* set_minimum_size(WindowManagerPlugin* self,
 
 static FlMethodResponse* set_maximum_size(WindowManagerPlugin* self,
                                           FlValue* args) {
-  const float width = fl_value_get_float(fl_value_lookup_string(args, "width"));
-  const float height =
-      fl_value_get_float(fl_value_lookup_string(args, "height"));
+  window_manager_plus_v2::SizeArgs size;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::SizeArgsSchema(), args, &size)) {
+    return error;
+  }
+  const double width = size.width;
+  const double height = size.height;
 
   self->window_geometry.max_width = static_cast<gint>(width);
   self->window_geometry.max_height = static_cast<gint>(height);
@@ -561,15 +974,993 @@ static FlMethodResponse* set_skip_taskbar(WindowManagerPlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-static FlMethodResponse* set_icon(WindowManagerPlugin* self, FlValue* args) {
-  const gchar* file_name =
-      fl_value_get_string(fl_value_lookup_string(args, "iconPath"));
-  const gboolean gtk_result =
-      gtk_window_set_icon_from_file(get_window(self), file_name, NULL);
-  g_autoptr(FlValue) result = fl_value_new_bool(gtk_result);
+// Sizes handed to the window manager, which picks the closest one for the
+// title bar, the task bar and the window switcher.
+static const gint kIconSizes[] = {16, 24, 32, 48, 64, 128, 256};
+
+// Past this many decoded icons the least recently used one is evicted.
+static const guint kIconCacheCapacity = 64;
+
+struct CachedIcon {
+  gint64 modification_time;
+  // Monotonic time of the last load of the icon.
+  gint64 last_used;
+  GList* pixbufs;
+};
+
+static void cached_icon_free(gpointer data) {
+  CachedIcon* icon = static_cast<CachedIcon*>(data);
+  g_list_free_full(icon->pixbufs, g_object_unref);
+  g_free(icon);
+}
+
+static GList* copy_pixbuf_list(GList* pixbufs) {
+  return g_list_copy_deep(pixbufs, reinterpret_cast<GCopyFunc>(g_object_ref),
+                          nullptr);
+}
+
+static void free_pixbuf_list(gpointer pixbufs) {
+  g_list_free_full(static_cast<GList*>(pixbufs), g_object_unref);
+}
+
+// Decoded icons of every window, keyed by path, shared by the workers.
+G_LOCK_DEFINE_STATIC(icon_cache);
+static GHashTable* icon_cache = nullptr;
+
+// Called with the icon_cache lock held. A linear scan is cheap at
+// kIconCacheCapacity entries, and only runs when decoding an icon.
+static void evict_least_recently_used_icon() {
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  gpointer oldest_key = nullptr;
+  gint64 oldest_time = G_MAXINT64;
+  g_hash_table_iter_init(&iter, icon_cache);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    gint64 last_used = static_cast<CachedIcon*>(value)->last_used;
+    if (last_used < oldest_time) {
+      oldest_time = last_used;
+      oldest_key = key;
+    }
+  }
+  if (oldest_key != nullptr)
+    g_hash_table_remove(icon_cache, oldest_key);
+}
+
+// One pixbuf per size of kIconSizes up to the size of the image, which is
+// never upscaled.
+static GList* decode_icon(const gchar* file_name, GError** error) {
+  g_autoptr(GdkPixbuf) pixbuf = gdk_pixbuf_new_from_file(file_name, error);
+  if (pixbuf == nullptr)
+    return nullptr;
+
+  gint width = gdk_pixbuf_get_width(pixbuf);
+  gint height = gdk_pixbuf_get_height(pixbuf);
+  gint image_size = MAX(width, height);
+  GList* pixbufs = nullptr;
+  for (gint size : kIconSizes) {
+    if (size >= image_size)
+      break;
+    GdkPixbuf* scaled = gdk_pixbuf_scale_simple(
+        pixbuf, MAX(1, width * size / image_size),
+        MAX(1, height * size / image_size), GDK_INTERP_BILINEAR);
+    pixbufs = g_list_append(pixbufs, scaled);
+  }
+  return g_list_append(pixbufs, g_object_ref(pixbuf));
+}
+
+// Runs on a worker thread: the main thread only installs the result.
+static void load_icon_thread(GTask* task,
+                             gpointer source_object,
+                             gpointer task_data,
+                             GCancellable* cancellable) {
+  const gchar* file_name = static_cast<const gchar*>(task_data);
+  GError* error = nullptr;
+
+  g_autoptr(GFile) file = g_file_new_for_path(file_name);
+  g_autoptr(GFileInfo) info = g_file_query_info(
+      file,
+      G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+      G_FILE_QUERY_INFO_NONE, cancellable, &error);
+  if (info == nullptr) {
+    g_task_return_error(task, error);
+    return;
+  }
+  gint64 modification_time =
+      g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED) *
+          G_USEC_PER_SEC +
+      g_file_info_get_attribute_uint32(info,
+                                       G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  G_LOCK(icon_cache);
+  CachedIcon* cached =
+      icon_cache != nullptr
+          ? static_cast<CachedIcon*>(g_hash_table_lookup(icon_cache, file_name))
+          : nullptr;
+  GList* pixbufs = nullptr;
+  if (cached != nullptr && cached->modification_time == modification_time) {
+    cached->last_used = g_get_monotonic_time();
+    pixbufs = copy_pixbuf_list(cached->pixbufs);
+  }
+  G_UNLOCK(icon_cache);
+  if (pixbufs != nullptr) {
+    g_task_return_pointer(task, pixbufs, free_pixbuf_list);
+    return;
+  }
+
+  pixbufs = decode_icon(file_name, &error);
+  if (pixbufs == nullptr) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  CachedIcon* icon = g_new(CachedIcon, 1);
+  icon->modification_time = modification_time;
+  icon->last_used = g_get_monotonic_time();
+  icon->pixbufs = copy_pixbuf_list(pixbufs);
+  G_LOCK(icon_cache);
+  if (icon_cache == nullptr) {
+    icon_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                       cached_icon_free);
+  } else if (!g_hash_table_contains(icon_cache, file_name) &&
+             g_hash_table_size(icon_cache) >= kIconCacheCapacity) {
+    evict_least_recently_used_icon();
+  }
+  g_hash_table_replace(icon_cache, g_strdup(file_name), icon);
+  G_UNLOCK(icon_cache);
+
+  g_task_return_pointer(task, pixbufs, free_pixbuf_list);
+}
+
+static void on_icon_loaded(GObject* source_object,
+                           GAsyncResult* result,
+                           gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(source_object);
+  g_autoptr(FlMethodCall) method_call = FL_METHOD_CALL(user_data);
+  g_autoptr(GError) error = nullptr;
+  GList* pixbufs = static_cast<GList*>(
+      g_task_propagate_pointer(G_TASK(result), &error));
+  if (pixbufs != nullptr &&
+      GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(result), "generation")) ==
+          self->icon_generation) {
+    gtk_window_set_icon_list(get_window(self), pixbufs);
+  }
+  free_pixbuf_list(pixbufs);
+
+  if (error != nullptr) {
+    fl_method_call_respond_error(method_call, "setIcon", error->message,
+                                 nullptr, nullptr);
+    return;
+  }
+  g_autoptr(FlValue) value = fl_value_new_bool(true);
+  fl_method_call_respond_success(method_call, value, nullptr);
+}
+
+// Responds once the icon is decoded, off the main thread.
+static void set_icon(WindowManagerPlugin* self,
+                     FlMethodCall* method_call,
+                     FlValue* args) {
+  window_manager_plus_v2::IconArgs icon_args;
+  g_autoptr(FlMethodResponse) error = decode_args(
+      window_manager_plus_v2::IconArgsSchema(), args, &icon_args);
+  if (error != nullptr) {
+    fl_method_call_respond(method_call, error, nullptr);
+    return;
+  }
+
+  g_autoptr(GTask) task =
+      g_task_new(self, nullptr, on_icon_loaded, g_object_ref(method_call));
+  g_object_set_data(G_OBJECT(task), "generation",
+                    GUINT_TO_POINTER(++self->icon_generation));
+  g_task_set_task_data(task, g_strdup(icon_args.icon_path.c_str()), g_free);
+  g_task_run_in_thread(task, load_icon_thread);
+}
+
+static void unref_value(guchar* pixels, gpointer value) {
+  fl_value_unref(static_cast<FlValue*>(value));
+}
+
+// Wraps the bytes of the method call without copying them, the value stays
+// alive as long as the pixbuf or the stream needs it. Raw pixels are
+// straight-alpha RGBA, anything else goes through the image loaders. Fails
+// with G_IO_ERROR_INVALID_ARGUMENT when |bytes| isn't a Uint8List.
+static GdkPixbuf* pixbuf_from_value(FlValue* bytes,
+                                    FlValue* width,
+                                    FlValue* height,
+                                    GError** error) {
+  if (bytes == nullptr ||
+      fl_value_get_type(bytes) != FL_VALUE_TYPE_UINT8_LIST) {
+    g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                        "Argument 'bytes' must be a Uint8List");
+    return nullptr;
+  }
+  const uint8_t* data = fl_value_get_uint8_list(bytes);
+  size_t length = fl_value_get_length(bytes);
+  if (width != nullptr && fl_value_get_type(width) == FL_VALUE_TYPE_INT &&
+      height != nullptr && fl_value_get_type(height) == FL_VALUE_TYPE_INT) {
+    gint64 pixels_width = fl_value_get_int(width);
+    gint64 pixels_height = fl_value_get_int(height);
+    if (pixels_width <= 0 || pixels_height <= 0 ||
+        pixels_width > G_MAXINT / 4 || pixels_height > G_MAXINT ||
+        static_cast<size_t>(pixels_width * pixels_height * 4) != length) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Expected %" G_GINT64_FORMAT " x %" G_GINT64_FORMAT
+                  " RGBA pixels",
+                  pixels_width, pixels_height);
+      return nullptr;
+    }
+    return gdk_pixbuf_new_from_data(
+        const_cast<guchar*>(data), GDK_COLORSPACE_RGB, TRUE, 8,
+        static_cast<gint>(pixels_width), static_cast<gint>(pixels_height),
+        static_cast<gint>(pixels_width * 4), unref_value, fl_value_ref(bytes));
+  }
+
+  g_autoptr(GBytes) encoded = g_bytes_new_with_free_func(
+      data, length, reinterpret_cast<GDestroyNotify>(fl_value_unref),
+      fl_value_ref(bytes));
+  g_autoptr(GInputStream) stream =
+      g_memory_input_stream_new_from_bytes(encoded);
+  return gdk_pixbuf_new_from_stream(stream, nullptr, error);
+}
+
+// Runs |kernel| over the rows of the 8-bit RGBA |pixbuf|.
+static void for_each_pixbuf_row(GdkPixbuf* pixbuf,
+                                void (*kernel)(uint8_t*, size_t)) {
+  guchar* pixels = gdk_pixbuf_get_pixels(pixbuf);
+  gint rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+  for (gint y = 0; y < gdk_pixbuf_get_height(pixbuf); y++) {
+    kernel(pixels + static_cast<size_t>(y) * rowstride,
+           gdk_pixbuf_get_width(pixbuf));
+  }
+}
+
+// The image and its successive halvings down to the smallest icon size,
+// with the SIMD box filter for RGBA pixbufs. Those are halved premultiplied
+// so that transparent pixels don't darken the edges.
+static GList* icon_mipmaps(GdkPixbuf* pixbuf) {
+  GList* pixbufs = g_list_prepend(nullptr, g_object_ref(pixbuf));
+  GdkPixbuf* current = pixbuf;
+  gint width = gdk_pixbuf_get_width(current);
+  gint height = gdk_pixbuf_get_height(current);
+  g_autoptr(GdkPixbuf) premultiplied = nullptr;
+  if (gdk_pixbuf_get_n_channels(current) == 4 &&
+      gdk_pixbuf_get_bits_per_sample(current) == 8) {
+    premultiplied = gdk_pixbuf_copy(current);
+    for_each_pixbuf_row(premultiplied, window_manager_plus_v2::Premultiply);
+  }
+  while (MAX(width, height) / 2 >= kIconSizes[0] && MIN(width, height) >= 2) {
+    GdkPixbuf* half;
+    if (premultiplied != nullptr) {
+      GdkPixbuf* next =
+          gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width / 2, height / 2);
+      window_manager_plus_v2::HalveImage(
+          gdk_pixbuf_read_pixels(premultiplied),
+          gdk_pixbuf_get_rowstride(premultiplied), width, height,
+          gdk_pixbuf_get_pixels(next), gdk_pixbuf_get_rowstride(next));
+      g_object_unref(premultiplied);
+      premultiplied = next;
+      half = gdk_pixbuf_copy(next);
+      for_each_pixbuf_row(half, window_manager_plus_v2::Unpremultiply);
+    } else {
+      half = gdk_pixbuf_scale_simple(current, width / 2, height / 2,
+                                     GDK_INTERP_BILINEAR);
+    }
+    pixbufs = g_list_prepend(pixbufs, half);
+    current = half;
+    width /= 2;
+    height /= 2;
+  }
+  return pixbufs;
+}
+
+static FlMethodResponse* set_icon_from_bytes(WindowManagerPlugin* self,
+                                             FlValue* args) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GdkPixbuf) pixbuf = pixbuf_from_value(
+      fl_value_lookup_string(args, "bytes"),
+      fl_value_lookup_string(args, "width"),
+      fl_value_lookup_string(args, "height"), &error);
+  if (pixbuf == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)
+            ? "invalid_argument"
+            : "setIconFromBytes",
+        error->message, nullptr));
+  }
+
+  GList* pixbufs = icon_mipmaps(pixbuf);
+  // A file icon still decoding must not replace this one.
+  self->icon_generation++;
+  gtk_window_set_icon_list(get_window(self), pixbufs);
+  free_pixbuf_list(pixbufs);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Grabs the window at its physical resolution into an image surface, in
+// premultiplied BGRA, i.e. native-endian ARGB32. Returns nullptr on failure.
+static cairo_surface_t* capture_surface(GdkWindow* window) {
+  gint scale = gdk_window_get_scale_factor(window);
+  cairo_surface_t* surface = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32, gdk_window_get_width(window) * scale,
+      gdk_window_get_height(window) * scale);
+  cairo_surface_set_device_scale(surface, scale, scale);
+  cairo_t* cr = cairo_create(surface);
+  gdk_cairo_set_source_window(cr, window, 0, 0);
+  cairo_paint(cr);
+  cairo_destroy(cr);
+  cairo_surface_flush(surface);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS ||
+      cairo_image_surface_get_data(surface) == nullptr) {
+    cairo_surface_destroy(surface);
+    return nullptr;
+  }
+  return surface;
+}
+
+// The capture is converted in place to the format asked for before it's
+// copied into the response.
+static FlMethodResponse* capture_window(WindowManagerPlugin* self,
+                                        FlValue* args) {
+  window_manager_plus_v2::CaptureArgs capture;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::CaptureArgsSchema(), args, &capture)) {
+    return error;
+  }
+  GdkWindow* window = get_gdk_window(self);
+  if (window == nullptr || !gdk_window_is_viewable(window)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "captureWindow", "Window is not visible", nullptr));
+  }
+
+  cairo_surface_t* surface = capture_surface(window);
+  if (surface == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "captureWindow", "Failed to capture the window", nullptr));
+  }
+  // ARGB32 rows are never padded, the surface is one run of pixels.
+  uint8_t* pixels = cairo_image_surface_get_data(surface);
+  gint width = cairo_image_surface_get_width(surface);
+  gint height = cairo_image_surface_get_height(surface);
+  size_t count = static_cast<size_t>(width) * height;
+  if (capture.is_rgba()) {
+    window_manager_plus_v2::SwapRedBlue(pixels, pixels, count);
+  }
+  if (!capture.premultiplied_alpha.value_or(false)) {
+    window_manager_plus_v2::Unpremultiply(pixels, count);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "width", fl_value_new_int(width));
+  fl_value_set_string_take(result, "height", fl_value_new_int(height));
+  fl_value_set_string_take(result, "bytes",
+                           fl_value_new_uint8_list(pixels, count * 4));
+  cairo_surface_destroy(surface);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Keeps downscaled previews of every window of the process for a single
+// subscriber, e.g. a window switcher. Each tick only captures the windows
+// drawn since the previous one, or not refreshed for |max_stale_ticks|, and
+// sends the previews that changed in one batched message.
+struct ThumbnailService {
+  WindowManagerPlugin* subscriber = nullptr;
+  guint timer_id = 0;
+  gint max_width = 0;
+  gint max_height = 0;
+  // 0 never refreshes windows that were not drawn.
+  guint max_stale_ticks = 0;
+  // The windows of the last message, sent again when they change so that
+  // the subscriber drops the previews of closed windows.
+  std::vector<gint64> window_ids;
+  // Set once a batch could not be sent right away, so may be replaced by
+  // the next one, which then carries every preview.
+  bool is_resending_all = false;
+};
+
+static ThumbnailService thumbnail_service;
+
+static gboolean on_window_draw(GtkWidget* widget, cairo_t* cr, gpointer data) {
+  WINDOW_MANAGER_PLUGIN(data)->thumbnail_dirty = true;
+  return FALSE;
+}
+
+// Whether the thumbnail of |plugin| is due this tick.
+static bool is_thumbnail_due(WindowManagerPlugin* plugin) {
+  if (plugin->thumbnail == nullptr) {
+    plugin->thumbnail = new window_manager_plus_v2::Thumbnail();
+    return true;
+  }
+  plugin->thumbnail_age++;
+  return plugin->thumbnail_dirty ||
+         (thumbnail_service.max_stale_ticks > 0 &&
+          plugin->thumbnail_age >= thumbnail_service.max_stale_ticks);
+}
+
+static gboolean on_thumbnail_tick(gpointer data) {
+  window_manager_plus_v2::ThumbnailBatch batch;
+  std::vector<gint64> window_ids;
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+    window_ids.push_back(plugin->window_id);
+    if (!is_thumbnail_due(plugin)) {
+      continue;
+    }
+    // Hidden and minimized windows keep their last preview.
+    GdkWindow* window = get_gdk_window(plugin);
+    if (window == nullptr || !gdk_window_is_viewable(window) ||
+        (gdk_window_get_state(window) & GDK_WINDOW_STATE_ICONIFIED)) {
+      continue;
+    }
+    cairo_surface_t* surface = capture_surface(window);
+    if (surface == nullptr) {
+      continue;
+    }
+    plugin->thumbnail_dirty = false;
+    plugin->thumbnail_age = 0;
+    if (window_manager_plus_v2::UpdateThumbnail(
+            cairo_image_surface_get_data(surface),
+            cairo_image_surface_get_stride(surface),
+            cairo_image_surface_get_width(surface),
+            cairo_image_surface_get_height(surface), true,
+            thumbnail_service.max_width, thumbnail_service.max_height,
+            plugin->thumbnail)) {
+      batch.Add(plugin->window_id, *plugin->thumbnail);
+    }
+    cairo_surface_destroy(surface);
+  }
+  if (thumbnail_service.is_resending_all) {
+    batch = window_manager_plus_v2::ThumbnailBatch();
+    for (GList* l = plugins; l != nullptr; l = l->next) {
+      WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+      if (plugin->thumbnail != nullptr && !plugin->thumbnail->pixels.empty()) {
+        batch.Add(plugin->window_id, *plugin->thumbnail);
+      }
+    }
+  }
+  if (batch.IsEmpty() && window_ids == thumbnail_service.window_ids) {
+    return G_SOURCE_CONTINUE;
+  }
+  thumbnail_service.window_ids = window_ids;
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(
+      args, "windowIds",
+      fl_value_new_int64_list(window_ids.data(), window_ids.size()));
+  fl_value_set_string_take(
+      args, "index",
+      fl_value_new_int64_list(batch.index.data(), batch.index.size()));
+  fl_value_set_string_take(
+      args, "pixels",
+      fl_value_new_uint8_list(batch.pixels.data(), batch.pixels.size()));
+  thumbnail_service.is_resending_all =
+      !push_event(thumbnail_service.subscriber, "thumbnails", "thumbnails",
+                  "onThumbnails", args);
+  return G_SOURCE_CONTINUE;
+}
+
+static void stop_thumbnail_service() {
+  if (thumbnail_service.timer_id != 0) {
+    g_source_remove(thumbnail_service.timer_id);
+  }
+  thumbnail_service.timer_id = 0;
+  thumbnail_service.subscriber = nullptr;
+  thumbnail_service.window_ids.clear();
+  thumbnail_service.is_resending_all = false;
+  // The next subscriber gets every preview again.
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+    delete plugin->thumbnail;
+    plugin->thumbnail = nullptr;
+  }
+}
+
+static FlMethodResponse* set_thumbnail_options(WindowManagerPlugin* self,
+                                               FlValue* args) {
+  window_manager_plus_v2::ThumbnailOptionsArgs options;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::ThumbnailOptionsArgsSchema(), args,
+          &options)) {
+    return error;
+  }
+  if (!options.enabled) {
+    if (thumbnail_service.subscriber == self) {
+      stop_thumbnail_service();
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(true);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  stop_thumbnail_service();
+  thumbnail_service.subscriber = self;
+  thumbnail_service.max_width =
+      static_cast<gint>(MIN(options.max_width, G_MAXINT));
+  thumbnail_service.max_height =
+      static_cast<gint>(MIN(options.max_height, G_MAXINT));
+  thumbnail_service.max_stale_ticks =
+      static_cast<guint>(MIN(options.max_stale_ticks, G_MAXUINT));
+  thumbnail_service.timer_id = g_timeout_add(
+      static_cast<guint>(
+          CLAMP(options.interval,
+                window_manager_plus_v2::kMinThumbnailIntervalMs, G_MAXUINT)),
+      on_thumbnail_tick, nullptr);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Delay after the last configure-event before the geometry is saved, so that
+// a move or resize gesture is written once when it ends.
+static const guint kGeometrySaveDelayMs = 500;
+
+static const gchar* kGeometryStoreFile = "window_geometry.ini";
+static const gchar* kLayoutStoreFile = "window_layouts.ini";
+
+static gchar* get_store_path(const gchar* file_name) {
+  const gchar* name = g_get_prgname();
+  return g_build_filename(g_get_user_config_dir(),
+                          name != nullptr ? name : "flutter", file_name,
+                          nullptr);
+}
+
+static void read_store(WindowGeometryStore& store, const gchar* file_name) {
+  g_autofree gchar* path = get_store_path(file_name);
+  g_autofree gchar* contents = nullptr;
+  if (g_file_get_contents(path, &contents, nullptr, nullptr)) {
+    store.Parse(contents);
+  }
+}
+
+static void write_store(const WindowGeometryStore& store,
+                        const gchar* file_name) {
+  // g_file_set_contents() writes a temporary file and renames it over the
+  // old one, so a crash never leaves a truncated file behind.
+  g_autofree gchar* path = get_store_path(file_name);
+  g_autofree gchar* directory = g_path_get_dirname(path);
+  g_autoptr(GError) error = nullptr;
+  if (g_mkdir_with_parents(directory, 0700) != 0) {
+    g_warning("Failed to create %s", directory);
+  } else if (!g_file_set_contents(path, store.Serialize().c_str(), -1,
+                                  &error)) {
+    g_warning("Failed to save %s: %s", file_name, error->message);
+  }
+}
+
+// The geometry of every window of the process is kept in one small file.
+static WindowGeometryStore& get_geometry_store() {
+  static WindowGeometryStore store;
+  static bool is_loaded = false;
+  if (!is_loaded) {
+    is_loaded = true;
+    read_store(store, kGeometryStoreFile);
+  }
+  return store;
+}
+
+static WindowGeometryStore& get_layout_store() {
+  static WindowGeometryStore store;
+  static bool is_loaded = false;
+  if (!is_loaded) {
+    is_loaded = true;
+    read_store(store, kLayoutStoreFile);
+  }
+  return store;
+}
+
+// Remembers the bounds to persist while the window is in its normal state.
+static void update_normal_bounds(WindowManagerPlugin* self) {
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window != nullptr &&
+      (gdk_window_get_state(gdk_window) &
+       (GDK_WINDOW_STATE_MAXIMIZED | GDK_WINDOW_STATE_FULLSCREEN |
+        GDK_WINDOW_STATE_ICONIFIED)) != 0) {
+    return;
+  }
+  gtk_window_get_position(get_window(self), &self->normal_bounds.x,
+                          &self->normal_bounds.y);
+  gtk_window_get_size(get_window(self), &self->normal_bounds.width,
+                      &self->normal_bounds.height);
+}
+
+// Reads the current state of the window, with its normal bounds.
+static bool get_window_geometry(WindowManagerPlugin* self,
+                                WindowGeometry* geometry) {
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window == nullptr || self->normal_bounds.width <= 0)
+    return false;
+
+  GdkWindowState state = gdk_window_get_state(gdk_window);
+  geometry->x = self->normal_bounds.x;
+  geometry->y = self->normal_bounds.y;
+  geometry->width = self->normal_bounds.width;
+  geometry->height = self->normal_bounds.height;
+  geometry->maximized = (state & GDK_WINDOW_STATE_MAXIMIZED) != 0;
+  geometry->full_screen = (state & GDK_WINDOW_STATE_FULLSCREEN) != 0;
+  geometry->visible = gtk_widget_get_visible(GTK_WIDGET(get_window(self)));
+  geometry->always_on_top = (state & GDK_WINDOW_STATE_ABOVE) != 0;
+  geometry->monitor = get_monitor_id(gdk_display_get_monitor_at_window(
+      gdk_window_get_display(gdk_window), gdk_window));
+  return true;
+}
+
+static void save_window_geometry(WindowManagerPlugin* self) {
+  g_clear_handle_id(&self->geometry_save_id, g_source_remove);
+  WindowGeometry geometry;
+  if (self->geometry_key == nullptr || !get_window_geometry(self, &geometry))
+    return;
+
+  WindowGeometryStore& store = get_geometry_store();
+  if (store.Set(self->geometry_key, geometry))
+    write_store(store, kGeometryStoreFile);
+}
+
+static gboolean on_save_geometry_timeout(gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  self->geometry_save_id = 0;
+  save_window_geometry(self);
+  return G_SOURCE_REMOVE;
+}
+
+static void schedule_geometry_save(WindowManagerPlugin* self) {
+  if (self->geometry_key == nullptr)
+    return;
+  g_clear_handle_id(&self->geometry_save_id, g_source_remove);
+  self->geometry_save_id =
+      g_timeout_add(kGeometrySaveDelayMs, on_save_geometry_timeout, self);
+}
+
+static void restore_window_geometry(WindowManagerPlugin* self) {
+  const WindowGeometry* geometry =
+      get_geometry_store().Find(self->geometry_key);
+  if (geometry == nullptr || geometry->width <= 0 || geometry->height <= 0)
+    return;
+
+  GtkWindow* window = get_window(self);
+  gtk_window_resize(window, static_cast<gint>(geometry->width),
+                    static_cast<gint>(geometry->height));
+
+  // Only reuse the position if it still lands on the monitor it was saved
+  // on, otherwise the window could end up off-screen after a display change.
+  gint center_x = static_cast<gint>(geometry->x + geometry->width / 2);
+  gint center_y = static_cast<gint>(geometry->y + geometry->height / 2);
+  GdkMonitor* monitor = gdk_display_get_monitor_at_point(
+      gtk_widget_get_display(GTK_WIDGET(window)), center_x, center_y);
+  if (monitor != nullptr) {
+    GdkRectangle area;
+    gdk_monitor_get_geometry(monitor, &area);
+    if (center_x >= area.x && center_x < area.x + area.width &&
+        center_y >= area.y && center_y < area.y + area.height &&
+        get_monitor_id(monitor) == geometry->monitor) {
+      gtk_window_move(window, static_cast<gint>(geometry->x),
+                      static_cast<gint>(geometry->y));
+    }
+  }
+
+  if (geometry->maximized)
+    gtk_window_maximize(window);
+  if (geometry->full_screen)
+    gtk_window_fullscreen(window);
+
+  update_normal_bounds(self);
+}
+
+static FlMethodResponse* set_geometry_persistence_key(WindowManagerPlugin* self,
+                                                      FlValue* args) {
+  FlValue* key = fl_value_lookup_string(args, "key");
+  const gchar* new_key = key != nullptr &&
+                                 fl_value_get_type(key) == FL_VALUE_TYPE_STRING
+                             ? fl_value_get_string(key)
+                             : nullptr;
+  if (new_key != nullptr && !WindowGeometryStore::IsValidKey(new_key)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "setGeometryPersistenceKey", "Invalid geometry persistence key",
+        nullptr));
+  }
+
+  g_clear_handle_id(&self->geometry_save_id, g_source_remove);
+  g_free(self->geometry_key);
+  self->geometry_key = g_strdup(new_key);
+  if (self->geometry_key != nullptr) {
+    update_normal_bounds(self);
+    restore_window_geometry(self);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static const gchar* get_layout_name(FlValue* args) {
+  FlValue* name = fl_value_lookup_string(args, "name");
+  if (name == nullptr || fl_value_get_type(name) != FL_VALUE_TYPE_STRING ||
+      !window_manager_plus_v2::IsValidLayoutName(fl_value_get_string(name))) {
+    return nullptr;
+  }
+  return fl_value_get_string(name);
+}
+
+static FlMethodResponse* save_layout(WindowManagerPlugin* self,
+                                     FlValue* args) {
+  const gchar* name = get_layout_name(args);
+  if (name == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "saveLayout", "Invalid layout name", nullptr));
+  }
+
+  WindowLayout layout;
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+    update_normal_bounds(plugin);
+    WindowGeometry geometry;
+    if (get_window_geometry(plugin, &geometry))
+      layout[plugin->window_id] = geometry;
+  }
+
+  WindowGeometryStore& store = get_layout_store();
+  if (window_manager_plus_v2::SetLayout(store, name, layout))
+    write_store(store, kLayoutStoreFile);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "windowCount",
+                           fl_value_new_int(layout.size()));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Updates of every window are frozen while several windows are rearranged,
+// so that no intermediate arrangement is painted.
+static void freeze_window_updates(bool is_frozen) {
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    GdkWindow* gdk_window = get_gdk_window(WINDOW_MANAGER_PLUGIN(l->data));
+    if (gdk_window == nullptr)
+      continue;
+    if (is_frozen)
+      gdk_window_freeze_updates(gdk_window);
+    else
+      gdk_window_thaw_updates(gdk_window);
+  }
+}
+
+static FlMethodResponse* apply_layout(WindowManagerPlugin* self,
+                                      FlValue* args) {
+  gint64 start = g_get_monotonic_time();
+  const gchar* name = get_layout_name(args);
+  WindowLayout layout;
+  if (name != nullptr)
+    layout = window_manager_plus_v2::FindLayout(get_layout_store(), name);
+  if (layout.empty()) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "applyLayout", "Unknown layout", nullptr));
+  }
+
+  freeze_window_updates(true);
+
+  gint64 window_count = 0;
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+    auto it = layout.find(plugin->window_id);
+    GdkWindow* gdk_window = get_gdk_window(plugin);
+    if (it == layout.end() || gdk_window == nullptr)
+      continue;
+
+    const WindowGeometry& geometry = it->second;
+    GtkWindow* window = get_window(plugin);
+    GdkWindowState state = gdk_window_get_state(gdk_window);
+    if ((state & GDK_WINDOW_STATE_FULLSCREEN) && !geometry.full_screen)
+      gtk_window_unfullscreen(window);
+    if ((state & GDK_WINDOW_STATE_MAXIMIZED) && !geometry.maximized)
+      gtk_window_unmaximize(window);
+    gtk_window_move(window, static_cast<gint>(geometry.x),
+                    static_cast<gint>(geometry.y));
+    gtk_window_resize(window, static_cast<gint>(geometry.width),
+                      static_cast<gint>(geometry.height));
+    gtk_window_set_keep_above(window, geometry.always_on_top);
+    plugin->_is_always_on_top = geometry.always_on_top;
+    if (geometry.maximized)
+      gtk_window_maximize(window);
+    if (geometry.full_screen)
+      gtk_window_fullscreen(window);
+    if (geometry.visible)
+      gtk_widget_show(GTK_WIDGET(window));
+    else
+      gtk_widget_hide(GTK_WIDGET(window));
+    window_count++;
+  }
+
+  freeze_window_updates(false);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "windowCount",
+                           fl_value_new_int(window_count));
+  fl_value_set_string_take(result, "elapsedMicros",
+                           fl_value_new_int(g_get_monotonic_time() - start));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static WindowManagerPlugin* find_plugin(gint64 window_id) {
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(l->data);
+    if (plugin->window_id == window_id)
+      return plugin;
+  }
+  return nullptr;
+}
+
+static window_manager_plus_v2::TileConstraints get_tile_constraints(
+    WindowManagerPlugin* self) {
+  window_manager_plus_v2::TileConstraints constraints;
+  if (self->window_hints & GDK_HINT_MIN_SIZE) {
+    constraints.min_width = self->window_geometry.min_width;
+    constraints.min_height = self->window_geometry.min_height;
+  }
+  if (self->window_hints & GDK_HINT_MAX_SIZE) {
+    constraints.max_width = self->window_geometry.max_width;
+    constraints.max_height = self->window_geometry.max_height;
+  }
+  if (self->window_hints & GDK_HINT_ASPECT)
+    constraints.aspect_ratio = self->window_geometry.min_aspect;
+  return constraints;
+}
+
+static FlMethodResponse* tile_windows(WindowManagerPlugin* self,
+                                      FlValue* args) {
+  gint64 start = g_get_monotonic_time();
+  window_manager_plus_v2::TileWindowsArgs tile_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::TileWindowsArgsSchema(), args, &tile_args)) {
+    return error;
+  }
+  window_manager_plus_v2::TilingOptions options = tile_args.tiling_options();
+
+  std::vector<WindowManagerPlugin*> windows;
+  std::vector<window_manager_plus_v2::TileConstraints> constraints;
+  for (int64_t window_id : tile_args.unique_window_ids()) {
+    WindowManagerPlugin* plugin = find_plugin(window_id);
+    if (plugin == nullptr || get_gdk_window(plugin) == nullptr)
+      continue;
+    windows.push_back(plugin);
+    constraints.push_back(get_tile_constraints(plugin));
+  }
+
+  const window_manager_plus_v2::DisplayTopology& topology =
+      get_display_topology();
+  const window_manager_plus_v2::Display* display = nullptr;
+  if (windows.empty()) {
+    // Nothing to tile.
+  } else if (tile_args.display_id) {
+    for (const auto& candidate : topology.displays()) {
+      if (candidate.id == *tile_args.display_id)
+        display = &candidate;
+    }
+  } else {
+    gint x, y, width, height;
+    gtk_window_get_position(get_window(windows.front()), &x, &y);
+    gtk_window_get_size(get_window(windows.front()), &width, &height);
+    display = topology.FindByRect(
+        {static_cast<double>(x), static_cast<double>(y),
+         static_cast<double>(width), static_cast<double>(height)});
+  }
+  if (display == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "tileWindows", "No window or display to tile", nullptr));
+  }
+
+  std::vector<window_manager_plus_v2::Rect> tiles =
+      window_manager_plus_v2::SolveTiling(display->work_area, constraints,
+                                          options);
+  gint64 solved = g_get_monotonic_time();
+
+  freeze_window_updates(true);
+  for (size_t i = 0; i < windows.size(); i++) {
+    GtkWindow* window = get_window(windows[i]);
+    GdkWindowState state = gdk_window_get_state(get_gdk_window(windows[i]));
+    if (state & GDK_WINDOW_STATE_FULLSCREEN)
+      gtk_window_unfullscreen(window);
+    if (state & GDK_WINDOW_STATE_MAXIMIZED)
+      gtk_window_unmaximize(window);
+    gtk_window_move(window, static_cast<gint>(tiles[i].x),
+                    static_cast<gint>(tiles[i].y));
+    gtk_window_resize(window, static_cast<gint>(tiles[i].width),
+                      static_cast<gint>(tiles[i].height));
+  }
+  freeze_window_updates(false);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "windowCount",
+                           fl_value_new_int(windows.size()));
+  fl_value_set_string_take(result, "solveMicros",
+                           fl_value_new_int(solved - start));
+  fl_value_set_string_take(result, "elapsedMicros",
+                           fl_value_new_int(g_get_monotonic_time() - start));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* set_parent_window(WindowManagerPlugin* self,
+                                           FlValue* args) {
+  window_manager_plus_v2::ParentWindowArgs parent_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::ParentWindowArgsSchema(), args,
+          &parent_args)) {
+    return error;
+  }
+  if (!parent_args.parent_id) {
+    self->parent_id = -1;
+    g_autoptr(FlValue) result = fl_value_new_bool(true);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  // Refuse cycles, moving a window would move it again.
+  gint64 new_parent_id = *parent_args.parent_id;
+  WindowManagerPlugin* parent = find_plugin(new_parent_id);
+  for (gint64 ancestor = new_parent_id; ancestor != -1;) {
+    WindowManagerPlugin* plugin = find_plugin(ancestor);
+    if (plugin == nullptr || plugin == self) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "setParentWindow", "Invalid parent window", nullptr));
+    }
+    ancestor = plugin->parent_id;
+  }
+
+  gint parent_x, parent_y;
+  gtk_window_get_position(get_window(parent), &parent_x, &parent_y);
+  if (parent_args.offset_x && parent_args.offset_y) {
+    self->parent_offset.x = static_cast<gint>(*parent_args.offset_x);
+    self->parent_offset.y = static_cast<gint>(*parent_args.offset_y);
+  } else {
+    gint x, y;
+    gtk_window_get_position(get_window(self), &x, &y);
+    self->parent_offset.x = x - parent_x;
+    self->parent_offset.y = y - parent_y;
+  }
+  self->_is_minimized_with_parent = parent_args.minimize_with_parent;
+  self->parent_id = new_parent_id;
+  gtk_window_move(get_window(self), parent_x + self->parent_offset.x,
+                  parent_y + self->parent_offset.y);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Called from the parent's configure-event, so that the children follow it
+// without going through Dart.
+static void move_child_windows(WindowManagerPlugin* self) {
+  gint x, y;
+  gtk_window_get_position(get_window(self), &x, &y);
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* child = WINDOW_MANAGER_PLUGIN(l->data);
+    GdkWindow* gdk_window = get_gdk_window(child);
+    if (child->parent_id != self->window_id || child == self ||
+        gdk_window == nullptr ||
+        (gdk_window_get_state(gdk_window) &
+         (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_MAXIMIZED |
+          GDK_WINDOW_STATE_FULLSCREEN)) != 0) {
+      continue;
+    }
+    gint child_x, child_y;
+    gtk_window_get_position(get_window(child), &child_x, &child_y);
+    if (child_x != x + child->parent_offset.x ||
+        child_y != y + child->parent_offset.y) {
+      gtk_window_move(get_window(child), x + child->parent_offset.x,
+                      y + child->parent_offset.y);
+    }
+  }
+}
+
+static void set_child_windows_iconified(WindowManagerPlugin* self,
+                                        bool is_iconified) {
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* child = WINDOW_MANAGER_PLUGIN(l->data);
+    if (child->parent_id != self->window_id || child == self ||
+        !child->_is_minimized_with_parent ||
+        !gtk_widget_get_visible(GTK_WIDGET(get_window(child)))) {
+      continue;
+    }
+    if (is_iconified)
+      gtk_window_iconify(get_window(child));
+    else
+      gtk_window_deiconify(get_window(child));
+  }
+}
+
 static FlMethodResponse* get_opacity(WindowManagerPlugin* self) {
   gdouble opacity = gtk_widget_get_opacity(GTK_WIDGET(get_window(self)));
   g_autoptr(FlValue) result = fl_value_new_float(opacity);
@@ -577,8 +1968,12 @@ static FlMethodResponse* get_opacity(WindowManagerPlugin* self) {
 }
 
 static FlMethodResponse* set_opacity(WindowManagerPlugin* self, FlValue* args) {
-  gdouble opacity = fl_value_get_float(fl_value_lookup_string(args, "opacity"));
-  gtk_widget_set_opacity(GTK_WIDGET(get_window(self)), opacity);
+  window_manager_plus_v2::OpacityArgs opacity;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::OpacityArgsSchema(), args, &opacity)) {
+    return error;
+  }
+  gtk_widget_set_opacity(GTK_WIDGET(get_window(self)), opacity.opacity);
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
@@ -608,6 +2003,468 @@ static FlMethodResponse* pop_up_window_menu(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+static FlMethodResponse* set_snapping(WindowManagerPlugin* self,
+                                      FlValue* args) {
+  window_manager_plus_v2::SnappingArgs snapping;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::SnappingArgsSchema(), args, &snapping)) {
+    return error;
+  }
+  self->snap_distance = snapping.is_snapping ? snapping.distance : 0;
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Indexes the work areas and the other windows once per drag, they do not
+// move meanwhile.
+static void build_snap_index(WindowManagerPlugin* self) {
+  if (self->snapper == nullptr)
+    self->snapper = new window_manager_plus_v2::EdgeSnapper();
+  self->snapper->Clear();
+
+  for (const window_manager_plus_v2::Display& display :
+       get_display_topology().displays()) {
+    self->snapper->AddRect(display.work_area);
+  }
+  for (GList* l = plugins; l != nullptr; l = l->next) {
+    WindowManagerPlugin* other = WINDOW_MANAGER_PLUGIN(l->data);
+    GdkWindow* gdk_window = get_gdk_window(other);
+    // The children follow this window, they are not obstacles.
+    if (other == self || other->parent_id == self->window_id ||
+        gdk_window == nullptr ||
+        !gtk_widget_get_visible(GTK_WIDGET(get_window(other))) ||
+        (gdk_window_get_state(gdk_window) & GDK_WINDOW_STATE_ICONIFIED)) {
+      continue;
+    }
+    gint x, y, width, height;
+    gtk_window_get_position(get_window(other), &x, &y);
+    gtk_window_get_size(get_window(other), &width, &height);
+    self->snapper->AddRect(
+        {static_cast<double>(x), static_cast<double>(y),
+         static_cast<double>(width), static_cast<double>(height)});
+  }
+  self->snapper->Build();
+}
+
+// The window manager moves the window in gtk_window_begin_move_drag and
+// gives no chance to adjust the position, so snapping drags move the window
+// themselves under a pointer grab. Only possible on X11, Wayland ignores
+// gtk_window_move.
+static bool begin_snapping_drag(WindowManagerPlugin* self,
+                                GdkSeat* seat,
+                                gint root_x,
+                                gint root_y) {
+#ifdef GDK_WINDOWING_X11
+  if (!GDK_IS_X11_DISPLAY(gdk_seat_get_display(seat)))
+    return false;
+#else
+  return false;
+#endif
+
+  GdkGrabStatus status = gdk_seat_grab(
+      seat, get_gdk_window(self), GDK_SEAT_CAPABILITY_POINTER,
+      false /* owner_events */, nullptr /* cursor */, nullptr /* event */,
+      nullptr /*prepare_func */, nullptr /* prepare_func_data */);
+  if (status != GDK_GRAB_SUCCESS)
+    return false;
+
+  build_snap_index(self);
+  self->drag_seat = seat;
+  self->drag_pointer = {root_x, root_y};
+  gtk_window_get_position(get_window(self), &self->drag_origin.x,
+                          &self->drag_origin.y);
+  return true;
+}
+
+static void begin_window_drag(WindowManagerPlugin* self,
+                              GdkSeat* seat,
+                              gint button,
+                              gint root_x,
+                              gint root_y,
+                              guint32 timestamp) {
+  self->input_latency->OnDragStart(g_get_monotonic_time());
+  if (self->snap_distance > 0 && self->drag_seat == nullptr &&
+      begin_snapping_drag(self, seat, root_x, root_y)) {
+    return;
+  }
+  gtk_window_begin_move_drag(get_window(self), button, root_x, root_y,
+                             timestamp);
+}
+
+static FlMethodResponse* set_drag_regions(WindowManagerPlugin* self,
+                                          FlValue* args) {
+  window_manager_plus_v2::DragRegionsArgs regions;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::DragRegionsArgsSchema(), args, &regions)) {
+    return error;
+  }
+  if (self->drag_regions == nullptr)
+    self->drag_regions = new window_manager_plus_v2::DragRegions();
+  self->drag_regions->Reset(
+      window_manager_plus_v2::RectsFromValues(regions.regions.data,
+                                              regions.regions.size),
+      window_manager_plus_v2::RectsFromValues(regions.excluded_regions.data,
+                                              regions.excluded_regions.size));
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* set_resize_border(WindowManagerPlugin* self,
+                                           FlValue* args) {
+  window_manager_plus_v2::ResizeBorderArgs border;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::ResizeBorderArgsSchema(), args, &border)) {
+    return error;
+  }
+  self->resize_border.width = border.width;
+  self->resize_border.top = border.top;
+  self->resize_border.bottom = border.bottom;
+  self->resize_border.left = border.left;
+  self->resize_border.right = border.right;
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static_assert(sizeof(window_manager_plus_v2::PixelRect) ==
+                  sizeof(cairo_rectangle_int_t),
+              "PixelRect must be laid out like cairo_rectangle_int_t");
+
+// The rectangles are relative to the view, which is offset in the toplevel
+// by client-side decorations.
+static void apply_input_region(WindowManagerPlugin* self) {
+  GdkWindow* window = get_gdk_window(self);
+  if (window == nullptr) {
+    return;
+  }
+  if (!self->input_region->IsSet()) {
+    gdk_window_input_shape_combine_region(window, nullptr, 0, 0);
+    return;
+  }
+  const auto& rects = self->input_region->rects();
+  cairo_region_t* region = cairo_region_create_rectangles(
+      reinterpret_cast<const cairo_rectangle_int_t*>(rects.data()),
+      static_cast<int>(rects.size()));
+  gint x = 0;
+  gint y = 0;
+  gtk_widget_translate_coordinates(
+      GTK_WIDGET(fl_plugin_registrar_get_view(self->registrar)),
+      GTK_WIDGET(get_window(self)), 0, 0, &x, &y);
+  gdk_window_input_shape_combine_region(window, region, x, y);
+  cairo_region_destroy(region);
+}
+
+static FlMethodResponse* set_input_region(WindowManagerPlugin* self,
+                                          FlValue* args) {
+  window_manager_plus_v2::InputRegionArgs region;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::InputRegionArgsSchema(), args, &region)) {
+    return error;
+  }
+  if (self->input_region == nullptr)
+    self->input_region = new window_manager_plus_v2::InputRegion();
+  bool is_changed = !region.regions
+                        ? self->input_region->Reset()
+                        : self->input_region->Update(region.regions->data,
+                                                     region.regions->size, 1);
+  if (is_changed) {
+    apply_input_region(self);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static GdkWindowEdge gdk_window_edge_from_resize_edge(
+    window_manager_plus_v2::ResizeEdge edge) {
+  switch (edge) {
+    case window_manager_plus_v2::ResizeEdge::kTop:
+      return GDK_WINDOW_EDGE_NORTH;
+    case window_manager_plus_v2::ResizeEdge::kBottom:
+      return GDK_WINDOW_EDGE_SOUTH;
+    case window_manager_plus_v2::ResizeEdge::kLeft:
+      return GDK_WINDOW_EDGE_WEST;
+    case window_manager_plus_v2::ResizeEdge::kRight:
+      return GDK_WINDOW_EDGE_EAST;
+    case window_manager_plus_v2::ResizeEdge::kTopLeft:
+      return GDK_WINDOW_EDGE_NORTH_WEST;
+    case window_manager_plus_v2::ResizeEdge::kTopRight:
+      return GDK_WINDOW_EDGE_NORTH_EAST;
+    case window_manager_plus_v2::ResizeEdge::kBottomLeft:
+      return GDK_WINDOW_EDGE_SOUTH_WEST;
+    default:
+      return GDK_WINDOW_EDGE_SOUTH_EAST;
+  }
+}
+
+// Runs in the capture phase, before the view sees the press, and only for
+// presses in this plugin's view. Presses on the resize border or in a drag
+// region are claimed so that the view never sees them, and start the resize
+// or move with the event's own timestamp.
+static void on_view_pressed(GtkGestureMultiPress* gesture,
+                            gint n_press,
+                            gdouble x,
+                            gdouble y,
+                            gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  GdkEventSequence* sequence =
+      gtk_gesture_single_get_current_sequence(GTK_GESTURE_SINGLE(gesture));
+  const GdkEvent* event =
+      gtk_gesture_get_last_event(GTK_GESTURE(gesture), sequence);
+  if (event == nullptr)
+    return;
+  guint button =
+      gtk_gesture_single_get_current_button(GTK_GESTURE_SINGLE(gesture));
+  // In the coordinates of the window that got the event, like the release
+  // synthesized by emit_button_release.
+  self->_last_press.button = button;
+  self->_last_press.time = gdk_event_get_time(event);
+  gdk_event_get_coords(event, &self->_last_press.x, &self->_last_press.y);
+  // X11 servers and Wayland compositors stamp events with the monotonic
+  // clock in milliseconds.
+  gint64 now = g_get_monotonic_time();
+  self->input_latency->OnPress(window_manager_plus_v2::EventTimeToMonotonicUs(
+      self->_last_press.time, static_cast<guint32>(now / 1000), now));
+
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (button != GDK_BUTTON_PRIMARY || gdk_window == nullptr ||
+      (gdk_window_get_state(gdk_window) & GDK_WINDOW_STATE_FULLSCREEN)) {
+    return;
+  }
+
+  // The border wins over a drag region along the top edge.
+  GtkWidget* view =
+      gtk_event_controller_get_widget(GTK_EVENT_CONTROLLER(gesture));
+  window_manager_plus_v2::ResizeEdge edge =
+      window_manager_plus_v2::ResizeEdge::kNone;
+  if (gtk_window_get_resizable(get_window(self)) &&
+      !(gdk_window_get_state(gdk_window) & GDK_WINDOW_STATE_MAXIMIZED)) {
+    edge = self->resize_border.Classify(x, y,
+                                        gtk_widget_get_allocated_width(view),
+                                        gtk_widget_get_allocated_height(view));
+  }
+  if (edge == window_manager_plus_v2::ResizeEdge::kNone &&
+      (self->drag_regions == nullptr || !self->drag_regions->HitTest(x, y))) {
+    return;
+  }
+
+  gtk_gesture_set_state(GTK_GESTURE(gesture), GTK_EVENT_SEQUENCE_CLAIMED);
+
+  gdouble root_x, root_y;
+  gdk_event_get_root_coords(event, &root_x, &root_y);
+  guint32 time = gdk_event_get_time(event);
+
+  if (edge != window_manager_plus_v2::ResizeEdge::kNone) {
+    self->input_latency->OnResizeStart(g_get_monotonic_time());
+    gtk_window_begin_resize_drag(get_window(self),
+                                 gdk_window_edge_from_resize_edge(edge),
+                                 button, static_cast<gint>(root_x),
+                                 static_cast<gint>(root_y), time);
+    return;
+  }
+
+  // The move drag cancels the gesture, which then never counts a second
+  // press, so double clicks are detected here.
+  gint double_click_time, double_click_distance;
+  g_object_get(gtk_widget_get_settings(GTK_WIDGET(get_window(self))),
+               "gtk-double-click-time", &double_click_time,
+               "gtk-double-click-distance", &double_click_distance, nullptr);
+  if (self->drag_region_press_time != 0 &&
+      time - self->drag_region_press_time <= (guint32)double_click_time &&
+      ABS(root_x - self->drag_region_press.x) <= double_click_distance &&
+      ABS(root_y - self->drag_region_press.y) <= double_click_distance) {
+    self->drag_region_press_time = 0;
+    if (gdk_window_get_state(gdk_window) & GDK_WINDOW_STATE_MAXIMIZED)
+      gtk_window_unmaximize(get_window(self));
+    else
+      gtk_window_maximize(get_window(self));
+    return;
+  }
+  self->drag_region_press_time = time;
+  self->drag_region_press = {static_cast<gint>(root_x),
+                             static_cast<gint>(root_y)};
+
+  begin_window_drag(self, gdk_device_get_seat(gdk_event_get_device(event)),
+                    button, static_cast<gint>(root_x),
+                    static_cast<gint>(root_y), time);
+}
+
+// Samples the pointer on every tick of the window's frame clock, which keeps
+// ticking while the stream is enabled, and sends the batched positions.
+static void sample_cursor(WindowManagerPlugin* self, gint64 time) {
+  GdkDisplay* display = gdk_display_get_default();
+  GdkDevice* pointer =
+      gdk_seat_get_pointer(gdk_display_get_default_seat(display));
+  gdouble x = 0;
+  gdouble y = 0;
+  gdk_device_get_position_double(pointer, nullptr, &x, &y);
+  self->cursor_sampler->Sample(time, x, y);
+}
+
+// Frame clock times are g_get_monotonic_time() ones, so the polled samples
+// line up with the per-frame ones.
+static gboolean on_cursor_idle_poll(gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  sample_cursor(self, g_get_monotonic_time());
+  if (self->cursor_sampler->IsIdle()) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  self->cursor_idle_source = 0;
+  gdk_frame_clock_begin_updating(self->cursor_clock);
+  return G_SOURCE_REMOVE;
+}
+
+// A resting pointer would otherwise keep the window drawing every frame.
+static void on_cursor_frame(GdkFrameClock* clock, gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  gint64 time = gdk_frame_clock_get_frame_time(clock);
+  sample_cursor(self, time);
+  if (self->cursor_sampler->IsDue(time)) {
+    std::vector<double> samples = self->cursor_sampler->TakeSamples(time);
+    g_autoptr(FlValue) args =
+        fl_value_new_float_list(samples.data(), samples.size());
+    push_event(self, "cursorSamples", "cursorSamples", "onCursorSamples",
+               args);
+  }
+
+  if (self->cursor_sampler->IsIdle() && self->cursor_idle_source == 0) {
+    gdk_frame_clock_end_updating(clock);
+    self->cursor_idle_source =
+        g_timeout_add(window_manager_plus_v2::CursorSampler::kIdlePollMs,
+                      on_cursor_idle_poll, self);
+  }
+}
+
+static void stop_cursor_stream(WindowManagerPlugin* self) {
+  if (self->cursor_clock == nullptr) {
+    return;
+  }
+  g_signal_handler_disconnect(self->cursor_clock, self->cursor_frame_handler);
+  if (self->cursor_idle_source != 0) {
+    g_source_remove(self->cursor_idle_source);
+    self->cursor_idle_source = 0;
+  } else {
+    gdk_frame_clock_end_updating(self->cursor_clock);
+  }
+  g_clear_object(&self->cursor_clock);
+  self->cursor_frame_handler = 0;
+  self->cursor_sampler->Reset();
+}
+
+static FlMethodResponse* set_cursor_stream_enabled(WindowManagerPlugin* self,
+                                                   FlValue* args) {
+  window_manager_plus_v2::CursorStreamArgs stream_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::CursorStreamArgsSchema(), args,
+          &stream_args)) {
+    return error;
+  }
+  if (!stream_args.enabled) {
+    stop_cursor_stream(self);
+  } else if (self->cursor_clock == nullptr) {
+    GdkFrameClock* clock =
+        gtk_widget_get_frame_clock(GTK_WIDGET(get_window(self)));
+    if (clock == nullptr) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "setCursorStreamEnabled", "Window is not realized", nullptr));
+    }
+    if (self->cursor_sampler == nullptr)
+      self->cursor_sampler = new window_manager_plus_v2::CursorSampler();
+    self->cursor_clock = GDK_FRAME_CLOCK(g_object_ref(clock));
+    self->cursor_frame_handler = g_signal_connect(
+        clock, "update", G_CALLBACK(on_cursor_frame), self);
+    gdk_frame_clock_begin_updating(clock);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlValue* latency_histogram_to_value(
+    const window_manager_plus_v2::LatencyHistogram& histogram) {
+  gint64 buckets[window_manager_plus_v2::LatencyHistogram::kBucketCount];
+  for (int i = 0; i < window_manager_plus_v2::LatencyHistogram::kBucketCount;
+       i++) {
+    buckets[i] = histogram.bucket(i);
+  }
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "count", fl_value_new_int(histogram.count()));
+  fl_value_set_string_take(value, "minUs",
+                           fl_value_new_int(histogram.min_us()));
+  fl_value_set_string_take(value, "maxUs",
+                           fl_value_new_int(histogram.max_us()));
+  fl_value_set_string_take(value, "meanUs",
+                           fl_value_new_int(histogram.mean_us()));
+  fl_value_set_string_take(value, "p50Us",
+                           fl_value_new_int(histogram.Percentile(0.5)));
+  fl_value_set_string_take(value, "p90Us",
+                           fl_value_new_int(histogram.Percentile(0.9)));
+  fl_value_set_string_take(value, "p99Us",
+                           fl_value_new_int(histogram.Percentile(0.99)));
+  fl_value_set_string_take(
+      value, "buckets",
+      fl_value_new_int64_list(buckets, G_N_ELEMENTS(buckets)));
+  return value;
+}
+
+static FlMethodResponse* get_input_latency_stats(WindowManagerPlugin* self,
+                                                 FlValue* args) {
+  window_manager_plus_v2::InputLatencyStatsArgs stats_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::InputLatencyStatsArgsSchema(), args,
+          &stats_args)) {
+    return error;
+  }
+  const window_manager_plus_v2::InputLatencyTracker& latency =
+      *self->input_latency;
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "dragStart",
+                           latency_histogram_to_value(latency.drag_start()));
+  fl_value_set_string_take(result, "resizeStart",
+                           latency_histogram_to_value(latency.resize_start()));
+  fl_value_set_string_take(result, "firstMove",
+                           latency_histogram_to_value(latency.first_move()));
+  if (stats_args.reset.value_or(false)) {
+    self->input_latency->Reset();
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* set_event_policy(WindowManagerPlugin* self,
+                                          FlValue* args) {
+  window_manager_plus_v2::EventPolicyArgs policy_args;
+  if (FlMethodResponse* error = decode_args(
+          window_manager_plus_v2::EventPolicyArgsSchema(), args,
+          &policy_args)) {
+    return error;
+  }
+  self->event_queue->SetPolicy(
+      policy_args.event_name,
+      *window_manager_plus_v2::EventPolicyFromName(policy_args.policy));
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* get_event_queue_stats(WindowManagerPlugin* self) {
+  window_manager_plus_v2::EventQueueStats stats = self->event_queue->stats();
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "depth", fl_value_new_int(stats.depth));
+  fl_value_set_string_take(result, "maxDepth",
+                           fl_value_new_int(stats.max_depth));
+  fl_value_set_string_take(result, "inFlight",
+                           fl_value_new_int(stats.in_flight));
+  fl_value_set_string_take(result, "sent", fl_value_new_int(stats.sent));
+  fl_value_set_string_take(result, "coalesced",
+                           fl_value_new_int(stats.coalesced));
+  fl_value_set_string_take(result, "dropped",
+                           fl_value_new_int(stats.dropped));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
 static FlMethodResponse* start_dragging(WindowManagerPlugin* self) {
   auto window = get_window(self);
   auto screen = gtk_window_get_screen(window);
@@ -617,9 +2474,9 @@ static FlMethodResponse* start_dragging(WindowManagerPlugin* self) {
 
   gint root_x, root_y;
   gdk_device_get_position(device, nullptr, &root_x, &root_y);
-  guint32 timestamp = (guint32)g_get_monotonic_time();
 
-  gtk_window_begin_move_drag(window, 1, root_x, root_y, timestamp);
+  // The press that Dart reacted to.
+  begin_window_drag(self, seat, 1, root_x, root_y, self->_last_press.time);
   self->_is_dragging = true;
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
@@ -660,7 +2517,6 @@ static FlMethodResponse* start_resizing(WindowManagerPlugin* self,
 
   gint root_x, root_y;
   gdk_device_get_position(device, nullptr, &root_x, &root_y);
-  guint32 timestamp = (guint32)g_get_monotonic_time();
 
   GdkWindowEdge gdk_window_edge = GDK_WINDOW_EDGE_NORTH_WEST;
 
@@ -682,9 +2538,11 @@ static FlMethodResponse* start_resizing(WindowManagerPlugin* self,
     gdk_window_edge = GDK_WINDOW_EDGE_SOUTH_EAST;
   }
 
+  self->input_latency->OnResizeStart(g_get_monotonic_time());
+  // The press that Dart reacted to.
   gtk_window_begin_resize_drag(window, gdk_window_edge,
-                               self->_event_button.button, root_x, root_y,
-                               timestamp);
+                               self->_last_press.button, root_x, root_y,
+                               self->_last_press.time);
   self->_is_resizing = true;
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
@@ -802,6 +2660,287 @@ static FlMethodResponse* set_brightness(WindowManagerPlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Name of the optional asset, relative to the bundle's `data/flutter_assets`
+// directory, holding the options applied before the window is first mapped.
+static const gchar kInitialWindowOptionsFile[] = "window_options.ini";
+static const gchar kInitialWindowOptionsGroup[] = "Window";
+
+// Discards the response of a method handler invoked natively.
+static void apply_method(FlMethodResponse* response) {
+  g_autoptr(FlMethodResponse) unused = response;
+}
+
+static void apply_initial_size_constraint(
+    WindowManagerPlugin* self,
+    GKeyFile* key_file,
+    const gchar* width_key,
+    const gchar* height_key,
+    FlMethodResponse* (*setter)(WindowManagerPlugin*, FlValue*)) {
+  if (!g_key_file_has_key(key_file, kInitialWindowOptionsGroup, width_key,
+                          nullptr) ||
+      !g_key_file_has_key(key_file, kInitialWindowOptionsGroup, height_key,
+                          nullptr)) {
+    return;
+  }
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(
+      args, "width",
+      fl_value_new_float(g_key_file_get_double(
+          key_file, kInitialWindowOptionsGroup, width_key, nullptr)));
+  fl_value_set_string_take(
+      args, "height",
+      fl_value_new_float(g_key_file_get_double(
+          key_file, kInitialWindowOptionsGroup, height_key, nullptr)));
+  apply_method(setter(self, args));
+}
+
+static void apply_initial_bool_option(
+    WindowManagerPlugin* self,
+    GKeyFile* key_file,
+    const gchar* key,
+    const gchar* arg_name,
+    FlMethodResponse* (*setter)(WindowManagerPlugin*, FlValue*)) {
+  if (!g_key_file_has_key(key_file, kInitialWindowOptionsGroup, key, nullptr))
+    return;
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(
+      args, arg_name,
+      fl_value_new_bool(g_key_file_get_boolean(
+          key_file, kInitialWindowOptionsGroup, key, nullptr)));
+  apply_method(setter(self, args));
+}
+
+static void apply_initial_string_option(
+    WindowManagerPlugin* self,
+    GKeyFile* key_file,
+    const gchar* key,
+    FlMethodResponse* (*setter)(WindowManagerPlugin*, FlValue*)) {
+  g_autofree gchar* value = g_key_file_get_string(
+      key_file, kInitialWindowOptionsGroup, key, nullptr);
+  if (value == nullptr)
+    return;
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, key, fl_value_new_string(value));
+  apply_method(setter(self, args));
+}
+
+// Applies the initial window options bundled with the app, so that geometry,
+// constraints and decorations are in place before the window is first mapped
+// and the Dart side needs no setup calls at launch.
+static void apply_initial_window_options(WindowManagerPlugin* self) {
+  g_autofree gchar* executable = g_file_read_link("/proc/self/exe", nullptr);
+  if (executable == nullptr)
+    return;
+  g_autofree gchar* directory = g_path_get_dirname(executable);
+  g_autofree gchar* path =
+      g_build_filename(directory, "data", "flutter_assets",
+                       kInitialWindowOptionsFile, nullptr);
+
+  g_autoptr(GKeyFile) key_file = g_key_file_new();
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, nullptr) ||
+      !g_key_file_has_group(key_file, kInitialWindowOptionsGroup)) {
+    return;
+  }
+
+  // Geometry hints are set on the GdkWindow, which must exist by now.
+  gtk_widget_realize(GTK_WIDGET(get_window(self)));
+
+  apply_initial_bool_option(self, key_file, "showOnFirstFrame",
+                            "isShowOnFirstFrame", set_show_on_first_frame);
+  if (g_key_file_get_boolean(key_file, kInitialWindowOptionsGroup, "frameless",
+                             nullptr)) {
+    apply_method(set_as_frameless(self, nullptr));
+  }
+  apply_initial_string_option(self, key_file, "titleBarStyle",
+                              set_title_bar_style);
+  apply_initial_string_option(self, key_file, "title", set_title);
+
+  g_autoptr(FlValue) bounds = fl_value_new_map();
+  const gchar* bounds_keys[] = {"x", "y", "width", "height"};
+  for (const gchar* key : bounds_keys) {
+    if (g_key_file_has_key(key_file, kInitialWindowOptionsGroup, key,
+                           nullptr)) {
+      fl_value_set_string_take(
+          bounds, key,
+          fl_value_new_float(g_key_file_get_double(
+              key_file, kInitialWindowOptionsGroup, key, nullptr)));
+    }
+  }
+  apply_method(set_bounds(self, bounds));
+  if (g_key_file_get_boolean(key_file, kInitialWindowOptionsGroup, "center",
+                             nullptr)) {
+    g_autoptr(FlValue) center = fl_value_new_map();
+    fl_value_set_string_take(center, "x", fl_value_new_float(0));
+    fl_value_set_string_take(center, "y", fl_value_new_float(0));
+    apply_method(align(self, center));
+  }
+
+  apply_initial_size_constraint(self, key_file, "minimumWidth",
+                                "minimumHeight", set_minimum_size);
+  apply_initial_size_constraint(self, key_file, "maximumWidth",
+                                "maximumHeight", set_maximum_size);
+  apply_initial_bool_option(self, key_file, "resizable", "isResizable",
+                            set_resizable);
+  apply_initial_bool_option(self, key_file, "alwaysOnTop", "isAlwaysOnTop",
+                            set_always_on_top);
+  apply_initial_bool_option(self, key_file, "skipTaskbar", "isSkipTaskbar",
+                            set_skip_taskbar);
+
+  // Restored last, so that a saved geometry wins over the defaults above.
+  g_autofree gchar* geometry_key = g_key_file_get_string(
+      key_file, kInitialWindowOptionsGroup, "geometryPersistenceKey", nullptr);
+  if (geometry_key != nullptr) {
+    g_autoptr(FlValue) args = fl_value_new_map();
+    fl_value_set_string_take(args, "key", fl_value_new_string(geometry_key));
+    apply_method(set_geometry_persistence_key(self, args));
+  }
+}
+
+// Publishes the state read by window_manager_plugin_get_snapshot, from
+// the handlers of the events changing it. |is_focused| overrides
+// gtk_window_is_active, which the focus handlers run before.
+static void publish_snapshot(WindowManagerPlugin* self,
+                             std::optional<bool> is_focused = std::nullopt) {
+  if (self->event_channel == nullptr) {
+    // Not initialized by Dart yet, window_id is unknown.
+    return;
+  }
+  GtkWindow* window = get_window(self);
+  gint x, y, width, height;
+  gtk_window_get_position(window, &x, &y);
+  gtk_window_get_size(window, &width, &height);
+  WindowSnapshot snapshot;
+  snapshot.x = x;
+  snapshot.y = y;
+  snapshot.width = width;
+  snapshot.height = height;
+  snapshot.scale_factor = gtk_widget_get_scale_factor(GTK_WIDGET(window));
+  if (is_focused.value_or(gtk_window_is_active(window))) {
+    snapshot.flags |= window_manager_plus_v2::kSnapshotFocused;
+  }
+  if (gtk_widget_is_visible(GTK_WIDGET(window))) {
+    snapshot.flags |= window_manager_plus_v2::kSnapshotVisible;
+  }
+  // Unlike gtk_window_is_maximized, already up to date in the handlers of
+  // window-state-event.
+  GdkWindow* gdk_window = get_gdk_window(self);
+  GdkWindowState state =
+      gdk_window != nullptr ? gdk_window_get_state(gdk_window)
+                            : static_cast<GdkWindowState>(0);
+  if (state & GDK_WINDOW_STATE_MAXIMIZED) {
+    snapshot.flags |= window_manager_plus_v2::kSnapshotMaximized;
+  }
+  if (state & GDK_WINDOW_STATE_ICONIFIED) {
+    snapshot.flags |= window_manager_plus_v2::kSnapshotMinimized;
+  }
+  if (state & GDK_WINDOW_STATE_FULLSCREEN) {
+    snapshot.flags |= window_manager_plus_v2::kSnapshotFullScreen;
+  }
+  window_manager_plus_v2::GetWindowSnapshotRegistry().Publish(self->window_id,
+                                                              snapshot);
+}
+
+// The calls of protocol/window_manager.idl, the hot getters and setters
+// decoded from packed arguments instead of a map.
+class ProtocolApi : public WindowManagerApi {
+ public:
+  explicit ProtocolApi(WindowManagerPlugin* self) : self_(self) {}
+
+  window_manager_plus_v2::protocol::Bounds GetBounds(
+      double device_pixel_ratio) override {
+    gint x, y, width, height;
+    gtk_window_get_position(get_window(self_), &x, &y);
+    gtk_window_get_size(get_window(self_), &width, &height);
+    return {static_cast<double>(x), static_cast<double>(y),
+            static_cast<double>(width), static_cast<double>(height)};
+  }
+
+  void SetBounds(const std::optional<double>& x,
+                 const std::optional<double>& y,
+                 const std::optional<double>& width,
+                 const std::optional<double>& height,
+                 double device_pixel_ratio) override {
+    apply_bounds(self_, {x, y, width, height, device_pixel_ratio});
+  }
+
+  bool IsFocused() override { return gtk_window_is_active(get_window(self_)); }
+
+  bool IsVisible() override {
+    return gtk_widget_is_visible(GTK_WIDGET(get_window(self_)));
+  }
+
+  bool IsMaximized() override {
+    return gtk_window_is_maximized(get_window(self_));
+  }
+
+  bool IsMinimized() override {
+    return gdk_window_get_state(get_gdk_window(self_)) &
+           GDK_WINDOW_STATE_ICONIFIED;
+  }
+
+  bool IsFullScreen() override {
+    return gdk_window_get_state(get_gdk_window(self_)) &
+           GDK_WINDOW_STATE_FULLSCREEN;
+  }
+
+  double GetOpacity() override {
+    return gtk_widget_get_opacity(GTK_WIDGET(get_window(self_)));
+  }
+
+  void SetOpacity(double opacity) override {
+    gtk_widget_set_opacity(GTK_WIDGET(get_window(self_)), opacity);
+  }
+
+ private:
+  WindowManagerPlugin* self_;
+};
+
+static void protocol_message_cb(FlBinaryMessenger* messenger,
+                                const gchar* channel,
+                                GBytes* message,
+                                FlBinaryMessengerResponseHandle* handle,
+                                gpointer user_data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(user_data);
+  ProtocolApi api(plugin);
+  gsize size = 0;
+  const guint8* data =
+      static_cast<const guint8*>(g_bytes_get_data(message, &size));
+  // A call about another window of the process goes to its plugin, calls
+  // about unknown windows fail with "no-window".
+  std::vector<uint8_t> reply = window_manager_plus_v2::protocol::HandleCall(
+      [&api](int64_t window_id) -> WindowManagerApi* {
+        WindowManagerPlugin* target = find_plugin(window_id);
+        if (target == nullptr) {
+          return nullptr;
+        }
+        api = ProtocolApi(target);
+        return &api;
+      },
+      data, size);
+  g_autoptr(GBytes) response = g_bytes_new(reply.data(), reply.size());
+  g_autoptr(GError) error = nullptr;
+  if (!fl_binary_messenger_send_response(messenger, handle, response,
+                                         &error)) {
+    g_warning("Failed to reply on %s: %s", channel, error->message);
+  }
+}
+
+static void set_protocol_channel(WindowManagerPlugin* self,
+                                 gchar* protocol_channel) {
+  FlBinaryMessenger* messenger =
+      fl_plugin_registrar_get_messenger(self->registrar);
+  if (self->protocol_channel != nullptr) {
+    fl_binary_messenger_set_message_handler_on_channel(
+        messenger, self->protocol_channel, nullptr, nullptr, nullptr);
+  }
+  g_free(self->protocol_channel);
+  self->protocol_channel = protocol_channel;
+  if (protocol_channel != nullptr) {
+    fl_binary_messenger_set_message_handler_on_channel(
+        messenger, protocol_channel, protocol_message_cb, self, nullptr);
+  }
+}
+
 // Called when a method call is received from Flutter.
 static void window_manager_plugin_handle_method_call(
     WindowManagerPlugin* self,
@@ -812,11 +2951,34 @@ static void window_manager_plugin_handle_method_call(
   FlValue* args = fl_method_call_get_args(method_call);
 
   if (g_strcmp0(method, "ensureInitialized") == 0) {
+    FlValue* window_id = args != nullptr &&
+                                 fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                             ? fl_value_lookup_string(args, "windowId")
+                             : nullptr;
+    if (window_id != nullptr &&
+        fl_value_get_type(window_id) == FL_VALUE_TYPE_INT) {
+      if (self->event_channel != nullptr) {
+        window_manager_plus_v2::GetWindowSnapshotRegistry().Remove(
+            self->window_id);
+      }
+      self->window_id = fl_value_get_int(window_id);
+      g_free(self->event_channel);
+      self->event_channel = g_strdup_printf(
+          "window_manager_plus_v2_events_%" G_GINT64_FORMAT, self->window_id);
+      set_protocol_channel(
+          self, g_strdup_printf("window_manager_plus_v2_protocol_%"
+                                G_GINT64_FORMAT, self->window_id));
+      publish_snapshot(self);
+    }
     g_autoptr(FlValue) result = fl_value_new_bool(true);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (g_strcmp0(method, "waitUntilReadyToShow") == 0) {
     g_autoptr(FlValue) result = fl_value_new_bool(true);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "setShowOnFirstFrame") == 0) {
+    response = set_show_on_first_frame(self, args);
+  } else if (g_strcmp0(method, "getTimeToFirstFrame") == 0) {
+    response = get_time_to_first_frame(self);
   } else if (g_strcmp0(method, "setAsFrameless") == 0) {
     response = set_as_frameless(self, args);
   } else if (g_strcmp0(method, "destroy") == 0) {
@@ -871,6 +3033,28 @@ static void window_manager_plugin_handle_method_call(
     response = get_bounds(self);
   } else if (g_strcmp0(method, "setBounds") == 0) {
     response = set_bounds(self, args);
+  } else if (g_strcmp0(method, "getDisplays") == 0) {
+    response = get_displays(self);
+  } else if (g_strcmp0(method, "align") == 0) {
+    response = align(self, args);
+  } else if (g_strcmp0(method, "setParentWindow") == 0) {
+    response = set_parent_window(self, args);
+  } else if (g_strcmp0(method, "setDragRegions") == 0) {
+    response = set_drag_regions(self, args);
+  } else if (g_strcmp0(method, "setResizeBorder") == 0) {
+    response = set_resize_border(self, args);
+  } else if (g_strcmp0(method, "setInputRegion") == 0) {
+    response = set_input_region(self, args);
+  } else if (g_strcmp0(method, "setCursorStreamEnabled") == 0) {
+    response = set_cursor_stream_enabled(self, args);
+  } else if (g_strcmp0(method, "getInputLatencyStats") == 0) {
+    response = get_input_latency_stats(self, args);
+  } else if (g_strcmp0(method, "setEventPolicy") == 0) {
+    response = set_event_policy(self, args);
+  } else if (g_strcmp0(method, "getEventQueueStats") == 0) {
+    response = get_event_queue_stats(self);
+  } else if (g_strcmp0(method, "setSnapping") == 0) {
+    response = set_snapping(self, args);
   } else if (g_strcmp0(method, "setMinimumSize") == 0) {
     response = set_minimum_size(self, args);
   } else if (g_strcmp0(method, "setMaximumSize") == 0) {
@@ -912,7 +3096,22 @@ static void window_manager_plugin_handle_method_call(
   } else if (g_strcmp0(method, "setSkipTaskbar") == 0) {
     response = set_skip_taskbar(self, args);
   } else if (g_strcmp0(method, "setIcon") == 0) {
-    response = set_icon(self, args);
+    set_icon(self, method_call, args);
+    return;
+  } else if (g_strcmp0(method, "setIconFromBytes") == 0) {
+    response = set_icon_from_bytes(self, args);
+  } else if (g_strcmp0(method, "captureWindow") == 0) {
+    response = capture_window(self, args);
+  } else if (g_strcmp0(method, "setThumbnailOptions") == 0) {
+    response = set_thumbnail_options(self, args);
+  } else if (g_strcmp0(method, "tileWindows") == 0) {
+    response = tile_windows(self, args);
+  } else if (g_strcmp0(method, "saveLayout") == 0) {
+    response = save_layout(self, args);
+  } else if (g_strcmp0(method, "applyLayout") == 0) {
+    response = apply_layout(self, args);
+  } else if (g_strcmp0(method, "setGeometryPersistenceKey") == 0) {
+    response = set_geometry_persistence_key(self, args);
   } else if (g_strcmp0(method, "getOpacity") == 0) {
     response = get_opacity(self);
   } else if (g_strcmp0(method, "setOpacity") == 0) {
@@ -938,7 +3137,36 @@ static void window_manager_plugin_handle_method_call(
 
 static void window_manager_plugin_dispose(GObject* object) {
   WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(object);
+  plugins = g_list_remove(plugins, self);
+  if (thumbnail_service.subscriber == self) {
+    stop_thumbnail_service();
+  }
+  delete self->thumbnail;
+  self->thumbnail = nullptr;
+  g_clear_handle_id(&self->first_frame_timeout_id, g_source_remove);
+  g_clear_handle_id(&self->geometry_save_id, g_source_remove);
+  g_clear_pointer(&self->geometry_key, g_free);
   g_clear_object(&self->css_provider);
+  delete self->snapper;
+  self->snapper = nullptr;
+  delete self->drag_regions;
+  self->drag_regions = nullptr;
+  delete self->input_region;
+  self->input_region = nullptr;
+  delete self->input_latency;
+  self->input_latency = nullptr;
+  delete self->event_queue;
+  self->event_queue = nullptr;
+  if (self->event_channel != nullptr) {
+    window_manager_plus_v2::GetWindowSnapshotRegistry().Remove(
+        self->window_id);
+  }
+  g_clear_pointer(&self->event_channel, g_free);
+  set_protocol_channel(self, nullptr);
+  stop_cursor_stream(self);
+  delete self->cursor_sampler;
+  self->cursor_sampler = nullptr;
+  g_clear_object(&self->press_gesture);
   g_free(self->title_bar_style_);
   G_OBJECT_CLASS(window_manager_plugin_parent_class)->dispose(object);
 }
@@ -956,53 +3184,202 @@ static void method_call_cb(FlMethodChannel* channel,
   window_manager_plugin_handle_method_call(plugin, method_call);
 }
 
-void _emit_event(WindowManagerPlugin* plugin, const char* event_name) {
+static void send_event(WindowManagerPlugin* plugin, const QueuedEvent& event);
+
+// Each reply frees a slot of the event queue for the next event.
+static void on_event_delivered(WindowManagerPlugin* plugin) {
+  if (plugin->event_queue != nullptr) {
+    auto next = plugin->event_queue->OnReply();
+    if (next) {
+      send_event(plugin, *next);
+    }
+  }
+  g_object_unref(plugin);
+}
+
+static void on_event_reply(GObject* object,
+                           GAsyncResult* result,
+                           gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlMethodResponse) response = fl_method_channel_invoke_method_finish(
+      FL_METHOD_CHANNEL(object), result, &error);
+  on_event_delivered(WINDOW_MANAGER_PLUGIN(user_data));
+}
+
+static void on_event_record_reply(GObject* object,
+                                  GAsyncResult* result,
+                                  gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) response = fl_binary_messenger_send_on_channel_finish(
+      FL_BINARY_MESSENGER(object), result, &error);
+  on_event_delivered(WINDOW_MANAGER_PLUGIN(user_data));
+}
+
+// Records go to the event channel, the other events to their method.
+static void send_event(WindowManagerPlugin* plugin, const QueuedEvent& event) {
+  FlValue* value = event.value.get();
+  if (event.method == nullptr) {
+    g_autoptr(GBytes) message = g_bytes_new(fl_value_get_uint8_list(value),
+                                            fl_value_get_length(value));
+    fl_binary_messenger_send_on_channel(
+        fl_plugin_registrar_get_messenger(plugin->registrar),
+        plugin->event_channel, message, nullptr, on_event_record_reply,
+        g_object_ref(plugin));
+    return;
+  }
+  fl_method_channel_invoke_method(plugin->channel, event.method, value,
+                                  nullptr, on_event_reply,
+                                  g_object_ref(plugin));
+}
+
+// Queues |value| under the policy of |name|, see EventQueue. Returns
+// whether it was sent right away.
+static bool push_event(WindowManagerPlugin* plugin,
+                       const gchar* name,
+                       const std::string& key,
+                       const gchar* method,
+                       FlValue* value) {
+  auto ready = plugin->event_queue->Push(
+      name, key,
+      QueuedEvent{method,
+                  std::shared_ptr<FlValue>(fl_value_ref(value),
+                                           fl_value_unref)});
+  if (ready) {
+    send_event(plugin, *ready);
+  }
+  return ready.has_value();
+}
+
+void _emit_event_with_data(WindowManagerPlugin* plugin,
+                           WindowEvent event,
+                           FlValue* data) {
   g_autoptr(FlValue) result_data = fl_value_new_map();
-  fl_value_set_string_take(result_data, "eventName",
-                           fl_value_new_string(event_name));
-  fl_method_channel_invoke_method(plugin->channel, "onEvent", result_data,
-                                  nullptr, nullptr, nullptr);
+  fl_value_set_string_take(result_data, "event",
+                           fl_value_new_int(static_cast<int64_t>(event)));
+  if (data != nullptr) {
+    fl_value_set_string(result_data, "data", data);
+  }
+  const char* event_name = window_manager_plus_v2::WindowEventName(event);
+  push_event(plugin, event_name, event_name, "onEvent", result_data);
+}
+
+void _emit_event(WindowManagerPlugin* plugin, WindowEvent event) {
+  _emit_event_with_data(plugin, event, nullptr);
+}
+
+// Moves and resizes go to the event channel with the current bounds, as
+// fixed-size records that Dart reads without decoding a map.
+static void _emit_bounds_event(WindowManagerPlugin* plugin,
+                               WindowEvent event) {
+  if (plugin->event_channel == nullptr) {
+    // Not initialized by Dart yet.
+    _emit_event(plugin, event);
+    return;
+  }
+
+  gint x, y, width, height;
+  gtk_window_get_position(get_window(plugin), &x, &y);
+  gtk_window_get_size(get_window(plugin), &width, &height);
+  window_manager_plus_v2::EventRecord record = {
+      static_cast<int32_t>(event),
+      0,
+      plugin->window_id,
+      g_get_monotonic_time(),
+      static_cast<double>(x),
+      static_cast<double>(y),
+      static_cast<double>(width),
+      static_cast<double>(height),
+  };
+  std::vector<uint8_t> bytes =
+      window_manager_plus_v2::EncodeEventRecord(record);
+  const char* event_name = window_manager_plus_v2::WindowEventName(event);
+  g_autoptr(FlValue) value =
+      fl_value_new_uint8_list(bytes.data(), bytes.size());
+  push_event(plugin, event_name, event_name, nullptr, value);
+}
+
+void on_monitors_changed(GdkScreen* screen, gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  display_topology.Invalidate();
+  _emit_event(plugin, WindowEvent::kDisplaysChanged);
+}
+
+void on_first_frame(FlView* view, gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  if (plugin->_is_first_frame_rendered) {
+    return;
+  }
+  plugin->_is_first_frame_rendered = true;
+  plugin->time_to_first_frame =
+      g_get_monotonic_time() - plugin->registered_time;
+  show_pending_window(plugin);
+
+  g_autoptr(FlValue) data_map = fl_value_new_map();
+  fl_value_set_string_take(
+      data_map, "timeToFirstFrame",
+      fl_value_new_float(plugin->time_to_first_frame / 1000.0));
+  _emit_event_with_data(plugin, WindowEvent::kFirstFrame, data_map);
 }
 
 gboolean on_window_close(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "close");
+  save_window_geometry(plugin);
+  _emit_event(plugin, WindowEvent::kClose);
   return plugin->_is_prevent_close;
 }
 
 gboolean on_window_focus(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "focus");
+  publish_snapshot(plugin, true);
+  _emit_event(plugin, WindowEvent::kFocus);
   return false;
 }
 
 gboolean on_window_blur(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "blur");
+  publish_snapshot(plugin, false);
+  _emit_event(plugin, WindowEvent::kBlur);
   return false;
 }
 
 gboolean on_window_show(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "show");
+  publish_snapshot(plugin);
+  _emit_event(plugin, WindowEvent::kShow);
   return false;
 }
 
 gboolean on_window_hide(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "hide");
+  publish_snapshot(plugin);
+  _emit_event(plugin, WindowEvent::kHide);
   return false;
 }
 
+// A region set before the GdkWindow existed was recorded but not applied,
+// and setting it again is skipped as unchanged.
+void on_window_realize(GtkWidget* widget, gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  if (plugin->input_region != nullptr) {
+    apply_input_region(plugin);
+  }
+}
+
 gboolean on_window_resize(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "resize");
+  publish_snapshot(plugin);
+  _emit_bounds_event(plugin, WindowEvent::kResize);
   return false;
 }
 
 gboolean on_window_move(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "move");
+  plugin->input_latency->OnMove(g_get_monotonic_time());
+  update_normal_bounds(plugin);
+  schedule_geometry_save(plugin);
+  move_child_windows(plugin);
+  publish_snapshot(plugin);
+  _emit_bounds_event(plugin, WindowEvent::kMove);
   return false;
 }
 
@@ -1010,25 +3387,29 @@ gboolean on_window_state_change(GtkWidget* widget,
                                 GdkEventWindowState* event,
                                 gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  schedule_geometry_save(plugin);
+  publish_snapshot(plugin);
   if (event->changed_mask & GDK_WINDOW_STATE_MAXIMIZED) {
     if (event->new_window_state & GDK_WINDOW_STATE_MAXIMIZED) {
-      _emit_event(plugin, "maximize");
+      _emit_event(plugin, WindowEvent::kMaximize);
     } else {
-      _emit_event(plugin, "unmaximize");
+      _emit_event(plugin, WindowEvent::kUnmaximize);
     }
   }
   if (event->changed_mask & GDK_WINDOW_STATE_ICONIFIED) {
+    set_child_windows_iconified(
+        plugin, event->new_window_state & GDK_WINDOW_STATE_ICONIFIED);
     if (event->new_window_state & GDK_WINDOW_STATE_ICONIFIED) {
-      _emit_event(plugin, "minimize");
+      _emit_event(plugin, WindowEvent::kMinimize);
     } else {
-      _emit_event(plugin, "restore");
+      _emit_event(plugin, WindowEvent::kRestore);
     }
   }
   if (event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN) {
     if (event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN) {
-      _emit_event(plugin, "enter-full-screen");
+      _emit_event(plugin, WindowEvent::kEnterFullScreen);
     } else {
-      _emit_event(plugin, "leave-full-screen");
+      _emit_event(plugin, WindowEvent::kLeaveFullScreen);
     }
   }
   return false;
@@ -1036,9 +3417,9 @@ gboolean on_window_state_change(GtkWidget* widget,
 
 void emit_button_release(WindowManagerPlugin* self) {
   auto newEvent = (GdkEventButton*)gdk_event_new(GDK_BUTTON_RELEASE);
-  newEvent->x = self->_event_button.x;
-  newEvent->y = self->_event_button.y;
-  newEvent->button = self->_event_button.button;
+  newEvent->x = self->_last_press.x;
+  newEvent->y = self->_last_press.y;
+  newEvent->button = self->_last_press.button;
   newEvent->type = GDK_BUTTON_RELEASE;
   newEvent->time = g_get_monotonic_time();
   gboolean result;
@@ -1066,19 +3447,54 @@ gboolean on_event_after(GtkWidget* text_view,
   return FALSE;
 }
 
-gboolean on_mouse_press(GSignalInvocationHint* ihint,
-                        guint n_param_values,
-                        const GValue* param_values,
-                        gpointer data) {
-  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  GdkEventButton* event_button =
-      (GdkEventButton*)(g_value_get_boxed(param_values + 1));
+static void end_snapping_drag(WindowManagerPlugin* self) {
+  gdk_seat_ungrab(self->drag_seat);
+  self->drag_seat = nullptr;
+  // The view never saw the release, which went to the grab window. Drags
+  // from a drag region never reached the view in the first place.
+  if (self->_is_dragging && self->_event_box != nullptr)
+    emit_button_release(self);
+  self->_is_dragging = false;
+  _emit_bounds_event(self, WindowEvent::kMoved);
+}
 
-  // plugin->_event_button = event_button;
+static gboolean on_drag_motion(GtkWidget* widget,
+                               GdkEventMotion* event,
+                               gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  if (self->drag_seat == nullptr)
+    return false;
 
-  memset(&plugin->_event_button, 0, sizeof(plugin->_event_button));
-  memcpy(&plugin->_event_button, event_button, sizeof(plugin->_event_button));
-  return TRUE;
+  gint width, height;
+  gtk_window_get_size(get_window(self), &width, &height);
+  window_manager_plus_v2::Rect rect = {
+      self->drag_origin.x + event->x_root - self->drag_pointer.x,
+      self->drag_origin.y + event->y_root - self->drag_pointer.y,
+      static_cast<double>(width), static_cast<double>(height)};
+  window_manager_plus_v2::Point position =
+      self->snapper->Snap(rect, self->snap_distance);
+  gtk_window_move(get_window(self), static_cast<gint>(position.x),
+                  static_cast<gint>(position.y));
+  return true;
+}
+
+static gboolean on_drag_release(GtkWidget* widget,
+                                GdkEventButton* event,
+                                gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  if (self->drag_seat == nullptr)
+    return false;
+  end_snapping_drag(self);
+  return true;
+}
+
+static gboolean on_drag_grab_broken(GtkWidget* widget,
+                                    GdkEventGrabBroken* event,
+                                    gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  if (self->drag_seat != nullptr)
+    end_snapping_drag(self);
+  return false;
 }
 
 void window_manager_plugin_register_with_registrar(
@@ -1087,6 +3503,13 @@ void window_manager_plugin_register_with_registrar(
       g_object_new(window_manager_plugin_get_type(), nullptr));
 
   plugin->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+  plugins = g_list_append(plugins, plugin);
+  plugin->parent_id = -1;
+  plugin->input_latency = new window_manager_plus_v2::InputLatencyTracker();
+  plugin->event_queue = new window_manager_plus_v2::EventQueue<QueuedEvent>();
+  plugin->registered_time = g_get_monotonic_time();
+  plugin->time_to_first_frame = -1;
+  plugin->first_frame_timeout_ms = 1000;
 
   plugin->window_geometry.min_width = -1;
   plugin->window_geometry.min_height = -1;
@@ -1110,19 +3533,50 @@ void window_manager_plugin_register_with_registrar(
                    plugin);
   g_signal_connect(get_window(plugin), "hide", G_CALLBACK(on_window_hide),
                    plugin);
+  g_signal_connect_after(get_window(plugin), "realize",
+                         G_CALLBACK(on_window_realize), plugin);
   g_signal_connect(get_window(plugin), "check-resize",
                    G_CALLBACK(on_window_resize), plugin);
+  g_signal_connect_after(get_window(plugin), "draw",
+                         G_CALLBACK(on_window_draw), plugin);
   g_signal_connect(get_window(plugin), "configure-event",
                    G_CALLBACK(on_window_move), plugin);
   g_signal_connect(get_window(plugin), "window-state-event",
                    G_CALLBACK(on_window_state_change), plugin);
   g_signal_connect(get_window(plugin), "event-after",
                    G_CALLBACK(on_event_after), plugin);
+  gtk_widget_add_events(GTK_WIDGET(get_window(plugin)),
+                        GDK_POINTER_MOTION_MASK | GDK_BUTTON_RELEASE_MASK);
+  g_signal_connect(get_window(plugin), "motion-notify-event",
+                   G_CALLBACK(on_drag_motion), plugin);
+  g_signal_connect(get_window(plugin), "button-release-event",
+                   G_CALLBACK(on_drag_release), plugin);
+  g_signal_connect(get_window(plugin), "grab-broken-event",
+                   G_CALLBACK(on_drag_grab_broken), plugin);
   find_event_box(plugin, GTK_WIDGET(fl_plugin_registrar_get_view(registrar)));
+  // The screen outlives the plugin, disconnect when the plugin goes away.
+  g_signal_connect_object(gtk_widget_get_screen(GTK_WIDGET(get_window(plugin))),
+                          "monitors-changed", G_CALLBACK(on_monitors_changed),
+                          plugin, static_cast<GConnectFlags>(0));
+
+  // FlView only emits "first-frame" on newer engines; without it there is
+  // nothing to wait for, so showing is never held back.
+  FlView* view = fl_plugin_registrar_get_view(registrar);
+  if (g_signal_lookup("first-frame", G_OBJECT_TYPE(view)) != 0) {
+    g_signal_connect(view, "first-frame", G_CALLBACK(on_first_frame), plugin);
+  } else {
+    plugin->_is_first_frame_rendered = true;
+  }
+
+  plugin->press_gesture = gtk_gesture_multi_press_new(GTK_WIDGET(view));
+  gtk_event_controller_set_propagation_phase(
+      GTK_EVENT_CONTROLLER(plugin->press_gesture), GTK_PHASE_CAPTURE);
+  // Any button, the press is recorded for startDragging / startResizing.
+  gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(plugin->press_gesture), 0);
+  g_signal_connect(plugin->press_gesture, "pressed",
+                   G_CALLBACK(on_view_pressed), plugin);
 
-  g_signal_add_emission_hook(
-      g_signal_lookup("button-press-event", GTK_TYPE_WIDGET), 0, on_mouse_press,
-      plugin, NULL);
+  apply_initial_window_options(plugin);
 
   g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
   plugin->channel =
@@ -1133,3 +3587,23 @@ void window_manager_plugin_register_with_registrar(
 
   g_object_unref(plugin);
 }
+
+WindowManagerSnapshot window_manager_plugin_get_snapshot(gint64 window_id) {
+  static_assert(WINDOW_MANAGER_SNAPSHOT_PUBLISHED ==
+                        window_manager_plus_v2::kSnapshotPublished &&
+                    WINDOW_MANAGER_SNAPSHOT_FULL_SCREEN ==
+                        window_manager_plus_v2::kSnapshotFullScreen,
+                "Snapshot flags differ from common/window_snapshot.h");
+  WindowManagerSnapshot result = {};
+  WindowSnapshot snapshot;
+  if (window_manager_plus_v2::GetWindowSnapshotRegistry().Read(window_id,
+                                                               &snapshot)) {
+    result.x = snapshot.x;
+    result.y = snapshot.y;
+    result.width = snapshot.width;
+    result.height = snapshot.height;
+    result.scale_factor = snapshot.scale_factor;
+    result.flags = snapshot.flags;
+  }
+  return result;
+}
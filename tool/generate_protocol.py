@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+"""Generates the C++ and Dart stubs of protocol/window_manager.idl.
+
+Usage: python3 tool/generate_protocol.py
+
+Writes common/window_manager_protocol.h, included by the Linux and Windows
+plugins, and lib/src/window_manager_protocol.dart. Both use the codec of
+common/protocol_codec.h and lib/src/protocol_codec.dart.
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+IDL_PATH = os.path.join(ROOT, 'protocol', 'window_manager.idl')
+CPP_PATH = os.path.join(ROOT, 'common', 'window_manager_protocol.h')
+DART_PATH = os.path.join(ROOT, 'lib', 'src', 'window_manager_protocol.dart')
+
+PRIMITIVES = {
+    'bool': ('bool', 'bool', 'Bool', 'false'),
+    'int': ('int64_t', 'int', 'Int', '0'),
+    'double': ('double', 'double', 'Double', '0'),
+    'string': ('std::string', 'String', 'String', None),
+}
+
+STRUCT_RE = re.compile(r'struct\s+(\w+)\s*\{([^}]*)\}')
+FIELD_RE = re.compile(r'^\s*(\w+\??)\s+(\w+)\s*$')
+METHOD_RE = re.compile(r'method\s+(\w+)\s*\(([^)]*)\)\s*(?:->\s*(\w+))?\s*;')
+
+HEADER = ('Generated by tool/generate_protocol.py from '
+          'protocol/window_manager.idl.\n{0} Do not edit.\n')
+
+
+class Type:
+
+    def __init__(self, spec, structs):
+        self.optional = spec.endswith('?')
+        self.name = spec.rstrip('?')
+        if self.name not in PRIMITIVES and self.name not in structs:
+            sys.exit('Unknown type: ' + spec)
+
+    @property
+    def is_struct(self):
+        return self.name not in PRIMITIVES
+
+    def cpp(self):
+        base = self.name if self.is_struct else PRIMITIVES[self.name][0]
+        return 'std::optional<%s>' % base if self.optional else base
+
+    def cpp_param(self):
+        if self.is_struct or self.optional or self.name == 'string':
+            return 'const %s&' % self.cpp()
+        return self.cpp()
+
+    def cpp_default(self):
+        if self.optional or self.is_struct:
+            return None
+        return PRIMITIVES[self.name][3]
+
+    def dart(self):
+        base = self.name if self.is_struct else PRIMITIVES[self.name][1]
+        return base + '?' if self.optional else base
+
+    def dart_read(self):
+        if self.is_struct:
+            read = '%s.read(reader)' % self.name
+            closure = '() => ' + read
+        else:
+            read = 'reader.read%s()' % PRIMITIVES[self.name][2]
+            closure = 'reader.read%s' % PRIMITIVES[self.name][2]
+        if self.optional:
+            return 'reader.readOptional(%s)' % closure
+        return read
+
+    def dart_write(self, value):
+        if self.is_struct:
+            write = '(value) => value.write(writer)'
+            direct = '%s.write(writer);' % value
+        else:
+            write = 'writer.write%s' % PRIMITIVES[self.name][2]
+            direct = 'writer.write%s(%s);' % (PRIMITIVES[self.name][2], value)
+        if self.optional:
+            return 'writer.writeOptional(%s, %s);' % (value, write)
+        return direct
+
+
+def snake_case(name):
+    return re.sub(r'(?<!^)(?=[A-Z])', '_', name).lower()
+
+
+def pascal_case(name):
+    return name[0].upper() + name[1:]
+
+
+def parse_fields(text, separator, structs):
+    fields = []
+    for field in filter(None, (f.strip() for f in text.split(separator))):
+        match = FIELD_RE.match(field)
+        if not match:
+            sys.exit('Bad declaration: ' + field)
+        fields.append((Type(match.group(1), structs), match.group(2)))
+    return fields
+
+
+def parse(idl):
+    idl = re.sub(r'//[^\n]*', '', idl)
+    structs = {}
+    for match in STRUCT_RE.finditer(idl):
+        structs[match.group(1)] = None
+    for match in STRUCT_RE.finditer(idl):
+        structs[match.group(1)] = parse_fields(match.group(2), ';', structs)
+    methods = []
+    for match in METHOD_RE.finditer(idl):
+        result = Type(match.group(3), structs) if match.group(3) else None
+        methods.append((match.group(1), parse_fields(match.group(2), ',',
+                                                     structs), result))
+    return structs, methods
+
+
+def generate_cpp(structs, methods):
+    out = ['// ' + HEADER.format('//'), '#ifndef WINDOW_MANAGER_PLUS_V2_COMMON'
+           '_WINDOW_MANAGER_PROTOCOL_H_',
+           '#define WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_MANAGER_PROTOCOL_H_',
+           '', '#include <cstddef>', '#include <cstdint>',
+           '#include <functional>', '#include <optional>', '#include <string>',
+           '#include <vector>', '', '#include "protocol_codec.h"', '',
+           'namespace window_manager_plus_v2 {', 'namespace protocol {', '',
+           'enum class Method : uint16_t {']
+    for index, (name, _, _) in enumerate(methods):
+        out.append('  k%s = %d,' % (pascal_case(name), index))
+    out += ['};', '']
+
+    for name, fields in structs.items():
+        out.append('struct %s {' % name)
+        for type_, field in fields:
+            default = type_.cpp_default()
+            out.append('  %s %s%s;' % (type_.cpp(), snake_case(field),
+                                      ' = ' + default if default else ''))
+        out += ['};', '']
+        out.append('inline bool Read(ProtocolReader* reader, %s* value) {' %
+                   name)
+        reads = ['Read(reader, &value->%s)' % snake_case(f) for _, f in fields]
+        out.append('  return ' + ' &&\n         '.join(reads) + ';')
+        out += ['}', '']
+        out.append(
+            'inline void Write(ProtocolWriter* writer, const %s& value) {' %
+            name)
+        for _, field in fields:
+            out.append('  Write(writer, value.%s);' % snake_case(field))
+        out += ['}', '']
+
+    out += [
+        '// Implemented by the plugin, called with the arguments of a call '
+        'once', '// decoded.', 'class WindowManagerApi {', ' public:',
+        '  virtual ~WindowManagerApi() = default;', ''
+    ]
+    for name, params, result in methods:
+        args = ', '.join('%s %s' % (t.cpp_param(), snake_case(p))
+                         for t, p in params)
+        decl = '  virtual %s %s(%s) = 0;' % (result.cpp() if result else
+                                             'void', pascal_case(name), args)
+        out.append(wrap_cpp(decl))
+    out += ['};', '']
+
+    out += [
+        '// Decodes the call in |message|, calls it on the api of its target '
+        'window,', '// and returns the reply to send back.',
+        'inline std::vector<uint8_t> HandleCall(',
+        '    const std::function<WindowManagerApi*(int64_t)>& api_for_window,',
+        '    const uint8_t* message,', '    size_t size) {',
+        '  ProtocolReader reader(message, size);', '  uint16_t method;',
+        '  int64_t window_id;',
+        '  if (!Read(&reader, &method) || !Read(&reader, &window_id)) {',
+        '    return EncodeErrorReply("bad-message", "Truncated call");', '  }',
+        '  WindowManagerApi* api = api_for_window(window_id);',
+        '  if (api == nullptr) {',
+        '    return EncodeErrorReply("no-window",',
+        '                            "No window " + '
+        'std::to_string(window_id));', '  }', '  ProtocolWriter writer;',
+        '  switch (static_cast<Method>(method)) {'
+    ]
+    for name, params, result in methods:
+        out.append('    case Method::k%s: {' % pascal_case(name))
+        for type_, param in params:
+            default = type_.cpp_default()
+            out.append('      %s %s%s;' % (type_.cpp(), snake_case(param),
+                                          ' = ' + default if default else ''))
+        reads = ['Read(&reader, &%s)' % snake_case(p) for _, p in params]
+        condition = ' || '.join('!' + r for r in reads + ['reader.AtEnd()'])
+        out.append(wrap_cpp('      if (%s) {' % condition, '          '))
+        out += ['        break;', '      }']
+        args = ', '.join(snake_case(p) for _, p in params)
+        if result:
+            out.append(
+                wrap_cpp('      %s result = api->%s(%s);' %
+                         (result.cpp(), pascal_case(name), args)))
+        else:
+            out.append(wrap_cpp('      api->%s(%s);' % (pascal_case(name),
+                                                        args)))
+        out.append('      Write(&writer, kReplyOk);')
+        if result:
+            out.append('      Write(&writer, result);')
+        out += ['      return writer.Take();', '    }']
+    out += [
+        '  }', '  return EncodeErrorReply("bad-message",',
+        '                          "Malformed call of method " + '
+        'std::to_string(method));', '}', '', '}  // namespace protocol',
+        '}  // namespace window_manager_plus_v2', '',
+        '#endif  // WINDOW_MANAGER_PLUS_V2_COMMON_WINDOW_MANAGER_PROTOCOL_H_'
+    ]
+    return '\n'.join(out) + '\n'
+
+
+def wrap_cpp(line, continuation=None):
+    """Breaks |line| after its commas or || to fit in 80 columns."""
+    if len(line) <= 80:
+        return line
+    if continuation is None:
+        continuation = ' ' * (line.index('(') + 1)
+    parts = re.split(r'(?<=, )|(?<= \|\| )', line)
+    lines = [parts[0]]
+    for part in parts[1:]:
+        if len(lines[-1]) + len(part) > 80:
+            lines[-1] = lines[-1].rstrip()
+            lines.append(continuation + part)
+        else:
+            lines[-1] += part
+    return '\n'.join(lines)
+
+
+def generate_dart(structs, methods):
+    out = [
+        '// ' + HEADER.format('//'), "import 'package:flutter/services.dart';",
+        "import 'package:window_manager_plus_v2/src/protocol_codec.dart';", ''
+    ]
+    for name, fields in structs.items():
+        out += ['class %s {' % name, '  const %s({' % name]
+        for type_, field in fields:
+            out.append('    %sthis.%s,' % (
+                '' if type_.optional else 'required ', field))
+        out += ['  });', '']
+        out.append('  factory %s.read(ProtocolReader reader) => %s(' %
+                   (name, name))
+        for type_, field in fields:
+            out.append('        %s: %s,' % (field, type_.dart_read()))
+        out += ['      );', '']
+        for type_, field in fields:
+            out.append('  final %s %s;' % (type_.dart(), field))
+        out += ['', '  void write(ProtocolWriter writer) {']
+        for type_, field in fields:
+            out.append('    ' + type_.dart_write(field))
+        out += ['  }', '}', '']
+
+    out += [
+        '/// The calls of protocol/window_manager.idl to the window '
+        '[windowId].', 'class WindowManagerProtocol {',
+        '  WindowManagerProtocol(String channelName, this.windowId)',
+        '      : _channel = BasicMessageChannel<ByteData?>(',
+        '          channelName,', '          const BinaryCodec(),',
+        '        );', '', '  final BasicMessageChannel<ByteData?> _channel;',
+        '  final int windowId;'
+    ]
+    for index, (name, params, result) in enumerate(methods):
+        out.append('')
+        returns = 'Future<%s>' % (result.dart() if result else 'void')
+        args = ', '.join('%s %s' % (t.dart(), p) for t, p in params)
+        signature = '  %s %s(%s) async {' % (returns, name, args)
+        if len(signature) > 80:
+            signature = '  %s %s(\n%s\n  ) async {' % (returns, name, '\n'.join(
+                '    %s %s,' % (t.dart(), p) for t, p in params))
+        out.append(signature)
+        out.append('    final writer = ProtocolWriter.call(%d, windowId);' %
+                   index)
+        for type_, param in params:
+            out.append('    ' + type_.dart_write(param))
+        if result:
+            out.append(
+                '    final reader = await sendProtocolCall(_channel, writer);')
+            out.append('    return %s;' % result.dart_read())
+        else:
+            out.append('    await sendProtocolCall(_channel, writer);')
+        out.append('  }')
+    out.append('}')
+    return '\n'.join(out) + '\n'
+
+
+def write(path, content):
+    with open(path, 'w', newline='\n') as file:
+        file.write(content)
+
+
+def main():
+    with open(IDL_PATH) as file:
+        structs, methods = parse(file.read())
+    write(CPP_PATH, generate_cpp(structs, methods))
+    write(DART_PATH, generate_dart(structs, methods))
+
+
+if __name__ == '__main__':
+    main()
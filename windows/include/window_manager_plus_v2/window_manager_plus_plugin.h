@@ -39,6 +39,35 @@ typedef std::shared_ptr<FlutterWindow> (
 FLUTTER_PLUGIN_EXPORT void WindowManagerPlusPluginSetWindowCreatedCallback(
     WindowManagerPlusPluginWindowCreatedCallback callback);
 
+// Bits of WindowManagerPlusSnapshot::flags.
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_PUBLISHED (1 << 0)
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_FOCUSED (1 << 1)
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_VISIBLE (1 << 2)
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_MAXIMIZED (1 << 3)
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_MINIMIZED (1 << 4)
+#define WINDOW_MANAGER_PLUS_SNAPSHOT_FULL_SCREEN (1 << 5)
+
+typedef struct {
+  // Bounds of the window in logical pixels.
+  double x;
+  double y;
+  double width;
+  double height;
+  // Physical pixels per logical pixel.
+  double scale_factor;
+  uint32_t flags;
+} WindowManagerPlusSnapshot;
+
+// Returns the state of the window |window_id| as of the last message
+// handled by the platform thread, without a round trip through the method
+// channel. It is meant for dart:ffi and may be called from any thread: it
+// reads a copy that the platform thread publishes, never the HWND, and it
+// neither blocks nor allocates. flags lacks
+// WINDOW_MANAGER_PLUS_SNAPSHOT_PUBLISHED when no window |window_id| was
+// initialized by Dart.
+FLUTTER_PLUGIN_EXPORT WindowManagerPlusSnapshot
+WindowManagerPlusPluginGetSnapshot(int64_t window_id);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -2,8 +2,11 @@
 #pragma once
 
 #include <Windows.h>
+#include <commctrl.h>
+#include <windowsx.h>
 
 #include <flutter/method_channel.h>
+#include <flutter/method_result_functions.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
@@ -15,12 +18,23 @@
 
 #include "window_manager_plus_v2.h"
 
+#include <ShlObj.h>
+
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "shcore.lib")
 #pragma comment(lib, "Gdi32.lib")
+#pragma comment(lib, "comctl32.lib")
 
 /// Window attribute that enables dark mode window decorations.
 ///
@@ -45,11 +59,541 @@ constexpr const wchar_t kGetPreferredBrightnessRegValue[] =
 
 #define APPBAR_CALLBACK WM_USER + 0x01;
 
+/// Name of the optional asset, relative to the bundle's `data\flutter_assets`
+/// directory, holding the options applied before the window is first shown.
+constexpr const wchar_t kInitialWindowOptionsFile[] = L"window_options.ini";
+constexpr const wchar_t kInitialWindowOptionsSection[] = L"Window";
+
+/// Names of the files, inside `%LOCALAPPDATA%\<executable name>`, in which the
+/// geometry of the windows with a persistence key and the named layouts are
+/// saved.
+constexpr const wchar_t kGeometryStoreFile[] = L"window_geometry.ini";
+constexpr const wchar_t kLayoutStoreFile[] = L"window_layouts.ini";
+
 namespace window_manager_plus_v2 {
 
 WindowManagerPlusPluginWindowCreatedCallback g_window_created_callback =
     nullptr;
 
+std::wstring GetStorePath(const wchar_t* file_name) {
+  PWSTR local_app_data = nullptr;
+  if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr,
+                                  &local_app_data))) {
+    return L"";
+  }
+  std::wstring directory(local_app_data);
+  CoTaskMemFree(local_app_data);
+
+  wchar_t executable[MAX_PATH];
+  if (GetModuleFileName(nullptr, executable, MAX_PATH) == 0) {
+    return L"";
+  }
+  std::wstring name(executable);
+  name = name.substr(name.find_last_of(L"\\") + 1);
+  name = name.substr(0, name.find_last_of(L"."));
+
+  directory += L"\\" + name;
+  CreateDirectory(directory.c_str(), nullptr);
+  return directory + L"\\" + file_name;
+}
+
+void ReadStore(WindowGeometryStore& store, const wchar_t* file_name) {
+  std::ifstream file(GetStorePath(file_name), std::ios::binary);
+  if (file) {
+    std::stringstream contents;
+    contents << file.rdbuf();
+    store.Parse(contents.str());
+  }
+}
+
+void WriteStore(const WindowGeometryStore& store, const wchar_t* file_name) {
+  std::wstring path = GetStorePath(file_name);
+  if (path.empty()) {
+    return;
+  }
+  // Write to a temporary file and swap it in, so that a crash in the middle
+  // of a save never leaves a truncated file behind.
+  std::wstring temp_path = path + L".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file << store.Serialize();
+    if (!file.flush()) {
+      return;
+    }
+  }
+  MoveFileEx(temp_path.c_str(), path.c_str(),
+             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+// The geometry of every window of the process is kept in one small file.
+WindowGeometryStore& GetGeometryStore() {
+  static WindowGeometryStore store;
+  static bool is_loaded = false;
+  if (!is_loaded) {
+    is_loaded = true;
+    ReadStore(store, kGeometryStoreFile);
+  }
+  return store;
+}
+
+WindowGeometryStore& GetLayoutStore() {
+  static WindowGeometryStore store;
+  static bool is_loaded = false;
+  if (!is_loaded) {
+    is_loaded = true;
+    ReadStore(store, kLayoutStoreFile);
+  }
+  return store;
+}
+
+std::string GetMonitorDevice(HMONITOR monitor) {
+  MONITORINFOEX monitor_info = {};
+  monitor_info.cbSize = sizeof(MONITORINFOEX);
+  if (monitor == nullptr || !GetMonitorInfo(monitor, &monitor_info)) {
+    return "";
+  }
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  return converter.to_bytes(monitor_info.szDevice);
+}
+
+// WINDOWPLACEMENT uses workspace coordinates, which are offset from screen
+// coordinates by the taskbar when it is docked to the top or the left.
+POINT GetWorkspaceOffset(HWND hWnd) {
+  MONITORINFO monitor_info = {sizeof(MONITORINFO)};
+  if ((GetWindowLong(hWnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) != 0 ||
+      !GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST),
+                      &monitor_info)) {
+    return {0, 0};
+  }
+  return {monitor_info.rcWork.left - monitor_info.rcMonitor.left,
+          monitor_info.rcWork.top - monitor_info.rcMonitor.top};
+}
+
+// Loaded dynamically to keep Windows 7 support.
+UINT GetDpiForMonitorOrDefault(HMONITOR monitor) {
+  UINT newDpiX = 96;  // Default values
+  UINT newDpiY = 96;
+
+  HMODULE shcore = LoadLibrary(TEXT("shcore.dll"));
+  if (shcore) {
+    typedef HRESULT (*GetDpiForMonitor)(HMONITOR, int, UINT*, UINT*);
+
+    GetDpiForMonitor GetDpiForMonitorFunc =
+        (GetDpiForMonitor)GetProcAddress(shcore, "GetDpiForMonitor");
+
+    if (GetDpiForMonitorFunc) {
+      // Use the loaded function if available
+      const int MDT_EFFECTIVE_DPI = 0;
+      if (FAILED(GetDpiForMonitorFunc(monitor, MDT_EFFECTIVE_DPI, &newDpiX,
+                                      &newDpiY))) {
+        // If it fails, set the default values again
+        newDpiX = 96;
+        newDpiY = 96;
+      }
+    }
+    FreeLibrary(shcore);
+  }
+  return newDpiX;
+}
+
+Rect RectFromRECT(const RECT& rect) {
+  return {static_cast<double>(rect.left), static_cast<double>(rect.top),
+          static_cast<double>(rect.right - rect.left),
+          static_cast<double>(rect.bottom - rect.top)};
+}
+
+BOOL CALLBACK AddDisplay(HMONITOR monitor, HDC, LPRECT, LPARAM data) {
+  auto* displays = reinterpret_cast<std::vector<Display>*>(data);
+  MONITORINFOEX monitor_info = {};
+  monitor_info.cbSize = sizeof(MONITORINFOEX);
+  if (!GetMonitorInfo(monitor, &monitor_info)) {
+    return TRUE;
+  }
+
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  Display display;
+  display.id = converter.to_bytes(monitor_info.szDevice);
+  DISPLAY_DEVICE device = {sizeof(DISPLAY_DEVICE)};
+  display.name = EnumDisplayDevices(monitor_info.szDevice, 0, &device, 0)
+                     ? converter.to_bytes(device.DeviceString)
+                     : display.id;
+  display.bounds = RectFromRECT(monitor_info.rcMonitor);
+  display.work_area = RectFromRECT(monitor_info.rcWork);
+  display.scale_factor = GetDpiForMonitorOrDefault(monitor) / 96.0;
+  display.is_primary = (monitor_info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+  displays->push_back(display);
+  return TRUE;
+}
+
+// Bounds of the window without the invisible resize borders of standard
+// frames, which is what the user sees and expects to snap.
+RECT GetVisibleBounds(HWND hWnd) {
+  RECT rect;
+  if (FAILED(DwmGetWindowAttribute(hWnd, DWMWA_EXTENDED_FRAME_BOUNDS, &rect,
+                                   sizeof(rect)))) {
+    GetWindowRect(hWnd, &rect);
+  }
+  return rect;
+}
+
+struct CachedIcon {
+  uint64_t write_time = 0;
+  HICON small_icon = nullptr;
+  HICON large_icon = nullptr;
+};
+
+struct LoadedIcon {
+  uint64_t generation;
+  HICON small_icon;
+  HICON large_icon;
+};
+
+std::mutex& GetIconCacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Icons decoded by the workers, keyed by path and sizes. Guarded by
+// GetIconCacheMutex, like the stale icons.
+std::map<std::wstring, CachedIcon>& GetIconCache() {
+  static std::map<std::wstring, CachedIcon> cache;
+  return cache;
+}
+
+// Icons replaced in the cache, destroyed on the main thread once no window
+// uses them anymore.
+std::vector<HICON>& GetStaleIcons() {
+  static std::vector<HICON> icons;
+  return icons;
+}
+
+// Runs on a worker thread. Decodes the icon unless the cache already holds
+// it for the current version of the file.
+bool LoadIconFile(const std::wstring& path,
+                  int small_size,
+                  int large_size,
+                  CachedIcon* icon) {
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data)) {
+    return false;
+  }
+  uint64_t write_time =
+      (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+      data.ftLastWriteTime.dwLowDateTime;
+  std::wstring key = path + L"|" + std::to_wstring(small_size) + L"|" +
+                     std::to_wstring(large_size);
+  {
+    std::lock_guard<std::mutex> lock(GetIconCacheMutex());
+    auto it = GetIconCache().find(key);
+    if (it != GetIconCache().end() && it->second.write_time == write_time) {
+      *icon = it->second;
+      return true;
+    }
+  }
+
+  CachedIcon decoded;
+  decoded.write_time = write_time;
+  decoded.small_icon = static_cast<HICON>(LoadImage(
+      nullptr, path.c_str(), IMAGE_ICON, small_size, small_size,
+      LR_LOADFROMFILE));
+  decoded.large_icon = static_cast<HICON>(LoadImage(
+      nullptr, path.c_str(), IMAGE_ICON, large_size, large_size,
+      LR_LOADFROMFILE));
+  if (decoded.small_icon == nullptr && decoded.large_icon == nullptr) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(GetIconCacheMutex());
+  CachedIcon& entry = GetIconCache()[key];
+  for (HICON stale : {entry.small_icon, entry.large_icon}) {
+    if (stale != nullptr) {
+      GetStaleIcons().push_back(stale);
+    }
+  }
+  entry = decoded;
+  *icon = decoded;
+  return true;
+}
+
+// Called on the main thread after installing an icon.
+void DestroyStaleIcons(
+    const std::map<int64_t, std::shared_ptr<WindowManagerPlus>>& managers) {
+  std::lock_guard<std::mutex> lock(GetIconCacheMutex());
+  auto& stale_icons = GetStaleIcons();
+  auto is_in_use = [&managers](HICON icon) {
+    for (const auto& [id, manager] : managers) {
+      HWND hWnd = manager->GetMainWindow();
+      if (hWnd != nullptr &&
+          (reinterpret_cast<HICON>(
+               SendMessage(hWnd, WM_GETICON, ICON_SMALL, 0)) == icon ||
+           reinterpret_cast<HICON>(SendMessage(hWnd, WM_GETICON, ICON_BIG,
+                                               0)) == icon)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  stale_icons.erase(std::remove_if(stale_icons.begin(), stale_icons.end(),
+                                   [&is_in_use](HICON icon) {
+                                     if (is_in_use(icon)) {
+                                       return false;
+                                     }
+                                     DestroyIcon(icon);
+                                     return true;
+                                   }),
+                    stale_icons.end());
+}
+
+// Creates an icon of about |size| pixels from straight-alpha RGBA pixels,
+// halving the image while it stays at least twice as large. It's halved
+// premultiplied so that transparent pixels don't darken the edges.
+HICON CreateIconFromRgba(const uint8_t* pixels,
+                         int width,
+                         int height,
+                         int size) {
+  auto is_halved = [&]() {
+    return std::max(width, height) / 2 >= size && std::min(width, height) >= 2;
+  };
+  std::vector<uint8_t> buffer;
+  if (is_halved()) {
+    buffer.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    Premultiply(buffer.data(), static_cast<size_t>(width) * height);
+    pixels = buffer.data();
+    while (is_halved()) {
+      std::vector<uint8_t> half(static_cast<size_t>(width / 2) *
+                                (height / 2) * 4);
+      HalveImage(pixels, static_cast<size_t>(width) * 4, width, height,
+                 half.data(), static_cast<size_t>(width / 2) * 4);
+      buffer.swap(half);
+      pixels = buffer.data();
+      width /= 2;
+      height /= 2;
+    }
+    Unpremultiply(buffer.data(), static_cast<size_t>(width) * height);
+  }
+
+  BITMAPV5HEADER header = {};
+  header.bV5Size = sizeof(BITMAPV5HEADER);
+  header.bV5Width = width;
+  header.bV5Height = -height;  // Top-down.
+  header.bV5Planes = 1;
+  header.bV5BitCount = 32;
+  header.bV5Compression = BI_BITFIELDS;
+  header.bV5RedMask = 0x00FF0000;
+  header.bV5GreenMask = 0x0000FF00;
+  header.bV5BlueMask = 0x000000FF;
+  header.bV5AlphaMask = 0xFF000000;
+  void* bits = nullptr;
+  HDC hdc = GetDC(nullptr);
+  HBITMAP color = CreateDIBSection(hdc, reinterpret_cast<BITMAPINFO*>(&header),
+                                   DIB_RGB_COLORS, &bits, nullptr, 0);
+  ReleaseDC(nullptr, hdc);
+  if (color == nullptr) {
+    return nullptr;
+  }
+  // The DIB is BGRA, convert straight into it.
+  SwapRedBlue(pixels, static_cast<uint8_t*>(bits),
+              static_cast<size_t>(width) * height);
+
+  HBITMAP mask = CreateBitmap(width, height, 1, 1, nullptr);
+  ICONINFO info = {TRUE, 0, 0, mask, color};
+  HICON icon = CreateIconIndirect(&info);
+  DeleteObject(mask);
+  DeleteObject(color);
+  return icon;
+}
+
+// Captures the visible frame of |hWnd|, without the invisible resize
+// borders, as opaque BGRA. GDI leaves the alpha channel undefined, so it's
+// made opaque, which is the same premultiplied or not.
+bool CaptureWindowPixels(HWND hWnd,
+                         int* width,
+                         int* height,
+                         std::vector<uint8_t>* pixels) {
+  if (!IsWindowVisible(hWnd) || IsIconic(hWnd)) {
+    return false;
+  }
+  RECT window_rect;
+  GetWindowRect(hWnd, &window_rect);
+  RECT visible = GetVisibleBounds(hWnd);
+  *width = visible.right - visible.left;
+  *height = visible.bottom - visible.top;
+  if (*width <= 0 || *height <= 0) {
+    return false;
+  }
+
+  BITMAPINFO info = {};
+  info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+  info.bmiHeader.biWidth = *width;
+  info.bmiHeader.biHeight = -*height;  // Top-down.
+  info.bmiHeader.biPlanes = 1;
+  info.bmiHeader.biBitCount = 32;
+  info.bmiHeader.biCompression = BI_RGB;
+  void* bits = nullptr;
+  HDC screen = GetDC(nullptr);
+  HBITMAP bitmap =
+      CreateDIBSection(screen, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+  HDC memory = CreateCompatibleDC(screen);
+  ReleaseDC(nullptr, screen);
+  if (bitmap == nullptr) {
+    DeleteDC(memory);
+    return false;
+  }
+  HGDIOBJ previous = SelectObject(memory, bitmap);
+  SetViewportOrgEx(memory, window_rect.left - visible.left,
+                   window_rect.top - visible.top, nullptr);
+  // PW_RENDERFULLCONTENT, which also captures DirectComposition content such
+  // as the Flutter view, is missing from older SDKs.
+  bool is_captured = PrintWindow(hWnd, memory, 0x00000002) != FALSE;
+  GdiFlush();
+  if (is_captured) {
+    size_t count = static_cast<size_t>(*width) * *height;
+    auto* data = static_cast<uint8_t*>(bits);
+    SetOpaque(data, count);
+    pixels->assign(data, data + count * 4);
+  }
+  SelectObject(memory, previous);
+  DeleteObject(bitmap);
+  DeleteDC(memory);
+  return is_captured;
+}
+
+int64_t MonotonicMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+flutter::EncodableValue LatencyHistogramToValue(
+    const LatencyHistogram& histogram) {
+  std::vector<int64_t> buckets(LatencyHistogram::kBucketCount);
+  for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+    buckets[i] = histogram.bucket(i);
+  }
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("count"),
+       flutter::EncodableValue(histogram.count())},
+      {flutter::EncodableValue("minUs"),
+       flutter::EncodableValue(histogram.min_us())},
+      {flutter::EncodableValue("maxUs"),
+       flutter::EncodableValue(histogram.max_us())},
+      {flutter::EncodableValue("meanUs"),
+       flutter::EncodableValue(histogram.mean_us())},
+      {flutter::EncodableValue("p50Us"),
+       flutter::EncodableValue(histogram.Percentile(0.5))},
+      {flutter::EncodableValue("p90Us"),
+       flutter::EncodableValue(histogram.Percentile(0.9))},
+      {flutter::EncodableValue("p99Us"),
+       flutter::EncodableValue(histogram.Percentile(0.99))},
+      {flutter::EncodableValue("buckets"),
+       flutter::EncodableValue(std::move(buckets))},
+  });
+}
+
+// Builds a region of client pixels from |rects| in a single call.
+HRGN CreateRegionFromRects(const std::vector<PixelRect>& rects) {
+  std::vector<uint8_t> buffer(sizeof(RGNDATAHEADER) +
+                              rects.size() * sizeof(RECT));
+  auto* data = reinterpret_cast<RGNDATA*>(buffer.data());
+  data->rdh.dwSize = sizeof(RGNDATAHEADER);
+  data->rdh.iType = RDH_RECTANGLES;
+  data->rdh.nCount = static_cast<DWORD>(rects.size());
+  data->rdh.nRgnSize = static_cast<DWORD>(rects.size() * sizeof(RECT));
+  auto* out = reinterpret_cast<RECT*>(data->Buffer);
+  RECT bounds = {0, 0, 0, 0};
+  for (size_t i = 0; i < rects.size(); i++) {
+    out[i] = {rects[i].x, rects[i].y, rects[i].x + rects[i].width,
+              rects[i].y + rects[i].height};
+    UnionRect(&bounds, &bounds, &out[i]);
+  }
+  data->rdh.rcBound = bounds;
+  return ExtCreateRegion(nullptr, static_cast<DWORD>(buffer.size()), data);
+}
+
+constexpr UINT_PTR kHitTestSubclassId = 1;
+
+// The Flutter view covers the client area and gets every WM_NCHITTEST, it
+// lets the drag regions and the resize border through to the top-level
+// window, which reports them as its caption and borders.
+LRESULT CALLBACK HitTestSubclassProc(HWND hWnd,
+                                     UINT message,
+                                     WPARAM wParam,
+                                     LPARAM lParam,
+                                     UINT_PTR subclass_id,
+                                     DWORD_PTR ref_data) {
+  if (message == WM_NCHITTEST &&
+      reinterpret_cast<WindowManagerPlus*>(ref_data)->HitTestView(lParam) !=
+          HTCLIENT) {
+    return HTTRANSPARENT;
+  }
+  return DefSubclassProc(hWnd, message, wParam, lParam);
+}
+
+LRESULT HitTestCodeFromEdge(ResizeEdge edge) {
+  switch (edge) {
+    case ResizeEdge::kTop:
+      return HTTOP;
+    case ResizeEdge::kBottom:
+      return HTBOTTOM;
+    case ResizeEdge::kLeft:
+      return HTLEFT;
+    case ResizeEdge::kRight:
+      return HTRIGHT;
+    case ResizeEdge::kTopLeft:
+      return HTTOPLEFT;
+    case ResizeEdge::kTopRight:
+      return HTTOPRIGHT;
+    case ResizeEdge::kBottomLeft:
+      return HTBOTTOMLEFT;
+    case ResizeEdge::kBottomRight:
+      return HTBOTTOMRIGHT;
+    default:
+      return HTCLIENT;
+  }
+}
+
+struct WindowMove {
+  HWND hwnd;
+  HWND insert_after;
+  RECT rect;
+  UINT flags;
+};
+
+// Moves, resizes, stacks and shows or hides every window in a single
+// DeferWindowPos batch, so that no intermediate arrangement is painted.
+void MoveWindowsTogether(const std::vector<WindowMove>& moves) {
+  HDWP hdwp = BeginDeferWindowPos(static_cast<int>(moves.size()));
+  for (const auto& move : moves) {
+    if (hdwp == nullptr) {
+      break;
+    }
+    hdwp = DeferWindowPos(hdwp, move.hwnd, move.insert_after, move.rect.left,
+                          move.rect.top, move.rect.right - move.rect.left,
+                          move.rect.bottom - move.rect.top, move.flags);
+  }
+  if (hdwp == nullptr || !EndDeferWindowPos(hdwp)) {
+    // The batch was dropped as a whole, move the windows one by one.
+    for (const auto& move : moves) {
+      SetWindowPos(move.hwnd, move.insert_after, move.rect.left, move.rect.top,
+                   move.rect.right - move.rect.left,
+                   move.rect.bottom - move.rect.top, move.flags);
+    }
+  }
+}
+
+// Moving a maximized or minimized window would change its current bounds,
+// its normal bounds (in screen coordinates) are set through its placement.
+void SetNormalBounds(HWND hWnd, const RECT& rect, UINT show_cmd) {
+  WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+  GetWindowPlacement(hWnd, &placement);
+  POINT offset = GetWorkspaceOffset(hWnd);
+  placement.rcNormalPosition = rect;
+  OffsetRect(&placement.rcNormalPosition, -offset.x, -offset.y);
+  placement.flags = 0;
+  placement.showCmd = show_cmd;
+  SetWindowPlacement(hWnd, &placement);
+}
+
 const flutter::EncodableValue* ValueOrNull(const flutter::EncodableMap& map,
                                            const char* key) {
   auto it = map.find(flutter::EncodableValue(key));
@@ -65,6 +609,13 @@ WindowManagerPlus::~WindowManagerPlus() {
 #ifndef NDEBUG
   std::cout << "WindowManager dealloc" << std::endl;
 #endif
+  if (hit_test_view_ != nullptr && IsWindow(hit_test_view_)) {
+    RemoveWindowSubclass(hit_test_view_, HitTestSubclassProc,
+                         kHitTestSubclassId);
+  }
+  if (input_hrgn_ != nullptr) {
+    DeleteObject(input_hrgn_);
+  }
 }
 
 int64_t WindowManagerPlus::createWindow(const std::vector<std::string>& args) {
@@ -88,6 +639,253 @@ HWND WindowManagerPlus::GetMainWindow() {
   return native_window;
 }
 
+// static
+flutter::EncodableMap WindowManagerPlus::SaveLayout(const std::string& name) {
+  WindowLayout layout;
+  for (const auto& [id, manager] : windowManagers_) {
+    HWND hWnd = manager->GetMainWindow();
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    if (hWnd == nullptr || !GetWindowPlacement(hWnd, &placement)) {
+      continue;
+    }
+    POINT offset = GetWorkspaceOffset(hWnd);
+    const RECT& rect = placement.rcNormalPosition;
+    WindowGeometry& geometry = layout[id];
+    geometry.x = rect.left + offset.x;
+    geometry.y = rect.top + offset.y;
+    geometry.width = rect.right - rect.left;
+    geometry.height = rect.bottom - rect.top;
+    geometry.maximized = placement.showCmd == SW_SHOWMAXIMIZED;
+    geometry.full_screen = manager->IsFullScreen();
+    geometry.visible = IsWindowVisible(hWnd) != FALSE;
+    geometry.always_on_top = manager->IsAlwaysOnTop();
+    geometry.monitor =
+        GetMonitorDevice(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST));
+  }
+
+  WindowGeometryStore& store = GetLayoutStore();
+  if (SetLayout(store, name, layout)) {
+    WriteStore(store, kLayoutStoreFile);
+  }
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("windowCount"),
+       flutter::EncodableValue(static_cast<int64_t>(layout.size()))}};
+}
+
+// static
+std::optional<flutter::EncodableMap> WindowManagerPlus::ApplyLayout(
+    const std::string& name) {
+  auto start = std::chrono::steady_clock::now();
+  WindowLayout layout = FindLayout(GetLayoutStore(), name);
+  if (layout.empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<std::pair<std::shared_ptr<WindowManagerPlus>,
+                        const WindowGeometry*>>
+      targets;
+  std::vector<WindowMove> moves;
+  for (const auto& [id, geometry] : layout) {
+    auto it = windowManagers_.find(id);
+    if (it == windowManagers_.end() || it->second->GetMainWindow() == nullptr) {
+      continue;
+    }
+    auto manager = it->second;
+    HWND hWnd = manager->GetMainWindow();
+    // Leaving full screen restores the window style, do it before the batch.
+    if (manager->IsFullScreen() && !geometry.full_screen) {
+      manager->SetFullScreen({{flutter::EncodableValue("isFullScreen"),
+                               flutter::EncodableValue(false)}});
+    }
+
+    WindowMove move = {hWnd,
+                       geometry.always_on_top ? HWND_TOPMOST : HWND_NOTOPMOST,
+                       {static_cast<LONG>(geometry.x),
+                        static_cast<LONG>(geometry.y),
+                        static_cast<LONG>(geometry.x + geometry.width),
+                        static_cast<LONG>(geometry.y + geometry.height)},
+                       static_cast<UINT>(
+                           SWP_NOACTIVATE |
+                           (geometry.visible ? SWP_SHOWWINDOW
+                                             : SWP_HIDEWINDOW))};
+    if (IsZoomed(hWnd) || IsIconic(hWnd)) {
+      SetNormalBounds(hWnd, move.rect,
+                      !geometry.visible     ? SW_HIDE
+                      : geometry.maximized ? SW_SHOWMAXIMIZED
+                                           : SW_SHOWNOACTIVATE);
+      move.flags |= SWP_NOMOVE | SWP_NOSIZE;
+    }
+    targets.emplace_back(manager, &geometry);
+    moves.push_back(move);
+  }
+
+  MoveWindowsTogether(moves);
+
+  for (const auto& [manager, geometry] : targets) {
+    HWND hWnd = manager->GetMainWindow();
+    if (geometry->visible && geometry->maximized && !IsZoomed(hWnd)) {
+      ShowWindow(hWnd, SW_MAXIMIZE);
+    }
+    if (geometry->full_screen && !manager->IsFullScreen()) {
+      manager->SetFullScreen({{flutter::EncodableValue("isFullScreen"),
+                               flutter::EncodableValue(true)}});
+    }
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("windowCount"),
+       flutter::EncodableValue(static_cast<int64_t>(moves.size()))},
+      {flutter::EncodableValue("elapsedMicros"),
+       flutter::EncodableValue(static_cast<int64_t>(elapsed.count()))}};
+}
+
+// static
+std::optional<flutter::EncodableMap> WindowManagerPlus::TileWindows(
+    const std::vector<int64_t>& window_ids,
+    const TilingOptions& options,
+    const std::string& display_id) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<HWND> windows;
+  std::vector<TileConstraints> constraints;
+  for (int64_t id : window_ids) {
+    auto it = windowManagers_.find(id);
+    if (it == windowManagers_.end() || it->second->GetMainWindow() == nullptr) {
+      continue;
+    }
+    auto manager = it->second;
+    if (manager->IsFullScreen()) {
+      manager->SetFullScreen({{flutter::EncodableValue("isFullScreen"),
+                               flutter::EncodableValue(false)}});
+    }
+    // The size limits are kept in logical pixels, the tiles are physical.
+    double ratio = manager->pixel_ratio_;
+    TileConstraints constraint;
+    constraint.min_width = manager->minimum_size_.x * ratio;
+    constraint.min_height = manager->minimum_size_.y * ratio;
+    if (manager->maximum_size_.x != -1) {
+      constraint.max_width = manager->maximum_size_.x * ratio;
+    }
+    if (manager->maximum_size_.y != -1) {
+      constraint.max_height = manager->maximum_size_.y * ratio;
+    }
+    constraint.aspect_ratio = manager->aspect_ratio_;
+    windows.push_back(manager->GetMainWindow());
+    constraints.push_back(constraint);
+  }
+  if (windows.empty()) {
+    return std::nullopt;
+  }
+
+  const DisplayTopology& topology = GetDisplayTopology();
+  const Display* display = nullptr;
+  if (display_id.empty()) {
+    RECT rect;
+    GetWindowRect(windows.front(), &rect);
+    display = topology.FindByRect(RectFromRECT(rect));
+  } else {
+    for (const Display& candidate : topology.displays()) {
+      if (candidate.id == display_id) {
+        display = &candidate;
+      }
+    }
+  }
+  if (display == nullptr) {
+    return std::nullopt;
+  }
+
+  // The gap comes in logical pixels.
+  TilingOptions physical_options = options;
+  physical_options.gap *= display->scale_factor;
+  std::vector<Rect> tiles =
+      SolveTiling(display->work_area, constraints, physical_options);
+  auto solved = std::chrono::steady_clock::now();
+
+  std::vector<WindowMove> moves;
+  for (size_t i = 0; i < windows.size(); i++) {
+    WindowMove move = {
+        windows[i],
+        nullptr,
+        {static_cast<LONG>(std::lround(tiles[i].x)),
+         static_cast<LONG>(std::lround(tiles[i].y)),
+         static_cast<LONG>(std::lround(tiles[i].right())),
+         static_cast<LONG>(std::lround(tiles[i].bottom()))},
+        SWP_NOACTIVATE | SWP_NOZORDER};
+    if (IsZoomed(windows[i]) || IsIconic(windows[i])) {
+      SetNormalBounds(windows[i], move.rect, SW_SHOWNOACTIVATE);
+      move.flags |= SWP_NOMOVE | SWP_NOSIZE;
+    }
+    moves.push_back(move);
+  }
+  MoveWindowsTogether(moves);
+
+  auto end = std::chrono::steady_clock::now();
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("windowCount"),
+       flutter::EncodableValue(static_cast<int64_t>(moves.size()))},
+      {flutter::EncodableValue("solveMicros"),
+       flutter::EncodableValue(static_cast<int64_t>(
+           std::chrono::duration_cast<std::chrono::microseconds>(solved -
+                                                                 start)
+               .count()))},
+      {flutter::EncodableValue("elapsedMicros"),
+       flutter::EncodableValue(static_cast<int64_t>(
+           std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+               .count()))}};
+}
+
+// static
+const DisplayTopology& WindowManagerPlus::GetDisplayTopology() {
+  if (!display_topology_.IsValid()) {
+    std::vector<Display> displays;
+    EnumDisplayMonitors(nullptr, nullptr, AddDisplay,
+                        reinterpret_cast<LPARAM>(&displays));
+    display_topology_.Reset(std::move(displays));
+  }
+  return display_topology_;
+}
+
+// static
+void WindowManagerPlus::InvalidateDisplayTopology() {
+  display_topology_.Invalidate();
+}
+
+// static
+flutter::EncodableList WindowManagerPlus::GetDisplays() {
+  // Reported in logical pixels, like screen_retriever does.
+  auto to_size = [](const Rect& rect, double scale) {
+    return flutter::EncodableMap{
+        {flutter::EncodableValue("width"),
+         flutter::EncodableValue(rect.width / scale)},
+        {flutter::EncodableValue("height"),
+         flutter::EncodableValue(rect.height / scale)}};
+  };
+  flutter::EncodableList result;
+  for (const Display& display : GetDisplayTopology().displays()) {
+    double scale = display.scale_factor > 0 ? display.scale_factor : 1;
+    result.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("id"), flutter::EncodableValue(display.id)},
+        {flutter::EncodableValue("name"),
+         flutter::EncodableValue(display.name)},
+        {flutter::EncodableValue("size"),
+         flutter::EncodableValue(to_size(display.bounds, scale))},
+        {flutter::EncodableValue("visiblePosition"),
+         flutter::EncodableValue(flutter::EncodableMap{
+             {flutter::EncodableValue("dx"),
+              flutter::EncodableValue(display.work_area.x / scale)},
+             {flutter::EncodableValue("dy"),
+              flutter::EncodableValue(display.work_area.y / scale)}})},
+        {flutter::EncodableValue("visibleSize"),
+         flutter::EncodableValue(to_size(display.work_area, scale))},
+        {flutter::EncodableValue("scaleFactor"),
+         flutter::EncodableValue(display.scale_factor)},
+        {flutter::EncodableValue("isPrimary"),
+         flutter::EncodableValue(display.is_primary)}}));
+  }
+  return result;
+}
+
 void WindowManagerPlus::ForceRefresh() {
   HWND hWnd = GetMainWindow();
 
@@ -283,32 +1081,8 @@ int WindowManagerPlus::IsDocked() {
 }
 
 double WindowManagerPlus::GetDpiForHwnd(HWND hWnd) {
-  auto monitor = MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST);
-  UINT newDpiX = 96;  // Default values
-  UINT newDpiY = 96;
-
-  // Dynamically load shcore.dll and get the GetDpiForMonitor function address
-  // We need to do this to ensure Windows 7 support
-  HMODULE shcore = LoadLibrary(TEXT("shcore.dll"));
-  if (shcore) {
-    typedef HRESULT (*GetDpiForMonitor)(HMONITOR, int, UINT*, UINT*);
-
-    GetDpiForMonitor GetDpiForMonitorFunc =
-        (GetDpiForMonitor)GetProcAddress(shcore, "GetDpiForMonitor");
-
-    if (GetDpiForMonitorFunc) {
-      // Use the loaded function if available
-      const int MDT_EFFECTIVE_DPI = 0;
-      if (FAILED(GetDpiForMonitorFunc(monitor, MDT_EFFECTIVE_DPI, &newDpiX,
-                                      &newDpiY))) {
-        // If it fails, set the default values again
-        newDpiX = 96;
-        newDpiY = 96;
-      }
-    }
-    FreeLibrary(shcore);
-  }
-  return ((double)newDpiX);
+  return static_cast<double>(GetDpiForMonitorOrDefault(
+      MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST)));
 }
 
 void WindowManagerPlus::Dock(const flutter::EncodableMap& args) {
@@ -550,15 +1324,11 @@ void WindowManagerPlus::SetAspectRatio(const flutter::EncodableMap& args) {
       std::get<double>(args.at(flutter::EncodableValue("aspectRatio")));
 }
 
-void WindowManagerPlus::SetBackgroundColor(const flutter::EncodableMap& args) {
-  int backgroundColorA =
-      std::get<int>(args.at(flutter::EncodableValue("backgroundColorA")));
-  int backgroundColorR =
-      std::get<int>(args.at(flutter::EncodableValue("backgroundColorR")));
-  int backgroundColorG =
-      std::get<int>(args.at(flutter::EncodableValue("backgroundColorG")));
-  int backgroundColorB =
-      std::get<int>(args.at(flutter::EncodableValue("backgroundColorB")));
+void WindowManagerPlus::SetBackgroundColor(const BackgroundColorArgs& args) {
+  int backgroundColorA = static_cast<int>(args.a);
+  int backgroundColorR = static_cast<int>(args.r);
+  int backgroundColorG = static_cast<int>(args.g);
+  int backgroundColorB = static_cast<int>(args.b);
 
   bool isTransparent = backgroundColorA == 0 && backgroundColorR == 0 &&
                        backgroundColorG == 0 && backgroundColorB == 0;
@@ -606,40 +1376,45 @@ void WindowManagerPlus::SetBackgroundColor(const flutter::EncodableMap& args) {
   }
 }
 
+protocol::Bounds WindowManagerPlus::GetBounds(double devicePixelRatio) {
+  HWND hwnd = GetMainWindow();
+
+  protocol::Bounds bounds;
+  RECT rect;
+  if (GetWindowRect(hwnd, &rect)) {
+    bounds.x = rect.left / devicePixelRatio * 1.0f;
+    bounds.y = rect.top / devicePixelRatio * 1.0f;
+    bounds.width = (rect.right - rect.left) / devicePixelRatio * 1.0f;
+    bounds.height = (rect.bottom - rect.top) / devicePixelRatio * 1.0f;
+  }
+  return bounds;
+}
+
 flutter::EncodableMap WindowManagerPlus::GetBounds(
     const flutter::EncodableMap& args) {
-  HWND hwnd = GetMainWindow();
   double devicePixelRatio =
       std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
+  protocol::Bounds bounds = GetBounds(devicePixelRatio);
 
   flutter::EncodableMap resultMap = flutter::EncodableMap();
-  RECT rect;
-  if (GetWindowRect(hwnd, &rect)) {
-    double x = rect.left / devicePixelRatio * 1.0f;
-    double y = rect.top / devicePixelRatio * 1.0f;
-    double width = (rect.right - rect.left) / devicePixelRatio * 1.0f;
-    double height = (rect.bottom - rect.top) / devicePixelRatio * 1.0f;
-
-    resultMap[flutter::EncodableValue("x")] = flutter::EncodableValue(x);
-    resultMap[flutter::EncodableValue("y")] = flutter::EncodableValue(y);
-    resultMap[flutter::EncodableValue("width")] =
-        flutter::EncodableValue(width);
-    resultMap[flutter::EncodableValue("height")] =
-        flutter::EncodableValue(height);
-  }
+  resultMap[flutter::EncodableValue("x")] = flutter::EncodableValue(bounds.x);
+  resultMap[flutter::EncodableValue("y")] = flutter::EncodableValue(bounds.y);
+  resultMap[flutter::EncodableValue("width")] =
+      flutter::EncodableValue(bounds.width);
+  resultMap[flutter::EncodableValue("height")] =
+      flutter::EncodableValue(bounds.height);
   return resultMap;
 }
 
-void WindowManagerPlus::SetBounds(const flutter::EncodableMap& args) {
+void WindowManagerPlus::SetBounds(const BoundsArgs& args) {
   HWND hwnd = GetMainWindow();
 
-  double devicePixelRatio =
-      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
+  double devicePixelRatio = args.device_pixel_ratio.value_or(pixel_ratio_);
 
-  auto* null_or_x = std::get_if<double>(ValueOrNull(args, "x"));
-  auto* null_or_y = std::get_if<double>(ValueOrNull(args, "y"));
-  auto* null_or_width = std::get_if<double>(ValueOrNull(args, "width"));
-  auto* null_or_height = std::get_if<double>(ValueOrNull(args, "height"));
+  const double* null_or_x = args.x ? &*args.x : nullptr;
+  const double* null_or_y = args.y ? &*args.y : nullptr;
+  const double* null_or_width = args.width ? &*args.width : nullptr;
+  const double* null_or_height = args.height ? &*args.height : nullptr;
 
   int x = 0;
   int y = 0;
@@ -666,11 +1441,496 @@ void WindowManagerPlus::SetBounds(const flutter::EncodableMap& args) {
   SetWindowPos(hwnd, HWND_TOP, x, y, width, height, uFlags);
 }
 
-void WindowManagerPlus::SetMinimumSize(const flutter::EncodableMap& args) {
-  double devicePixelRatio =
-      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
-  double width = std::get<double>(args.at(flutter::EncodableValue("width")));
-  double height = std::get<double>(args.at(flutter::EncodableValue("height")));
+void WindowManagerPlus::Align(const AlignArgs& args) {
+  HWND hwnd = GetMainWindow();
+
+  RECT rect;
+  if (!GetWindowRect(hwnd, &rect)) {
+    return;
+  }
+  const Display* display = GetDisplayTopology().FindByRect(RectFromRECT(rect));
+  if (display == nullptr) {
+    return;
+  }
+
+  Point position =
+      AlignWithin(display->work_area, rect.right - rect.left,
+                  rect.bottom - rect.top, args.x, args.y);
+  SetWindowPos(hwnd, nullptr, static_cast<int>(std::lround(position.x)),
+               static_cast<int>(std::lround(position.y)), 0, 0,
+               SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+bool WindowManagerPlus::SetParentWindow(const ParentWindowArgs& args) {
+  if (!args.parent_id) {
+    parent_id_ = -1;
+    return true;
+  }
+
+  // Refuse cycles, moving a window would move it again.
+  int64_t new_parent_id = *args.parent_id;
+  for (int64_t ancestor = new_parent_id; ancestor != -1;) {
+    auto it = windowManagers_.find(ancestor);
+    if (ancestor == id || it == windowManagers_.end() ||
+        it->second->GetMainWindow() == nullptr) {
+      return false;
+    }
+    ancestor = it->second->parent_id_;
+  }
+
+  RECT parent_rect;
+  RECT rect;
+  GetWindowRect(windowManagers_[new_parent_id]->GetMainWindow(), &parent_rect);
+  GetWindowRect(GetMainWindow(), &rect);
+  if (args.offset_x && args.offset_y) {
+    double devicePixelRatio = args.device_pixel_ratio.value_or(pixel_ratio_);
+    parent_offset_ = {static_cast<LONG>(*args.offset_x * devicePixelRatio),
+                      static_cast<LONG>(*args.offset_y * devicePixelRatio)};
+  } else {
+    parent_offset_ = {rect.left - parent_rect.left, rect.top - parent_rect.top};
+  }
+  is_minimized_with_parent_ = args.minimize_with_parent;
+  parent_id_ = new_parent_id;
+
+  SetWindowPos(GetMainWindow(), nullptr, parent_rect.left + parent_offset_.x,
+               parent_rect.top + parent_offset_.y, 0, 0,
+               SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+  return true;
+}
+
+void WindowManagerPlus::MoveChildWindows(const RECT& rect) {
+  std::vector<WindowMove> moves;
+  for (const auto& [child_id, child] : windowManagers_) {
+    HWND hWnd = child->GetMainWindow();
+    if (child->parent_id_ != id || hWnd == nullptr || IsIconic(hWnd) ||
+        IsZoomed(hWnd)) {
+      continue;
+    }
+    moves.push_back({hWnd,
+                     nullptr,
+                     {rect.left + child->parent_offset_.x,
+                      rect.top + child->parent_offset_.y, 0, 0},
+                     SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE});
+  }
+  if (!moves.empty()) {
+    MoveWindowsTogether(moves);
+  }
+}
+
+void WindowManagerPlus::SetChildWindowsMinimized(bool is_minimized) {
+  for (const auto& [child_id, child] : windowManagers_) {
+    HWND hWnd = child->GetMainWindow();
+    if (child->parent_id_ != id || !child->is_minimized_with_parent_ ||
+        hWnd == nullptr || !IsWindowVisible(hWnd)) {
+      continue;
+    }
+    if (is_minimized && !IsIconic(hWnd)) {
+      ShowWindow(hWnd, SW_SHOWMINNOACTIVE);
+    } else if (!is_minimized && IsIconic(hWnd)) {
+      ShowWindow(hWnd, SW_SHOWNOACTIVATE);
+    }
+  }
+}
+
+void WindowManagerPlus::SetSnapping(const SnappingArgs& args) {
+  double devicePixelRatio = args.device_pixel_ratio.value_or(pixel_ratio_);
+  snap_distance_ = args.is_snapping ? args.distance * devicePixelRatio : 0;
+  snapper_.Clear();
+}
+
+// Called when a drag starts, the other windows do not move meanwhile.
+void WindowManagerPlus::BuildSnapIndex() {
+  snapper_.Clear();
+  HWND mainWindow = GetMainWindow();
+  if (snap_distance_ <= 0 || mainWindow == nullptr) {
+    return;
+  }
+
+  for (const Display& display : GetDisplayTopology().displays()) {
+    snapper_.AddRect(display.work_area);
+  }
+  for (const auto& [other_id, other] : windowManagers_) {
+    HWND hWnd = other->GetMainWindow();
+    // The children follow this window, they are not obstacles.
+    if (other_id == id || other->parent_id_ == id || hWnd == nullptr ||
+        !IsWindowVisible(hWnd) || IsIconic(hWnd)) {
+      continue;
+    }
+    snapper_.AddRect(RectFromRECT(GetVisibleBounds(hWnd)));
+  }
+  snapper_.Build();
+
+  RECT rect;
+  GetWindowRect(mainWindow, &rect);
+  RECT visible = GetVisibleBounds(mainWindow);
+  snap_margins_ = {visible.left - rect.left, visible.top - rect.top,
+                   rect.right - visible.right, rect.bottom - visible.bottom};
+}
+
+void WindowManagerPlus::SnapWindowRect(RECT* rect) {
+  if (snap_distance_ <= 0 || snapper_.IsEmpty()) {
+    return;
+  }
+  RECT visible = {rect->left + snap_margins_.left,
+                  rect->top + snap_margins_.top,
+                  rect->right - snap_margins_.right,
+                  rect->bottom - snap_margins_.bottom};
+  Rect bounds = RectFromRECT(visible);
+  Point position = snapper_.Snap(bounds, snap_distance_);
+  OffsetRect(rect, static_cast<int>(std::lround(position.x - bounds.x)),
+             static_cast<int>(std::lround(position.y - bounds.y)));
+}
+
+void WindowManagerPlus::SetDragRegions(const DragRegionsArgs& args) {
+  pixel_ratio_ = args.device_pixel_ratio.value_or(pixel_ratio_);
+  drag_regions_.Reset(
+      RectsFromValues(args.regions.data, args.regions.size),
+      RectsFromValues(args.excluded_regions.data, args.excluded_regions.size));
+  UpdateHitTestSubclass();
+}
+
+// Windows only lets the clicks through to other applications with
+// WS_EX_TRANSPARENT on a layered window, for the whole window. While there
+// is an input region, the style follows the cursor, polled on a timer since
+// a transparent window gets no mouse messages.
+void WindowManagerPlus::SetInputRegion(const InputRegionArgs& args) {
+  pixel_ratio_ = args.device_pixel_ratio.value_or(pixel_ratio_);
+  bool is_changed =
+      !args.regions ? input_region_.Reset()
+                    : input_region_.Update(args.regions->data,
+                                           args.regions->size, pixel_ratio_);
+  if (!is_changed) {
+    return;
+  }
+
+  HWND hWnd = GetMainWindow();
+  if (input_hrgn_ != nullptr) {
+    DeleteObject(input_hrgn_);
+    input_hrgn_ = nullptr;
+  }
+  if (!input_region_.IsSet()) {
+    KillTimer(hWnd, kInputRegionTimerId);
+    SetClickThrough(false);
+    return;
+  }
+  input_hrgn_ = CreateRegionFromRects(input_region_.rects());
+  LONG ex_style = GetWindowLong(hWnd, GWL_EXSTYLE);
+  if ((ex_style & WS_EX_LAYERED) == 0) {
+    SetWindowLong(hWnd, GWL_EXSTYLE, ex_style | WS_EX_LAYERED);
+    SetLayeredWindowAttributes(hWnd, 0, static_cast<BYTE>(255 * opacity_),
+                               LWA_ALPHA);
+  }
+  SetTimer(hWnd, kInputRegionTimerId, kInputRegionPollMs, nullptr);
+  UpdateClickThrough();
+}
+
+void WindowManagerPlus::UpdateClickThrough() {
+  HWND hWnd = GetMainWindow();
+  POINT cursor;
+  RECT client;
+  if (input_hrgn_ == nullptr || !GetCursorPos(&cursor) ||
+      !ScreenToClient(hWnd, &cursor) || !GetClientRect(hWnd, &client)) {
+    return;
+  }
+  // The frame, if any, always takes input.
+  SetClickThrough(PtInRect(&client, cursor) &&
+                  !PtInRegion(input_hrgn_, cursor.x, cursor.y));
+}
+
+void WindowManagerPlus::SetClickThrough(bool is_click_through) {
+  HWND hWnd = GetMainWindow();
+  LONG ex_style = GetWindowLong(hWnd, GWL_EXSTYLE);
+  LONG new_ex_style = is_click_through ? ex_style | WS_EX_TRANSPARENT
+                                       : ex_style & ~WS_EX_TRANSPARENT;
+  if (new_ex_style != ex_style) {
+    SetWindowLong(hWnd, GWL_EXSTYLE, new_ex_style);
+  }
+}
+
+// There is no frame clock to follow, the cursor is sampled on a timer at the
+// refresh period of the compositor, and sent in batches. While the pointer
+// rests, the timer slows down to CursorSampler::kIdlePollMs.
+void WindowManagerPlus::SetCursorStreamEnabled(const CursorStreamArgs& args) {
+  HWND hWnd = GetMainWindow();
+  if (!args.enabled) {
+    KillTimer(hWnd, kCursorTimerId);
+    cursor_sampler_.Reset();
+    is_cursor_idle_ = false;
+    return;
+  }
+
+  cursor_period_ms_ = 16;
+  DWM_TIMING_INFO timing = {sizeof(DWM_TIMING_INFO)};
+  LARGE_INTEGER frequency;
+  if (SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &timing)) &&
+      QueryPerformanceFrequency(&frequency) && timing.qpcRefreshPeriod > 0) {
+    cursor_period_ms_ = static_cast<UINT>(std::max<ULONGLONG>(
+        1, timing.qpcRefreshPeriod * 1000 / frequency.QuadPart));
+  }
+  is_cursor_idle_ = false;
+  SetTimer(hWnd, kCursorTimerId, cursor_period_ms_, nullptr);
+}
+
+void WindowManagerPlus::SampleCursor() {
+  POINT cursor;
+  if (!GetCursorPos(&cursor) || channel == nullptr) {
+    return;
+  }
+  int64_t time = MonotonicMicros();
+  cursor_sampler_.Sample(time, cursor.x / pixel_ratio_,
+                         cursor.y / pixel_ratio_);
+  if (cursor_sampler_.IsDue(time)) {
+    SendEvent("cursorSamples", "cursorSamples", "onCursorSamples",
+              flutter::EncodableValue(cursor_sampler_.TakeSamples(time)));
+  }
+
+  if (cursor_sampler_.IsIdle() != is_cursor_idle_) {
+    is_cursor_idle_ = cursor_sampler_.IsIdle();
+    SetTimer(GetMainWindow(), kCursorTimerId,
+             is_cursor_idle_ ? CursorSampler::kIdlePollMs : cursor_period_ms_,
+             nullptr);
+  }
+}
+
+// Presses in the Flutter view reach the main window as WM_PARENTNOTIFY, and
+// every move or resize, native or started from Dart, as WM_SYSCOMMAND, both
+// while the press is still the current message.
+void WindowManagerPlus::TrackInputLatency(UINT message, WPARAM wParam) {
+  int64_t now = MonotonicMicros();
+  if (message == WM_NCLBUTTONDOWN && is_synthetic_press_pending_) {
+    is_synthetic_press_pending_ = false;
+  } else if (message == WM_NCLBUTTONDOWN ||
+             (message == WM_PARENTNOTIFY && LOWORD(wParam) == WM_LBUTTONDOWN)) {
+    input_latency_.OnPress(EventTimeToMonotonicUs(
+        static_cast<uint32_t>(GetMessageTime()), GetTickCount(), now));
+  } else if (message == WM_SYSCOMMAND && (wParam & 0xFFF0) == SC_MOVE) {
+    input_latency_.OnDragStart(now);
+  } else if (message == WM_SYSCOMMAND && (wParam & 0xFFF0) == SC_SIZE) {
+    input_latency_.OnResizeStart(now);
+  } else if (message == WM_MOVING || message == WM_SIZING) {
+    input_latency_.OnMove(now);
+  }
+}
+
+flutter::EncodableMap WindowManagerPlus::GetInputLatencyStats(
+    const InputLatencyStatsArgs& args) {
+  flutter::EncodableMap stats = {
+      {flutter::EncodableValue("dragStart"),
+       LatencyHistogramToValue(input_latency_.drag_start())},
+      {flutter::EncodableValue("resizeStart"),
+       LatencyHistogramToValue(input_latency_.resize_start())},
+      {flutter::EncodableValue("firstMove"),
+       LatencyHistogramToValue(input_latency_.first_move())},
+  };
+  if (args.reset.value_or(false)) {
+    input_latency_.Reset();
+  }
+  return stats;
+}
+
+// Calls |method|, or sends a record to the event channel when it's nullptr,
+// once Dart has replied to all but a few of the previous events, see
+// EventQueue. Returns whether it was sent right away.
+bool WindowManagerPlus::SendEvent(const std::string& name,
+                                  const std::string& key,
+                                  const char* method,
+                                  flutter::EncodableValue event) {
+  auto ready = event_queue_.Push(name, key, {method, std::move(event)});
+  if (ready) {
+    DeliverEvent(std::move(*ready));
+  }
+  return ready.has_value();
+}
+
+void WindowManagerPlus::DeliverEvent(QueuedEvent event) {
+  if (channel == nullptr) {
+    event_queue_.DropPending();
+    return;
+  }
+  // The window may be gone by the time Dart replies.
+  int64_t window_id = id;
+  if (event.method == nullptr) {
+    const auto& record = std::get<std::vector<uint8_t>>(event.value);
+    messenger->Send(event_channel_name_, record.data(), record.size(),
+                    [window_id](const uint8_t* reply, size_t reply_size) {
+                      OnEventReply(window_id);
+                    });
+    return;
+  }
+  channel->InvokeMethod(
+      event.method,
+      std::make_unique<flutter::EncodableValue>(std::move(event.value)),
+      std::make_unique<flutter::MethodResultFunctions<flutter::EncodableValue>>(
+          [window_id](const flutter::EncodableValue* val) {
+            OnEventReply(window_id);
+          },
+          [window_id](const std::string& error_code,
+                      const std::string& error_message,
+                      const flutter::EncodableValue* error_details) {
+            OnEventReply(window_id);
+          },
+          [window_id]() { OnEventReply(window_id); }));
+}
+
+// Sends the record of a move or resize to the event channel of this
+// window, and a copy flagged as global to every window.
+void WindowManagerPlus::EmitBoundsEvent(WindowEvent event, const RECT& rect) {
+  double scale = GetDpiForHwnd(GetMainWindow()) / 96.0;
+  EventRecord record = {
+      static_cast<int32_t>(event),
+      0,
+      id,
+      MonotonicMicros(),
+      rect.left / scale,
+      rect.top / scale,
+      (rect.right - rect.left) / scale,
+      (rect.bottom - rect.top) / scale,
+  };
+  std::string name = WindowEventName(event);
+  if (!event_channel_name_.empty()) {
+    SendEvent(name, name, nullptr,
+              flutter::EncodableValue(EncodeEventRecord(record)));
+  }
+
+  record.flags = kEventRecordGlobal;
+  flutter::EncodableValue global_record(EncodeEventRecord(record));
+  std::string key = name + ":" + std::to_string(id);
+  for (auto& manager : windowManagers_) {
+    if (!manager.second->event_channel_name_.empty()) {
+      manager.second->SendEvent(name, key, nullptr, global_record);
+    }
+  }
+}
+
+// Publishes the state read by WindowManagerPlusPluginGetSnapshot, from the
+// messages changing it.
+void WindowManagerPlus::PublishSnapshot(std::optional<bool> is_focused) {
+  if (id < 0) {
+    // Not initialized by Dart yet.
+    return;
+  }
+  HWND hwnd = GetMainWindow();
+  WindowSnapshot snapshot;
+  snapshot.scale_factor = GetDpiForHwnd(hwnd) / 96.0;
+  RECT rect;
+  if (GetWindowRect(hwnd, &rect)) {
+    snapshot.x = rect.left / snapshot.scale_factor;
+    snapshot.y = rect.top / snapshot.scale_factor;
+    snapshot.width = (rect.right - rect.left) / snapshot.scale_factor;
+    snapshot.height = (rect.bottom - rect.top) / snapshot.scale_factor;
+  }
+  if (is_focused.value_or(IsFocused())) {
+    snapshot.flags |= kSnapshotFocused;
+  }
+  if (IsVisible()) {
+    snapshot.flags |= kSnapshotVisible;
+  }
+  if (IsZoomed(hwnd)) {
+    snapshot.flags |= kSnapshotMaximized;
+  }
+  if (IsIconic(hwnd)) {
+    snapshot.flags |= kSnapshotMinimized;
+  }
+  if (IsFullScreen()) {
+    snapshot.flags |= kSnapshotFullScreen;
+  }
+  GetWindowSnapshotRegistry().Publish(id, snapshot);
+}
+
+void WindowManagerPlus::OnEventReply(int64_t window_id) {
+  auto it = windowManagers_.find(window_id);
+  if (it == windowManagers_.end()) {
+    return;
+  }
+  auto next = it->second->event_queue_.OnReply();
+  if (next) {
+    it->second->DeliverEvent(std::move(*next));
+  }
+}
+
+void WindowManagerPlus::SetEventPolicy(const EventPolicyArgs& args) {
+  event_queue_.SetPolicy(args.event_name, *EventPolicyFromName(args.policy));
+}
+
+flutter::EncodableMap WindowManagerPlus::GetEventQueueStats() {
+  EventQueueStats stats = event_queue_.stats();
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("depth"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.depth))},
+      {flutter::EncodableValue("maxDepth"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.max_depth))},
+      {flutter::EncodableValue("inFlight"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.in_flight))},
+      {flutter::EncodableValue("sent"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.sent))},
+      {flutter::EncodableValue("coalesced"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.coalesced))},
+      {flutter::EncodableValue("dropped"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.dropped))},
+  };
+}
+
+void WindowManagerPlus::SetResizeBorder(const ResizeBorderArgs& args) {
+  resize_border_.width = args.width;
+  resize_border_.top = args.top;
+  resize_border_.bottom = args.bottom;
+  resize_border_.left = args.left;
+  resize_border_.right = args.right;
+  pixel_ratio_ = args.device_pixel_ratio.value_or(pixel_ratio_);
+  UpdateHitTestSubclass();
+}
+
+void WindowManagerPlus::UpdateHitTestSubclass() {
+  if (drag_regions_.IsEmpty() && !resize_border_.IsEnabled()) {
+    if (hit_test_view_ != nullptr) {
+      RemoveWindowSubclass(hit_test_view_, HitTestSubclassProc,
+                           kHitTestSubclassId);
+      hit_test_view_ = nullptr;
+    }
+    return;
+  }
+  if (hit_test_view_ == nullptr) {
+    HWND flutter_view = FindWindowEx(GetMainWindow(), nullptr,
+                                     kFlutterViewWindowClassName, nullptr);
+    if (flutter_view != nullptr &&
+        SetWindowSubclass(flutter_view, HitTestSubclassProc,
+                          kHitTestSubclassId,
+                          reinterpret_cast<DWORD_PTR>(this))) {
+      hit_test_view_ = flutter_view;
+    }
+  }
+}
+
+// Called for every WM_NCHITTEST, i.e. on every mouse move, so it relies on
+// pixel_ratio_ kept up to date by WM_DPICHANGED rather than querying the
+// monitor. Returns HTCLIENT when the point belongs to the Flutter view.
+LRESULT WindowManagerPlus::HitTestView(LPARAM lParam) {
+  if (hit_test_view_ == nullptr || g_is_window_fullscreen) {
+    return HTCLIENT;
+  }
+  POINT point = {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+  ScreenToClient(hit_test_view_, &point);
+  double x = point.x / pixel_ratio_;
+  double y = point.y / pixel_ratio_;
+
+  // The border wins over a drag region along the top edge.
+  if (is_resizable_ && !IsZoomed(GetMainWindow())) {
+    RECT rect;
+    GetClientRect(hit_test_view_, &rect);
+    LRESULT code = HitTestCodeFromEdge(
+        resize_border_.Classify(x, y, rect.right / pixel_ratio_,
+                                rect.bottom / pixel_ratio_));
+    if (code != HTCLIENT) {
+      return code;
+    }
+  }
+  return drag_regions_.HitTest(x, y) ? HTCAPTION : HTCLIENT;
+}
+
+void WindowManagerPlus::SetMinimumSize(const SizeArgs& args) {
+  double devicePixelRatio = args.device_pixel_ratio.value_or(pixel_ratio_);
+  double width = args.width;
+  double height = args.height;
 
   if (width >= 0 && height >= 0) {
     pixel_ratio_ = devicePixelRatio;
@@ -681,11 +1941,10 @@ void WindowManagerPlus::SetMinimumSize(const flutter::EncodableMap& args) {
   }
 }
 
-void WindowManagerPlus::SetMaximumSize(const flutter::EncodableMap& args) {
-  double devicePixelRatio =
-      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
-  double width = std::get<double>(args.at(flutter::EncodableValue("width")));
-  double height = std::get<double>(args.at(flutter::EncodableValue("height")));
+void WindowManagerPlus::SetMaximumSize(const SizeArgs& args) {
+  double devicePixelRatio = args.device_pixel_ratio.value_or(pixel_ratio_);
+  double width = args.width;
+  double height = args.height;
 
   if (width >= 0 && height >= 0) {
     pixel_ratio_ = devicePixelRatio;
@@ -877,24 +2136,205 @@ void WindowManagerPlus::SetProgressBar(const flutter::EncodableMap& args) {
   }
 }
 
-void WindowManagerPlus::SetIcon(const flutter::EncodableMap& args) {
-  std::string iconPath =
-      std::get<std::string>(args.at(flutter::EncodableValue("iconPath")));
-
+// Decodes the icon on a worker thread, which posts kIconLoadedMessage to
+// the main window once done.
+void WindowManagerPlus::SetIcon(const IconArgs& args) {
   std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  std::wstring path = converter.from_bytes(args.icon_path);
 
-  HICON hIconSmall =
-      (HICON)(LoadImage(NULL, (LPCWSTR)(converter.from_bytes(iconPath).c_str()),
-                        IMAGE_ICON, 16, 16, LR_LOADFROMFILE));
+  HWND hWnd = GetMainWindow();
+  // The sizes of SM_CXSMICON and SM_CXICON on the window's monitor.
+  double scale = GetDpiForHwnd(hWnd) / USER_DEFAULT_SCREEN_DPI;
+  int small_size = static_cast<int>(std::lround(16 * scale));
+  int large_size = static_cast<int>(std::lround(32 * scale));
+  uint64_t generation = ++icon_generation_;
+
+  std::thread([hWnd, path, small_size, large_size, generation]() {
+    CachedIcon icon;
+    if (!LoadIconFile(path, small_size, large_size, &icon)) {
+      return;
+    }
+    auto* loaded =
+        new LoadedIcon{generation, icon.small_icon, icon.large_icon};
+    if (!PostMessage(hWnd, kIconLoadedMessage, 0,
+                     reinterpret_cast<LPARAM>(loaded))) {
+      delete loaded;
+    }
+  }).detach();
+}
 
-  HICON hIconLarge =
-      (HICON)(LoadImage(NULL, (LPCWSTR)(converter.from_bytes(iconPath).c_str()),
-                        IMAGE_ICON, 32, 32, LR_LOADFROMFILE));
+bool WindowManagerPlus::SetIconFromBytes(const flutter::EncodableMap& args) {
+  const auto& bytes =
+      std::get<std::vector<uint8_t>>(args.at(flutter::EncodableValue("bytes")));
+  auto* width = std::get_if<int32_t>(ValueOrNull(args, "width"));
+  auto* height = std::get_if<int32_t>(ValueOrNull(args, "height"));
 
   HWND hWnd = GetMainWindow();
+  double scale = GetDpiForHwnd(hWnd) / USER_DEFAULT_SCREEN_DPI;
+  const int sizes[2] = {static_cast<int>(std::lround(16 * scale)),
+                        static_cast<int>(std::lround(32 * scale))};
+  HICON icons[2] = {nullptr, nullptr};
+  if (width != nullptr && height != nullptr) {
+    if (*width <= 0 || *height <= 0 ||
+        static_cast<uint64_t>(*width) * static_cast<uint64_t>(*height) * 4 !=
+            bytes.size()) {
+      return false;
+    }
+    for (int i = 0; i < 2; i++) {
+      icons[i] = CreateIconFromRgba(bytes.data(), *width, *height, sizes[i]);
+    }
+  } else {
+    // Icon resources may hold PNG data, which is how the bytes are decoded.
+    for (int i = 0; i < 2; i++) {
+      icons[i] = CreateIconFromResourceEx(
+          const_cast<PBYTE>(bytes.data()), static_cast<DWORD>(bytes.size()),
+          TRUE, 0x00030000, sizes[i], sizes[i], LR_DEFAULTCOLOR);
+    }
+  }
+  if (icons[0] == nullptr && icons[1] == nullptr) {
+    return false;
+  }
+
+  // A file icon still decoding must not replace this one.
+  ++icon_generation_;
+  SendMessage(hWnd, WM_SETICON, ICON_SMALL, reinterpret_cast<LPARAM>(icons[0]));
+  SendMessage(hWnd, WM_SETICON, ICON_BIG, reinterpret_cast<LPARAM>(icons[1]));
+  for (int i = 0; i < 2; i++) {
+    if (bytes_icons_[i] != nullptr) {
+      DestroyIcon(bytes_icons_[i]);
+    }
+    bytes_icons_[i] = icons[i];
+  }
+  return true;
+}
+
+std::optional<flutter::EncodableMap> WindowManagerPlus::CaptureWindow(
+    const CaptureArgs& args) {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;
+  if (!CaptureWindowPixels(GetMainWindow(), &width, &height, &pixels)) {
+    return std::nullopt;
+  }
+  // The capture is opaque, so "premultipliedAlpha" has nothing to convert.
+  if (args.is_rgba()) {
+    SwapRedBlue(pixels.data(), pixels.data(),
+                static_cast<size_t>(width) * height);
+  }
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("width"), flutter::EncodableValue(width)},
+      {flutter::EncodableValue("height"), flutter::EncodableValue(height)},
+      {flutter::EncodableValue("bytes"),
+       flutter::EncodableValue(std::move(pixels))},
+  };
+}
+
+// Each tick of the subscriber's timer only captures the windows repainted
+// since the previous one, or not refreshed for max_stale_ticks, and sends
+// the previews that changed in one batched message. Flutter presents through
+// DirectComposition without WM_PAINT, so changes of the content itself are
+// picked up by max_stale_ticks.
+void WindowManagerPlus::SetThumbnailOptions(const ThumbnailOptionsArgs& args) {
+  if (!args.enabled) {
+    if (thumbnail_service_.subscriber == id) {
+      StopThumbnailService();
+    }
+    return;
+  }
 
-  SendMessage(hWnd, WM_SETICON, ICON_SMALL, (LPARAM)hIconSmall);
-  SendMessage(hWnd, WM_SETICON, ICON_BIG, (LPARAM)hIconLarge);
+  StopThumbnailService();
+  thumbnail_service_.subscriber = id;
+  constexpr int64_t kMaxInt = std::numeric_limits<int>::max();
+  thumbnail_service_.max_width =
+      static_cast<int>(std::min(args.max_width, kMaxInt));
+  thumbnail_service_.max_height =
+      static_cast<int>(std::min(args.max_height, kMaxInt));
+  thumbnail_service_.max_stale_ticks =
+      static_cast<uint32_t>(std::min(args.max_stale_ticks, kMaxInt));
+  SetTimer(GetMainWindow(), kThumbnailTimerId,
+           static_cast<UINT>(std::clamp(args.interval, kMinThumbnailIntervalMs,
+                                        kMaxInt)),
+           nullptr);
+}
+
+// static
+void WindowManagerPlus::StopThumbnailService() {
+  auto subscriber = windowManagers_.find(thumbnail_service_.subscriber);
+  if (subscriber != windowManagers_.end()) {
+    KillTimer(subscriber->second->GetMainWindow(), kThumbnailTimerId);
+  }
+  thumbnail_service_.subscriber = -1;
+  thumbnail_service_.window_ids.clear();
+  thumbnail_service_.is_resending_all = false;
+  // The next subscriber gets every preview again.
+  for (const auto& [window_id, manager] : windowManagers_) {
+    manager->thumbnail_ = Thumbnail();
+  }
+}
+
+void WindowManagerPlus::UpdateThumbnails() {
+  ThumbnailBatch batch;
+  std::vector<int64_t> window_ids;
+  for (const auto& [window_id, manager] : windowManagers_) {
+    window_ids.push_back(window_id);
+    manager->thumbnail_age_++;
+    uint32_t max_stale_ticks = thumbnail_service_.max_stale_ticks;
+    bool is_due =
+        manager->thumbnail_.pixels.empty() || manager->thumbnail_dirty_ ||
+        (max_stale_ticks > 0 && manager->thumbnail_age_ >= max_stale_ticks);
+    // Hidden and minimized windows keep their last preview.
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+    if (!is_due || !CaptureWindowPixels(manager->GetMainWindow(), &width,
+                                        &height, &pixels)) {
+      continue;
+    }
+    manager->thumbnail_dirty_ = false;
+    manager->thumbnail_age_ = 0;
+    if (UpdateThumbnail(pixels.data(), static_cast<size_t>(width) * 4, width,
+                        height, true, thumbnail_service_.max_width,
+                        thumbnail_service_.max_height, &manager->thumbnail_)) {
+      batch.Add(window_id, manager->thumbnail_);
+    }
+  }
+  if (thumbnail_service_.is_resending_all) {
+    batch = ThumbnailBatch();
+    for (const auto& [window_id, manager] : windowManagers_) {
+      if (!manager->thumbnail_.pixels.empty()) {
+        batch.Add(window_id, manager->thumbnail_);
+      }
+    }
+  }
+  if ((batch.IsEmpty() && window_ids == thumbnail_service_.window_ids) ||
+      channel == nullptr) {
+    return;
+  }
+  thumbnail_service_.window_ids = window_ids;
+
+  thumbnail_service_.is_resending_all = !SendEvent(
+      "thumbnails", "thumbnails", "onThumbnails",
+      flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("windowIds"),
+           flutter::EncodableValue(std::move(window_ids))},
+          {flutter::EncodableValue("index"),
+           flutter::EncodableValue(std::move(batch.index))},
+          {flutter::EncodableValue("pixels"),
+           flutter::EncodableValue(std::move(batch.pixels))}}));
+}
+
+void WindowManagerPlus::InstallIcon(LPARAM lParam) {
+  std::unique_ptr<LoadedIcon> loaded(reinterpret_cast<LoadedIcon*>(lParam));
+  // A later SetIcon is still decoding.
+  if (loaded->generation != icon_generation_) {
+    return;
+  }
+  HWND hWnd = GetMainWindow();
+  SendMessage(hWnd, WM_SETICON, ICON_SMALL,
+              reinterpret_cast<LPARAM>(loaded->small_icon));
+  SendMessage(hWnd, WM_SETICON, ICON_BIG,
+              reinterpret_cast<LPARAM>(loaded->large_icon));
+  DestroyStaleIcons(windowManagers_);
 }
 
 bool WindowManagerPlus::HasShadow() {
@@ -919,8 +2359,8 @@ double WindowManagerPlus::GetOpacity() {
   return opacity_;
 }
 
-void WindowManagerPlus::SetOpacity(const flutter::EncodableMap& args) {
-  opacity_ = std::get<double>(args.at(flutter::EncodableValue("opacity")));
+void WindowManagerPlus::SetOpacity(const OpacityArgs& args) {
+  opacity_ = args.opacity;
   HWND hWnd = GetMainWindow();
   long gwlExStyle = GetWindowLong(hWnd, GWL_EXSTYLE);
   SetWindowLong(hWnd, GWL_EXSTYLE, gwlExStyle | WS_EX_LAYERED);
@@ -1014,13 +2454,235 @@ void WindowManagerPlus::StartResizing(const flutter::EncodableMap& args) {
     command = HTBOTTOMRIGHT;
   POINT cursorPos;
   GetCursorPos(&cursorPos);
+  // Not a press of its own for the latency measurements.
+  is_synthetic_press_pending_ = true;
   PostMessage(hWnd, WM_NCLBUTTONDOWN, command,
               MAKELPARAM(cursorPos.x, cursorPos.y));
 }
 
+void WindowManagerPlus::SetGeometryPersistenceKey(
+    const flutter::EncodableMap& args) {
+  const flutter::EncodableValue* key = ValueOrNull(args, "key");
+  geometry_key_ = key != nullptr && std::holds_alternative<std::string>(*key)
+                      ? std::get<std::string>(*key)
+                      : "";
+  if (!geometry_key_.empty()) {
+    RestoreGeometry();
+  }
+}
+
+void WindowManagerPlus::SaveGeometry() {
+  HWND hWnd = GetMainWindow();
+  WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+  if (geometry_key_.empty() || hWnd == nullptr ||
+      !GetWindowPlacement(hWnd, &placement)) {
+    return;
+  }
+
+  WindowGeometryStore& store = GetGeometryStore();
+  const WindowGeometry* previous = store.Find(geometry_key_);
+  WindowGeometry geometry;
+  if (IsFullScreen() && previous != nullptr) {
+    // Full screen is implemented on top of a maximized window, keep the
+    // bounds and state it will go back to.
+    geometry = *previous;
+  } else {
+    const RECT& rect = placement.rcNormalPosition;
+    geometry.x = rect.left;
+    geometry.y = rect.top;
+    geometry.width = rect.right - rect.left;
+    geometry.height = rect.bottom - rect.top;
+    geometry.maximized =
+        placement.showCmd == SW_SHOWMAXIMIZED ||
+        (IsMinimized() && (placement.flags & WPF_RESTORETOMAXIMIZED) != 0);
+  }
+  geometry.full_screen = IsFullScreen();
+  geometry.monitor =
+      GetMonitorDevice(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST));
+
+  if (store.Set(geometry_key_, geometry)) {
+    WriteStore(store, kGeometryStoreFile);
+  }
+}
+
+void WindowManagerPlus::RestoreGeometry() {
+  HWND hWnd = GetMainWindow();
+  const WindowGeometry* geometry = GetGeometryStore().Find(geometry_key_);
+  WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+  if (hWnd == nullptr || geometry == nullptr || geometry->width <= 0 ||
+      geometry->height <= 0 || !GetWindowPlacement(hWnd, &placement)) {
+    return;
+  }
+
+  RECT rect = {static_cast<LONG>(geometry->x), static_cast<LONG>(geometry->y),
+               static_cast<LONG>(geometry->x + geometry->width),
+               static_cast<LONG>(geometry->y + geometry->height)};
+  // Only reuse the position if it still lands on the monitor it was saved
+  // on, otherwise the window could end up off-screen after a display change.
+  // The normal position is in workspace coordinates, which only differ from
+  // screen coordinates by the taskbar, close enough to find the monitor.
+  HMONITOR monitor = MonitorFromRect(&rect, MONITOR_DEFAULTTONULL);
+  if (monitor != nullptr && GetMonitorDevice(monitor) == geometry->monitor) {
+    placement.rcNormalPosition = rect;
+  } else {
+    placement.rcNormalPosition.right =
+        placement.rcNormalPosition.left + (rect.right - rect.left);
+    placement.rcNormalPosition.bottom =
+        placement.rcNormalPosition.top + (rect.bottom - rect.top);
+  }
+
+  // A hidden window keeps its normal state until it is shown, so that
+  // restoring does not make it visible early.
+  bool is_visible = IsWindowVisible(hWnd);
+  placement.flags = 0;
+  placement.showCmd = !is_visible           ? SW_HIDE
+                      : geometry->maximized ? SW_SHOWMAXIMIZED
+                                            : SW_SHOWNORMAL;
+  SetWindowPlacement(hWnd, &placement);
+
+  is_geometry_maximize_pending_ = !is_visible && geometry->maximized;
+  is_geometry_full_screen_pending_ = geometry->full_screen;
+  if (is_visible) {
+    ApplyPendingGeometryState();
+  }
+}
+
+void WindowManagerPlus::ApplyPendingGeometryState() {
+  HWND hWnd = GetMainWindow();
+  if (is_geometry_maximize_pending_) {
+    is_geometry_maximize_pending_ = false;
+    ::SendMessage(hWnd, WM_SYSCOMMAND, SC_MAXIMIZE, 0);
+  }
+  if (is_geometry_full_screen_pending_) {
+    is_geometry_full_screen_pending_ = false;
+    SetFullScreen({{flutter::EncodableValue("isFullScreen"),
+                    flutter::EncodableValue(true)}});
+  }
+}
+
+void WindowManagerPlus::ApplyInitialOptions() {
+  wchar_t executable[MAX_PATH];
+  if (GetModuleFileName(nullptr, executable, MAX_PATH) == 0) {
+    return;
+  }
+  std::wstring path(executable);
+  path = path.substr(0, path.find_last_of(L"\\") + 1) +
+         L"data\\flutter_assets\\" + kInitialWindowOptionsFile;
+  if (GetFileAttributes(path.c_str()) == INVALID_FILE_ATTRIBUTES) {
+    return;
+  }
+
+  auto read_string = [&](const wchar_t* key) -> std::optional<std::string> {
+    wchar_t buffer[512];
+    DWORD length = GetPrivateProfileString(kInitialWindowOptionsSection, key,
+                                           L"\x01", buffer, 512, path.c_str());
+    if (length == 1 && buffer[0] == L'\x01') {
+      return std::nullopt;
+    }
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    return converter.to_bytes(buffer, buffer + length);
+  };
+  auto read_double = [&](const wchar_t* key) -> std::optional<double> {
+    auto value = read_string(key);
+    if (!value.has_value()) {
+      return std::nullopt;
+    }
+    return std::strtod(value->c_str(), nullptr);
+  };
+  auto read_bool = [&](const wchar_t* key) -> std::optional<bool> {
+    auto value = read_string(key);
+    if (!value.has_value()) {
+      return std::nullopt;
+    }
+    return *value == "true" || *value == "1";
+  };
+
+  HWND hWnd = GetMainWindow();
+  double devicePixelRatio = GetDpiForHwnd(hWnd) / 96.0;
+
+  if (read_bool(L"frameless").value_or(false)) {
+    SetAsFrameless();
+  }
+  if (auto style = read_string(L"titleBarStyle")) {
+    SetTitleBarStyle({{flutter::EncodableValue("titleBarStyle"),
+                       flutter::EncodableValue(*style)}});
+  }
+  if (auto title = read_string(L"title")) {
+    SetTitle({{flutter::EncodableValue("title"),
+               flutter::EncodableValue(*title)}});
+  }
+
+  BoundsArgs bounds;
+  bounds.x = read_double(L"x");
+  bounds.y = read_double(L"y");
+  bounds.width = read_double(L"width");
+  bounds.height = read_double(L"height");
+  bounds.device_pixel_ratio = devicePixelRatio;
+  if (bounds.x || bounds.y || bounds.width || bounds.height) {
+    SetBounds(bounds);
+  }
+  if (read_bool(L"center").value_or(false)) {
+    Align(AlignArgs{0, 0});
+  }
+
+  auto min_width = read_double(L"minimumWidth");
+  auto min_height = read_double(L"minimumHeight");
+  if (min_width && min_height) {
+    SetMinimumSize({*min_width, *min_height, devicePixelRatio});
+  }
+  auto max_width = read_double(L"maximumWidth");
+  auto max_height = read_double(L"maximumHeight");
+  if (max_width && max_height) {
+    SetMaximumSize({*max_width, *max_height, devicePixelRatio});
+  }
+  if (auto resizable = read_bool(L"resizable")) {
+    SetResizable({{flutter::EncodableValue("isResizable"),
+                   flutter::EncodableValue(*resizable)}});
+  }
+  if (auto always_on_top = read_bool(L"alwaysOnTop")) {
+    SetAlwaysOnTop({{flutter::EncodableValue("isAlwaysOnTop"),
+                     flutter::EncodableValue(*always_on_top)}});
+  }
+  if (auto skip_taskbar = read_bool(L"skipTaskbar")) {
+    // The taskbar list is normally created by waitUntilReadyToShow, which
+    // has not been called yet at this point.
+    if (taskbar_ == nullptr) {
+      WaitUntilReadyToShow();
+    }
+    SetSkipTaskbar({{flutter::EncodableValue("isSkipTaskbar"),
+                     flutter::EncodableValue(*skip_taskbar)}});
+  }
+
+  // Restored last, so that a saved geometry wins over the defaults above.
+  if (auto geometry_key = read_string(L"geometryPersistenceKey")) {
+    SetGeometryPersistenceKey({{flutter::EncodableValue("key"),
+                                flutter::EncodableValue(*geometry_key)}});
+  }
+}
+
 }  // namespace window_manager_plus_v2
 
 void WindowManagerPlusPluginSetWindowCreatedCallback(
     WindowManagerPlusPluginWindowCreatedCallback callback) {
   window_manager_plus_v2::g_window_created_callback = callback;
-}
\ No newline at end of file
+}
+WindowManagerPlusSnapshot WindowManagerPlusPluginGetSnapshot(
+    int64_t window_id) {
+  static_assert(WINDOW_MANAGER_PLUS_SNAPSHOT_PUBLISHED ==
+                        window_manager_plus_v2::kSnapshotPublished &&
+                    WINDOW_MANAGER_PLUS_SNAPSHOT_FULL_SCREEN ==
+                        window_manager_plus_v2::kSnapshotFullScreen,
+                "Snapshot flags differ from common/window_snapshot.h");
+  WindowManagerPlusSnapshot result = {};
+  window_manager_plus_v2::WindowSnapshot snapshot;
+  if (window_manager_plus_v2::GetWindowSnapshotRegistry().Read(window_id,
+                                                               &snapshot)) {
+    result.x = snapshot.x;
+    result.y = snapshot.y;
+    result.width = snapshot.width;
+    result.height = snapshot.height;
+    result.scale_factor = snapshot.scale_factor;
+    result.flags = snapshot.flags;
+  }
+  return result;
+}
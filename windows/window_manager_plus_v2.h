@@ -13,8 +13,29 @@
 #include <dwmapi.h>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 
+#include "cursor_sampler.h"
+#include "display_topology.h"
+#include "edge_snapper.h"
+#include "event_queue.h"
+#include "event_record.h"
+#include "input_latency.h"
+#include "input_region.h"
+#include "method_args.h"
+#include "pixel_ops.h"
+#include "rect.h"
+#include "rect_index.h"
+#include "resize_border.h"
+#include "thumbnails.h"
+#include "tiling.h"
+#include "window_event.h"
+#include "window_geometry_store.h"
+#include "window_layout.h"
+#include "window_manager_protocol.h"
+#include "window_snapshot.h"
+
 #define STATE_NORMAL 0
 #define STATE_MAXIMIZED 1
 #define STATE_MINIMIZED 2
@@ -34,6 +55,23 @@ class WindowManagerPlus {
   inline static std::map<int64_t, std::shared_ptr<WindowManagerPlus>>
       windowManagers_ = {};
 
+  // Keeps previews of every window for a single subscriber, e.g. a window
+  // switcher, see SetThumbnailOptions.
+  struct ThumbnailService {
+    int64_t subscriber = -1;
+    int max_width = 0;
+    int max_height = 0;
+    // 0 never refreshes windows that were not repainted.
+    uint32_t max_stale_ticks = 0;
+    // The windows of the last message, sent again when they change so that
+    // the subscriber drops the previews of closed windows.
+    std::vector<int64_t> window_ids;
+    // Set once a batch could not be sent right away, so may be replaced by
+    // the next one, which then carries every preview.
+    bool is_resending_all = false;
+  };
+  inline static ThumbnailService thumbnail_service_;
+
   std::unique_ptr<
       flutter::MethodChannel<flutter::EncodableValue>,
       std::default_delete<flutter::MethodChannel<flutter::EncodableValue>>>
@@ -45,7 +83,10 @@ class WindowManagerPlus {
       channel = nullptr;
 
   int64_t id = -1;
-  HWND native_window;
+  // Carries the moves and resizes as EventRecords, set by ensureInitialized.
+  flutter::BinaryMessenger* messenger = nullptr;
+  std::string event_channel_name_;
+  HWND native_window = nullptr;
   int last_state = STATE_NORMAL;
   bool has_shadow_ = false;
   bool is_always_on_bottom_ = false;
@@ -61,10 +102,63 @@ class WindowManagerPlus {
   bool is_skip_taskbar_ = true;
   std::string title_bar_style_ = "normal";
   double opacity_ = 1;
+  std::string geometry_key_;
+  int64_t parent_id_ = -1;
+  POINT parent_offset_ = {0, 0};
+  bool is_minimized_with_parent_ = false;
+  // In physical pixels, 0 when snapping is off.
+  double snap_distance_ = 0;
+  EdgeSnapper snapper_;
+  // Invisible borders of the window, left, top, right and bottom.
+  RECT snap_margins_ = {0, 0, 0, 0};
+  DragRegions drag_regions_;
+  ResizeBorder resize_border_;
+  // The Flutter view, subclassed while there are drag regions or a resize
+  // border.
+  HWND hit_test_view_ = nullptr;
+  // Incremented by every SetIcon, so that a slow decode never replaces the
+  // icon of a later call.
+  uint64_t icon_generation_ = 0;
+  // Small and large icons created by SetIconFromBytes, owned by the window.
+  HICON bytes_icons_[2] = {nullptr, nullptr};
+
+  InputRegion input_region_;
+  // input_region_ in client pixels, for hit testing the polled cursor.
+  HRGN input_hrgn_ = nullptr;
+  CursorSampler cursor_sampler_;
+  // Period of the cursor timer, the refresh period unless the pointer rests.
+  UINT cursor_period_ms_ = 16;
+  bool is_cursor_idle_ = false;
+  InputLatencyTracker input_latency_;
+  // An event waiting for Dart, sent by calling |method|, or on the event
+  // channel when it's nullptr.
+  struct QueuedEvent {
+    const char* method;
+    flutter::EncodableValue value;
+  };
+  // Events sent to the channel and waiting for Dart, see SendEvent.
+  EventQueue<QueuedEvent> event_queue_;
+  // Set while the press posted by StartResizing is in the queue.
+  bool is_synthetic_press_pending_ = false;
+  // Preview kept by the thumbnail service, empty until its first capture.
+  Thumbnail thumbnail_;
+  // Repainted since the last preview.
+  bool thumbnail_dirty_ = false;
+  uint32_t thumbnail_age_ = 0;
 
   bool is_resizing_ = false;
   bool is_moving_ = false;
 
+  // Posted to the main window by the icon decoding workers.
+  static constexpr UINT kIconLoadedMessage = WM_APP + 0x57;
+  // Timer of the main window of the thumbnail service subscriber.
+  static constexpr UINT_PTR kThumbnailTimerId = 0x57;
+  // Timer polling the cursor while there is an input region.
+  static constexpr UINT_PTR kInputRegionTimerId = 0x58;
+  static constexpr UINT kInputRegionPollMs = 16;
+  // Timer sampling the cursor while the cursor stream is enabled.
+  static constexpr UINT_PTR kCursorTimerId = 0x59;
+
   HWND GetMainWindow();
   void WindowManagerPlus::ForceRefresh();
   void WindowManagerPlus::ForceChildRefresh();
@@ -93,12 +187,43 @@ class WindowManagerPlus {
   bool WindowManagerPlus::IsFullScreen();
   void WindowManagerPlus::SetFullScreen(const flutter::EncodableMap& args);
   void WindowManagerPlus::SetAspectRatio(const flutter::EncodableMap& args);
-  void WindowManagerPlus::SetBackgroundColor(const flutter::EncodableMap& args);
+  void WindowManagerPlus::SetBackgroundColor(const BackgroundColorArgs& args);
+  protocol::Bounds WindowManagerPlus::GetBounds(double devicePixelRatio);
   flutter::EncodableMap WindowManagerPlus::GetBounds(
       const flutter::EncodableMap& args);
-  void WindowManagerPlus::SetBounds(const flutter::EncodableMap& args);
-  void WindowManagerPlus::SetMinimumSize(const flutter::EncodableMap& args);
-  void WindowManagerPlus::SetMaximumSize(const flutter::EncodableMap& args);
+  void WindowManagerPlus::SetBounds(const BoundsArgs& args);
+  void WindowManagerPlus::Align(const AlignArgs& args);
+  bool WindowManagerPlus::SetParentWindow(const ParentWindowArgs& args);
+  void WindowManagerPlus::MoveChildWindows(const RECT& rect);
+  void WindowManagerPlus::SetChildWindowsMinimized(bool is_minimized);
+  void WindowManagerPlus::SetSnapping(const SnappingArgs& args);
+  void WindowManagerPlus::BuildSnapIndex();
+  void WindowManagerPlus::SnapWindowRect(RECT* rect);
+  void WindowManagerPlus::SetDragRegions(const DragRegionsArgs& args);
+  void WindowManagerPlus::SetResizeBorder(const ResizeBorderArgs& args);
+  void WindowManagerPlus::SetInputRegion(const InputRegionArgs& args);
+  void WindowManagerPlus::UpdateClickThrough();
+  void WindowManagerPlus::SetClickThrough(bool is_click_through);
+  void WindowManagerPlus::SetCursorStreamEnabled(const CursorStreamArgs& args);
+  void WindowManagerPlus::SampleCursor();
+  void WindowManagerPlus::TrackInputLatency(UINT message, WPARAM wParam);
+  flutter::EncodableMap WindowManagerPlus::GetInputLatencyStats(
+      const InputLatencyStatsArgs& args);
+  bool WindowManagerPlus::SendEvent(const std::string& name,
+                                    const std::string& key,
+                                    const char* method,
+                                    flutter::EncodableValue event);
+  void WindowManagerPlus::DeliverEvent(QueuedEvent event);
+  void WindowManagerPlus::EmitBoundsEvent(WindowEvent event, const RECT& rect);
+  void WindowManagerPlus::SetEventPolicy(const EventPolicyArgs& args);
+  flutter::EncodableMap WindowManagerPlus::GetEventQueueStats();
+  // |is_focused| overrides IsFocused, which WM_NCACTIVATE precedes.
+  void WindowManagerPlus::PublishSnapshot(
+      std::optional<bool> is_focused = std::nullopt);
+  void WindowManagerPlus::UpdateHitTestSubclass();
+  LRESULT WindowManagerPlus::HitTestView(LPARAM lParam);
+  void WindowManagerPlus::SetMinimumSize(const SizeArgs& args);
+  void WindowManagerPlus::SetMaximumSize(const SizeArgs& args);
   bool WindowManagerPlus::IsResizable();
   void WindowManagerPlus::SetResizable(const flutter::EncodableMap& args);
   bool WindowManagerPlus::IsMinimizable();
@@ -118,29 +243,58 @@ class WindowManagerPlus {
   bool WindowManagerPlus::IsSkipTaskbar();
   void WindowManagerPlus::SetSkipTaskbar(const flutter::EncodableMap& args);
   void WindowManagerPlus::SetProgressBar(const flutter::EncodableMap& args);
-  void WindowManagerPlus::SetIcon(const flutter::EncodableMap& args);
+  void WindowManagerPlus::SetIcon(const IconArgs& args);
+  void WindowManagerPlus::InstallIcon(LPARAM lParam);
+  bool WindowManagerPlus::SetIconFromBytes(const flutter::EncodableMap& args);
+  std::optional<flutter::EncodableMap> WindowManagerPlus::CaptureWindow(
+      const CaptureArgs& args);
+  void WindowManagerPlus::SetThumbnailOptions(
+      const ThumbnailOptionsArgs& args);
+  void WindowManagerPlus::UpdateThumbnails();
   bool WindowManagerPlus::HasShadow();
   void WindowManagerPlus::SetHasShadow(const flutter::EncodableMap& args);
   double WindowManagerPlus::GetOpacity();
-  void WindowManagerPlus::SetOpacity(const flutter::EncodableMap& args);
+  void WindowManagerPlus::SetOpacity(const OpacityArgs& args);
   void WindowManagerPlus::SetBrightness(const flutter::EncodableMap& args);
   void WindowManagerPlus::SetIgnoreMouseEvents(
       const flutter::EncodableMap& args);
   void WindowManagerPlus::PopUpWindowMenu(const flutter::EncodableMap& args);
   void WindowManagerPlus::StartDragging();
   void WindowManagerPlus::StartResizing(const flutter::EncodableMap& args);
+  void WindowManagerPlus::ApplyInitialOptions();
+  void WindowManagerPlus::SetGeometryPersistenceKey(
+      const flutter::EncodableMap& args);
+  void WindowManagerPlus::SaveGeometry();
+  void WindowManagerPlus::ApplyPendingGeometryState();
 
   static int64_t WindowManagerPlus::createWindow(
       const std::vector<std::string>& args);
+  static void WindowManagerPlus::OnEventReply(int64_t window_id);
+  static flutter::EncodableMap WindowManagerPlus::SaveLayout(
+      const std::string& name);
+  static std::optional<flutter::EncodableMap> WindowManagerPlus::ApplyLayout(
+      const std::string& name);
+  static std::optional<flutter::EncodableMap> WindowManagerPlus::TileWindows(
+      const std::vector<int64_t>& window_ids,
+      const TilingOptions& options,
+      const std::string& display_id);
+  static const DisplayTopology& WindowManagerPlus::GetDisplayTopology();
+  static void WindowManagerPlus::InvalidateDisplayTopology();
+  static void WindowManagerPlus::StopThumbnailService();
+  static flutter::EncodableList WindowManagerPlus::GetDisplays();
 
  private:
   static constexpr auto kFlutterViewWindowClassName = L"FLUTTERVIEW";
+  inline static DisplayTopology display_topology_;
   bool g_is_window_fullscreen = false;
   std::string g_title_bar_style_before_fullscreen;
   RECT g_frame_before_fullscreen;
   bool g_maximized_before_fullscreen;
   LONG g_style_before_fullscreen;
   ITaskbarList3* taskbar_ = nullptr;
+  bool is_geometry_maximize_pending_ = false;
+  bool is_geometry_full_screen_pending_ = false;
+  void WindowManagerPlus::RestoreGeometry();
   double GetDpiForHwnd(HWND hWnd);
   BOOL WindowManagerPlus::RegisterAccessBar(HWND hwnd, BOOL fRegister);
   void PASCAL WindowManagerPlus::AppBarQuerySetPos(HWND hwnd,
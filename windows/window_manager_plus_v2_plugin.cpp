@@ -36,6 +36,115 @@ bool IsWindows11OrGreater() {
 
 std::mutex threadMtx;
 
+ArgValue ArgValueFromEncodable(const flutter::EncodableValue& value) {
+  ArgValue arg;
+  if (auto* bool_value = std::get_if<bool>(&value)) {
+    arg.kind = ArgValue::Kind::kBool;
+    arg.bool_value = *bool_value;
+  } else if (auto* int32_value = std::get_if<int32_t>(&value)) {
+    arg.kind = ArgValue::Kind::kInt;
+    arg.int_value = *int32_value;
+  } else if (auto* int64_value = std::get_if<int64_t>(&value)) {
+    arg.kind = ArgValue::Kind::kInt;
+    arg.int_value = *int64_value;
+  } else if (auto* double_value = std::get_if<double>(&value)) {
+    arg.kind = ArgValue::Kind::kDouble;
+    arg.double_value = *double_value;
+  } else if (auto* string_value = std::get_if<std::string>(&value)) {
+    arg.kind = ArgValue::Kind::kString;
+    arg.string_value = *string_value;
+  } else if (auto* list_value = std::get_if<std::vector<double>>(&value)) {
+    arg.kind = ArgValue::Kind::kDoubleList;
+    arg.double_list_value.data = list_value->data();
+    arg.double_list_value.size = list_value->size();
+  } else if (auto* items = std::get_if<flutter::EncodableList>(&value)) {
+    // A List<double> rather than a Float64List, copied if it only holds
+    // numbers.
+    auto converted = std::make_shared<std::vector<double>>();
+    arg.kind = ArgValue::Kind::kDoubleList;
+    for (const flutter::EncodableValue& item : *items) {
+      if (auto* double_item = std::get_if<double>(&item)) {
+        converted->push_back(*double_item);
+      } else if (std::holds_alternative<int32_t>(item) ||
+                 std::holds_alternative<int64_t>(item)) {
+        converted->push_back(static_cast<double>(item.LongValue()));
+      } else {
+        arg.kind = ArgValue::Kind::kOther;
+        break;
+      }
+    }
+    if (arg.kind == ArgValue::Kind::kDoubleList) {
+      arg.double_list_value.data = converted->data();
+      arg.double_list_value.size = converted->size();
+      arg.double_list_value.converted = std::move(converted);
+    }
+  } else if (!value.IsNull()) {
+    arg.kind = ArgValue::Kind::kOther;
+  }
+  return arg;
+}
+
+// Decodes |args| into |out| with |schema|, or fails |result| with an
+// invalid_argument error. Returns whether |out| is usable.
+template <typename Args>
+bool DecodeArgs(const ArgSchema<Args>& schema,
+                const flutter::EncodableMap& args,
+                Args* out,
+                flutter::MethodResult<flutter::EncodableValue>* result) {
+  auto error = schema.Decode(
+      [&args](auto&& visit) {
+        for (const auto& [key, value] : args) {
+          if (auto* name = std::get_if<std::string>(&key)) {
+            visit(*name, ArgValueFromEncodable(value));
+          }
+        }
+      },
+      out);
+  if (!error) {
+    return true;
+  }
+  result->Error("invalid_argument",
+                "Argument '" + error->argument + "' " + error->message,
+                flutter::EncodableValue(flutter::EncodableMap{
+                    {flutter::EncodableValue("argument"),
+                     flutter::EncodableValue(error->argument)}}));
+  return false;
+}
+
+// The calls of protocol/window_manager.idl, the hot getters and setters
+// decoded from packed arguments instead of a map.
+class ProtocolApi : public protocol::WindowManagerApi {
+ public:
+  explicit ProtocolApi(WindowManagerPlus* window_manager)
+      : window_manager_(window_manager) {}
+
+  protocol::Bounds GetBounds(double device_pixel_ratio) override {
+    return window_manager_->GetBounds(device_pixel_ratio);
+  }
+
+  void SetBounds(const std::optional<double>& x,
+                 const std::optional<double>& y,
+                 const std::optional<double>& width,
+                 const std::optional<double>& height,
+                 double device_pixel_ratio) override {
+    window_manager_->SetBounds({x, y, width, height, device_pixel_ratio});
+  }
+
+  bool IsFocused() override { return window_manager_->IsFocused(); }
+  bool IsVisible() override { return window_manager_->IsVisible(); }
+  bool IsMaximized() override { return window_manager_->IsMaximized(); }
+  bool IsMinimized() override { return window_manager_->IsMinimized(); }
+  bool IsFullScreen() override { return window_manager_->IsFullScreen(); }
+  double GetOpacity() override { return window_manager_->GetOpacity(); }
+
+  void SetOpacity(double opacity) override {
+    window_manager_->SetOpacity({opacity});
+  }
+
+ private:
+  WindowManagerPlus* window_manager_;
+};
+
 class WindowManagerPlusPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar);
@@ -51,8 +160,16 @@ class WindowManagerPlusPlugin : public flutter::Plugin {
   // The ID of the WindowProc delegate registration.
   int window_proc_id = -1;
 
-  void WindowManagerPlusPlugin::_EmitEvent(std::string eventName);
-  void WindowManagerPlusPlugin::_EmitGlobalEvent(std::string eventName);
+  // Whether the bundled initial window options still have to be applied.
+  // Only the main window, created before any call to createWindow, uses them.
+  bool is_initial_options_pending_ = false;
+
+  // Binary channel of the calls of protocol/window_manager.idl, named after
+  // the window id once Dart is initialized.
+  std::string protocol_channel_name_;
+
+  void WindowManagerPlusPlugin::_EmitEvent(WindowEvent event);
+  void WindowManagerPlusPlugin::_EmitGlobalEvent(WindowEvent event);
   // Called for top-level WindowProc delegation.
   std::optional<LRESULT> WindowManagerPlusPlugin::HandleWindowProc(
       HWND hWnd,
@@ -63,6 +180,10 @@ class WindowManagerPlusPlugin : public flutter::Plugin {
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Called when a call of protocol/window_manager.idl comes from Dart.
+  void HandleProtocolMessage(const uint8_t* message,
+                             size_t size,
+                             const flutter::BinaryReply& reply);
 
   static void HandleStaticMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
@@ -77,18 +198,19 @@ class WindowManagerPlusPlugin : public flutter::Plugin {
     // Because if the window is restored from minimized state, the window is not
     // in the correct monitor. The monitor is always the left-most monitor.
     // https://github.com/leanflutter/window_manager/issues/489
-    HMONITOR monitor = MonitorFromRect(&sz->rgrc[0], MONITOR_DEFAULTTONEAREST);
-    if (monitor != NULL) {
-      MONITORINFO monitorInfo;
-      monitorInfo.cbSize = sizeof(MONITORINFO);
-      if (TRUE == GetMonitorInfo(monitor, &monitorInfo)) {
-        l = sz->rgrc[0].left - monitorInfo.rcWork.left;
-        t = sz->rgrc[0].top - monitorInfo.rcWork.top;
-      } else {
-        // GetMonitorInfo failed, use (8, 8) as default value
-      }
+    // The monitors come from the cached display topology, this runs for
+    // every WM_NCCALCSIZE.
+    const RECT& rect = sz->rgrc[0];
+    const Display* display =
+        WindowManagerPlus::GetDisplayTopology().FindByRect(
+            {static_cast<double>(rect.left), static_cast<double>(rect.top),
+             static_cast<double>(rect.right - rect.left),
+             static_cast<double>(rect.bottom - rect.top)});
+    if (display != nullptr) {
+      l = rect.left - static_cast<LONG>(display->work_area.x);
+      t = rect.top - static_cast<LONG>(display->work_area.y);
     } else {
-      // unreachable code
+      // No monitor found, use (8, 8) as default value
     }
 
     sz->rgrc[0].left -= l;
@@ -109,6 +231,7 @@ void WindowManagerPlusPlugin::RegisterWithRegistrar(
 WindowManagerPlusPlugin::WindowManagerPlusPlugin(
     flutter::PluginRegistrarWindows* registrar)
     : registrar(registrar) {
+  is_initial_options_pending_ = WindowManagerPlus::autoincrementId_ == 0;
   window_manager = std::make_shared<WindowManagerPlus>();
   window_manager->static_channel =
       std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
@@ -139,8 +262,15 @@ WindowManagerPlusPlugin::~WindowManagerPlusPlugin() {
 #endif
   registrar->UnregisterTopLevelWindowProcDelegate(window_proc_id);
   window_manager->channel = nullptr;
+  if (!protocol_channel_name_.empty()) {
+    registrar->messenger()->SetMessageHandler(protocol_channel_name_, nullptr);
+  }
 
   auto id = window_manager->id;
+  GetWindowSnapshotRegistry().Remove(id);
+  if (WindowManagerPlus::thumbnail_service_.subscriber == id) {
+    WindowManagerPlus::StopThumbnailService();
+  }
   if (WindowManagerPlus::windowManagers_.find(id) !=
       WindowManagerPlus::windowManagers_.end()) {
     WindowManagerPlus::windowManagers_.erase(id);
@@ -161,26 +291,31 @@ WindowManagerPlusPlugin::~WindowManagerPlusPlugin() {
   }
 }
 
-void WindowManagerPlusPlugin::_EmitEvent(std::string eventName) {
+void WindowManagerPlusPlugin::_EmitEvent(WindowEvent event) {
   if (window_manager == nullptr || window_manager->channel == nullptr)
     return;
+  std::string eventName = WindowEventName(event);
   flutter::EncodableMap args = flutter::EncodableMap();
-  args[flutter::EncodableValue("eventName")] =
-      flutter::EncodableValue(eventName);
-  window_manager->channel->InvokeMethod(
-      "onEvent", std::make_unique<flutter::EncodableValue>(args));
+  args[flutter::EncodableValue("event")] =
+      flutter::EncodableValue(static_cast<int32_t>(event));
+  window_manager->SendEvent(eventName, eventName, "onEvent",
+                            flutter::EncodableValue(args));
 
-  _EmitGlobalEvent(eventName);
+  _EmitGlobalEvent(event);
 }
 
-void WindowManagerPlusPlugin::_EmitGlobalEvent(std::string eventName) {
+void WindowManagerPlusPlugin::_EmitGlobalEvent(WindowEvent event) {
+  // Every window receives the events of every other, they only replace
+  // the events of the same window.
+  std::string eventName = WindowEventName(event);
+  std::string key = eventName + ":" + std::to_string(window_manager->id);
   for (auto wManagerPair : WindowManagerPlus::windowManagers_) {
     if (wManagerPair.second->channel) {
-      wManagerPair.second->channel->InvokeMethod(
-          "onEvent",
-          std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
-              {flutter::EncodableValue("eventName"),
-               flutter::EncodableValue(eventName)},
+      wManagerPair.second->SendEvent(
+          eventName, key, "onEvent",
+          flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue("event"),
+               flutter::EncodableValue(static_cast<int32_t>(event))},
               {flutter::EncodableValue("windowId"),
                flutter::EncodableValue(window_manager->id)}}));
     }
@@ -198,6 +333,28 @@ std::optional<LRESULT> WindowManagerPlusPlugin::HandleWindowProc(
     window_manager->pixel_ratio_ =
         (float)LOWORD(wParam) / USER_DEFAULT_SCREEN_DPI;
     window_manager->ForceChildRefresh();
+    // The scale factor of a monitor may have changed.
+    WindowManagerPlus::InvalidateDisplayTopology();
+  }
+
+  if (message == WM_PAINT || message == WM_SIZE || message == WM_NCACTIVATE) {
+    window_manager->thumbnail_dirty_ = true;
+  }
+
+  // Sent once the window changed, except for WM_NCACTIVATE.
+  if (message == WM_SIZE || message == WM_WINDOWPOSCHANGED ||
+      message == WM_DPICHANGED) {
+    window_manager->PublishSnapshot();
+  } else if (message == WM_NCACTIVATE) {
+    window_manager->PublishSnapshot(wParam != 0);
+  }
+
+  window_manager->TrackInputLatency(message, wParam);
+
+  if (message == WM_DISPLAYCHANGE ||
+      (message == WM_SETTINGCHANGE && wParam == SPI_SETWORKAREA)) {
+    WindowManagerPlus::InvalidateDisplayTopology();
+    _EmitEvent(WindowEvent::kDisplaysChanged);
   }
 
   if (wParam && message == WM_NCCALCSIZE) {
@@ -240,6 +397,12 @@ std::optional<LRESULT> WindowManagerPlusPlugin::HandleWindowProc(
       return 0;
     }
   } else if (message == WM_NCHITTEST) {
+    // Dragging, double-clicking the caption and resizing are then handled
+    // by Windows.
+    LRESULT code = window_manager->HitTestView(lParam);
+    if (code != HTCLIENT) {
+      return code;
+    }
     if (!window_manager->is_resizable_) {
       return HTNOWHERE;
     }
@@ -261,31 +424,39 @@ std::optional<LRESULT> WindowManagerPlusPlugin::HandleWindowProc(
     result = 0;
   } else if (message == WM_NCACTIVATE) {
     if (wParam != 0) {
-      _EmitEvent("focus");
+      _EmitEvent(WindowEvent::kFocus);
     } else {
-      _EmitEvent("blur");
+      _EmitEvent(WindowEvent::kBlur);
     }
 
     if (window_manager->title_bar_style_ == "hidden" ||
         window_manager->is_frameless_)
       return 1;
   } else if (message == WM_EXITSIZEMOVE) {
+    RECT rect;
+    GetWindowRect(window_manager->GetMainWindow(), &rect);
     if (window_manager->is_resizing_) {
-      _EmitEvent("resized");
+      window_manager->EmitBoundsEvent(WindowEvent::kResized, rect);
       window_manager->is_resizing_ = false;
     }
     if (window_manager->is_moving_) {
-      _EmitEvent("moved");
+      window_manager->EmitBoundsEvent(WindowEvent::kMoved, rect);
       window_manager->is_moving_ = false;
     }
+    window_manager->SaveGeometry();
     return false;
   } else if (message == WM_MOVING) {
+    if (!window_manager->is_moving_) {
+      window_manager->BuildSnapIndex();
+    }
     window_manager->is_moving_ = true;
-    _EmitEvent("move");
+    RECT* rect = reinterpret_cast<RECT*>(lParam);
+    window_manager->SnapWindowRect(rect);
+    window_manager->MoveChildWindows(*rect);
+    window_manager->EmitBoundsEvent(WindowEvent::kMove, *rect);
     return false;
   } else if (message == WM_SIZING) {
     window_manager->is_resizing_ = true;
-    _EmitEvent("resize");
 
     if (window_manager->aspect_ratio_ > 0) {
       RECT* rect = (LPRECT)lParam;
@@ -344,46 +515,90 @@ std::optional<LRESULT> WindowManagerPlusPlugin::HandleWindowProc(
       rect->right = right;
       rect->bottom = bottom;
     }
+    window_manager->EmitBoundsEvent(WindowEvent::kResize,
+                                    *reinterpret_cast<RECT*>(lParam));
   } else if (message == WM_SIZE) {
+    if (wParam == SIZE_MINIMIZED) {
+      window_manager->SetChildWindowsMinimized(true);
+    } else if (window_manager->last_state == STATE_MINIMIZED) {
+      window_manager->SetChildWindowsMinimized(false);
+    }
     if (window_manager->IsFullScreen() && wParam == SIZE_MAXIMIZED &&
         window_manager->last_state != STATE_FULLSCREEN_ENTERED) {
-      _EmitEvent("enter-full-screen");
+      _EmitEvent(WindowEvent::kEnterFullScreen);
       window_manager->last_state = STATE_FULLSCREEN_ENTERED;
+      window_manager->SaveGeometry();
     } else if (!window_manager->IsFullScreen() && wParam == SIZE_RESTORED &&
                window_manager->last_state == STATE_FULLSCREEN_ENTERED) {
       window_manager->ForceChildRefresh();
-      _EmitEvent("leave-full-screen");
+      _EmitEvent(WindowEvent::kLeaveFullScreen);
       window_manager->last_state = STATE_NORMAL;
+      window_manager->SaveGeometry();
     } else if (window_manager->last_state != STATE_FULLSCREEN_ENTERED) {
       if (wParam == SIZE_MAXIMIZED) {
-        _EmitEvent("maximize");
+        _EmitEvent(WindowEvent::kMaximize);
         window_manager->last_state = STATE_MAXIMIZED;
+        window_manager->SaveGeometry();
       } else if (wParam == SIZE_MINIMIZED) {
-        _EmitEvent("minimize");
+        _EmitEvent(WindowEvent::kMinimize);
         window_manager->last_state = STATE_MINIMIZED;
         return 0;
       } else if (wParam == SIZE_RESTORED) {
         if (window_manager->last_state == STATE_MAXIMIZED) {
-          _EmitEvent("unmaximize");
+          _EmitEvent(WindowEvent::kUnmaximize);
           window_manager->last_state = STATE_NORMAL;
+          window_manager->SaveGeometry();
         } else if (window_manager->last_state == STATE_MINIMIZED) {
-          _EmitEvent("restore");
+          _EmitEvent(WindowEvent::kRestore);
           window_manager->last_state = STATE_NORMAL;
         }
       }
     }
   } else if (message == WM_CLOSE) {
-    _EmitEvent("close");
+    window_manager->SaveGeometry();
+    _EmitEvent(WindowEvent::kClose);
     if (window_manager->IsPreventClose()) {
       return -1;
     }
   } else if (message == WM_SHOWWINDOW) {
+    if (wParam == TRUE && is_initial_options_pending_) {
+      // The window is about to be shown for the first time: apply the
+      // bundled options now so that it never appears with the defaults.
+      is_initial_options_pending_ = false;
+      if (window_manager->native_window == nullptr) {
+        window_manager->native_window = hWnd;
+      }
+      window_manager->ApplyInitialOptions();
+    }
     if (wParam == TRUE) {
-      _EmitEvent("show");
+      window_manager->ApplyPendingGeometryState();
+      _EmitEvent(WindowEvent::kShow);
     } else {
-      _EmitEvent("hide");
+      _EmitEvent(WindowEvent::kHide);
     }
+  } else if (message == WindowManagerPlus::kIconLoadedMessage) {
+    window_manager->InstallIcon(lParam);
+    return 0;
+  } else if (message == WM_TIMER &&
+             wParam == WindowManagerPlus::kThumbnailTimerId) {
+    window_manager->UpdateThumbnails();
+    return 0;
+  } else if (message == WM_TIMER &&
+             wParam == WindowManagerPlus::kInputRegionTimerId) {
+    window_manager->UpdateClickThrough();
+    return 0;
+  } else if (message == WM_TIMER &&
+             wParam == WindowManagerPlus::kCursorTimerId) {
+    window_manager->SampleCursor();
+    return 0;
   } else if (message == WM_WINDOWPOSCHANGED) {
+    // Drags already moved the children in WM_MOVING.
+    const WINDOWPOS* pos = reinterpret_cast<WINDOWPOS*>(lParam);
+    if (!window_manager->is_moving_ && (pos->flags & SWP_NOMOVE) == 0) {
+      RECT rect;
+      GetWindowRect(hWnd, &rect);
+      window_manager->MoveChildWindows(rect);
+    }
     if (window_manager->IsAlwaysOnBottom()) {
       const flutter::EncodableMap& args = {
           {flutter::EncodableValue("isAlwaysOnBottom"),
@@ -429,11 +644,66 @@ void WindowManagerPlusPlugin::HandleStaticMethodCall(
       windowIds.push_back(window.first);
     }
     result->Success(flutter::EncodableValue(windowIds));
+  } else if (method_name.compare("tileWindows") == 0) {
+    TileWindowsArgs tile;
+    if (!DecodeArgs(TileWindowsArgsSchema(), args, &tile, result.get())) {
+      return;
+    }
+    auto tiled = WindowManagerPlus::TileWindows(
+        tile.unique_window_ids(), tile.tiling_options(),
+        tile.display_id.value_or(""));
+    if (!tiled.has_value()) {
+      result->Error(method_name, "No window or display to tile");
+      return;
+    }
+    result->Success(flutter::EncodableValue(*tiled));
+  } else if (method_name.compare("getDisplays") == 0) {
+    result->Success(flutter::EncodableValue(WindowManagerPlus::GetDisplays()));
+  } else if (method_name.compare("saveLayout") == 0 ||
+             method_name.compare("applyLayout") == 0) {
+    auto name = args.find(flutter::EncodableValue("name"));
+    if (name == args.end() ||
+        !std::holds_alternative<std::string>(name->second) ||
+        !IsValidLayoutName(std::get<std::string>(name->second))) {
+      result->Error(method_name, "Invalid layout name");
+      return;
+    }
+    const std::string& layout_name = std::get<std::string>(name->second);
+    if (method_name.compare("saveLayout") == 0) {
+      result->Success(
+          flutter::EncodableValue(WindowManagerPlus::SaveLayout(layout_name)));
+      return;
+    }
+    auto applied = WindowManagerPlus::ApplyLayout(layout_name);
+    if (!applied.has_value()) {
+      result->Error(method_name, "Unknown layout: " + layout_name);
+      return;
+    }
+    result->Success(flutter::EncodableValue(*applied));
   } else {
     result->NotImplemented();
   }
 }
 
+void WindowManagerPlusPlugin::HandleProtocolMessage(
+    const uint8_t* message,
+    size_t size,
+    const flutter::BinaryReply& reply) {
+  ProtocolApi api(window_manager.get());
+  // Calls about unknown windows fail with "no-window".
+  std::vector<uint8_t> response = protocol::HandleCall(
+      [&api](int64_t windowId) -> protocol::WindowManagerApi* {
+        auto it = WindowManagerPlus::windowManagers_.find(windowId);
+        if (it == WindowManagerPlus::windowManagers_.end()) {
+          return nullptr;
+        }
+        api = ProtocolApi(it->second.get());
+        return &api;
+      },
+      message, size);
+  reply(response.data(), response.size());
+}
+
 void WindowManagerPlusPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -465,6 +735,9 @@ void WindowManagerPlusPlugin::HandleMethodCall(
         }
       }
 
+      if (window_manager->id != windowId) {
+        GetWindowSnapshotRegistry().Remove(window_manager->id);
+      }
       window_manager->id = windowId;
       window_manager->native_window =
           ::GetAncestor(registrar->GetView()->GetNativeWindow(), GA_ROOT);
@@ -480,9 +753,22 @@ void WindowManagerPlusPlugin::HandleMethodCall(
             HandleMethodCall(call, std::move(result));
           });
 
+      window_manager->messenger = registrar->messenger();
+      window_manager->event_channel_name_ =
+          "window_manager_plus_v2_events_" + std::to_string(windowId);
+      protocol_channel_name_ =
+          "window_manager_plus_v2_protocol_" + std::to_string(windowId);
+      registrar->messenger()->SetMessageHandler(
+          protocol_channel_name_,
+          [this](const uint8_t* message, size_t size,
+                 flutter::BinaryReply reply) {
+            HandleProtocolMessage(message, size, reply);
+          });
+
       WindowManagerPlus::windowManagers_[windowId] = window_manager;
+      window_manager->PublishSnapshot();
       result->Success(flutter::EncodableValue(true));
-      _EmitGlobalEvent("initialized");
+      _EmitGlobalEvent(WindowEvent::kInitialized);
     } else {
       result->Error("0", "Cannot ensureInitialized! windowId >= 0 is required");
     }
@@ -594,20 +880,92 @@ void WindowManagerPlusPlugin::HandleMethodCall(
     wManager->SetAspectRatio(args);
     result->Success(flutter::EncodableValue(true));
   } else if (method_name.compare("setBackgroundColor") == 0) {
-    wManager->SetBackgroundColor(args);
-    result->Success(flutter::EncodableValue(true));
+    BackgroundColorArgs color;
+    if (DecodeArgs(BackgroundColorArgsSchema(), args, &color, result.get())) {
+      wManager->SetBackgroundColor(color);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("getBounds") == 0) {
     flutter::EncodableMap value = wManager->GetBounds(args);
     result->Success(flutter::EncodableValue(value));
   } else if (method_name.compare("setBounds") == 0) {
-    wManager->SetBounds(args);
+    BoundsArgs bounds;
+    if (DecodeArgs(BoundsArgsSchema(), args, &bounds, result.get())) {
+      wManager->SetBounds(bounds);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("align") == 0) {
+    AlignArgs alignment;
+    if (DecodeArgs(AlignArgsSchema(), args, &alignment, result.get())) {
+      wManager->Align(alignment);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("setParentWindow") == 0) {
+    ParentWindowArgs parent;
+    if (!DecodeArgs(ParentWindowArgsSchema(), args, &parent, result.get())) {
+      return;
+    }
+    if (!wManager->SetParentWindow(parent)) {
+      result->Error("setParentWindow", "Invalid parent window");
+      return;
+    }
     result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("setDragRegions") == 0) {
+    DragRegionsArgs regions;
+    if (DecodeArgs(DragRegionsArgsSchema(), args, &regions, result.get())) {
+      wManager->SetDragRegions(regions);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("setResizeBorder") == 0) {
+    ResizeBorderArgs border;
+    if (DecodeArgs(ResizeBorderArgsSchema(), args, &border, result.get())) {
+      wManager->SetResizeBorder(border);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("setInputRegion") == 0) {
+    InputRegionArgs region;
+    if (DecodeArgs(InputRegionArgsSchema(), args, &region, result.get())) {
+      wManager->SetInputRegion(region);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("setCursorStreamEnabled") == 0) {
+    CursorStreamArgs stream;
+    if (DecodeArgs(CursorStreamArgsSchema(), args, &stream, result.get())) {
+      wManager->SetCursorStreamEnabled(stream);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("getInputLatencyStats") == 0) {
+    InputLatencyStatsArgs stats;
+    if (DecodeArgs(InputLatencyStatsArgsSchema(), args, &stats, result.get())) {
+      result->Success(
+          flutter::EncodableValue(wManager->GetInputLatencyStats(stats)));
+    }
+  } else if (method_name.compare("setEventPolicy") == 0) {
+    EventPolicyArgs policy;
+    if (DecodeArgs(EventPolicyArgsSchema(), args, &policy, result.get())) {
+      wManager->SetEventPolicy(policy);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("getEventQueueStats") == 0) {
+    result->Success(flutter::EncodableValue(wManager->GetEventQueueStats()));
+  } else if (method_name.compare("setSnapping") == 0) {
+    SnappingArgs snapping;
+    if (DecodeArgs(SnappingArgsSchema(), args, &snapping, result.get())) {
+      wManager->SetSnapping(snapping);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("setMinimumSize") == 0) {
-    wManager->SetMinimumSize(args);
-    result->Success(flutter::EncodableValue(true));
+    SizeArgs size;
+    if (DecodeArgs(SizeArgsSchema(), args, &size, result.get())) {
+      wManager->SetMinimumSize(size);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("setMaximumSize") == 0) {
-    wManager->SetMaximumSize(args);
-    result->Success(flutter::EncodableValue(true));
+    SizeArgs size;
+    if (DecodeArgs(SizeArgsSchema(), args, &size, result.get())) {
+      wManager->SetMaximumSize(size);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("isResizable") == 0) {
     bool value = wManager->IsResizable();
     result->Success(flutter::EncodableValue(value));
@@ -666,8 +1024,35 @@ void WindowManagerPlusPlugin::HandleMethodCall(
     wManager->SetProgressBar(args);
     result->Success(flutter::EncodableValue(true));
   } else if (method_name.compare("setIcon") == 0) {
-    wManager->SetIcon(args);
+    IconArgs icon;
+    if (DecodeArgs(IconArgsSchema(), args, &icon, result.get())) {
+      wManager->SetIcon(icon);
+      result->Success(flutter::EncodableValue(true));
+    }
+  } else if (method_name.compare("setIconFromBytes") == 0) {
+    if (!wManager->SetIconFromBytes(args)) {
+      result->Error("setIconFromBytes", "Invalid icon data");
+      return;
+    }
     result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("captureWindow") == 0) {
+    CaptureArgs capture_args;
+    if (!DecodeArgs(CaptureArgsSchema(), args, &capture_args, result.get())) {
+      return;
+    }
+    auto capture = wManager->CaptureWindow(capture_args);
+    if (!capture) {
+      result->Error("captureWindow", "Failed to capture the window");
+      return;
+    }
+    result->Success(flutter::EncodableValue(*capture));
+  } else if (method_name.compare("setThumbnailOptions") == 0) {
+    ThumbnailOptionsArgs options;
+    if (DecodeArgs(ThumbnailOptionsArgsSchema(), args, &options,
+                   result.get())) {
+      wManager->SetThumbnailOptions(options);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("hasShadow") == 0) {
     bool value = wManager->HasShadow();
     result->Success(flutter::EncodableValue(value));
@@ -677,9 +1062,23 @@ void WindowManagerPlusPlugin::HandleMethodCall(
   } else if (method_name.compare("getOpacity") == 0) {
     double value = wManager->GetOpacity();
     result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setOpacity") == 0) {
-    wManager->SetOpacity(args);
+  } else if (method_name.compare("setGeometryPersistenceKey") == 0) {
+    auto key = args.find(flutter::EncodableValue("key"));
+    if (key != args.end() &&
+        std::holds_alternative<std::string>(key->second) &&
+        !WindowGeometryStore::IsValidKey(std::get<std::string>(key->second))) {
+      result->Error("setGeometryPersistenceKey",
+                    "Invalid geometry persistence key");
+      return;
+    }
+    wManager->SetGeometryPersistenceKey(args);
     result->Success(flutter::EncodableValue(true));
+  } else if (method_name.compare("setOpacity") == 0) {
+    OpacityArgs opacity;
+    if (DecodeArgs(OpacityArgsSchema(), args, &opacity, result.get())) {
+      wManager->SetOpacity(opacity);
+      result->Success(flutter::EncodableValue(true));
+    }
   } else if (method_name.compare("setBrightness") == 0) {
     wManager->SetBrightness(args);
     result->Success(flutter::EncodableValue(true));